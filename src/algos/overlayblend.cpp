@@ -0,0 +1,132 @@
+/*
+ * Copyright (c) 2018 Kay Gawlik <kaydev@amarunet.de> <kay.gawlik@beuth-hochschule.de> <kay.gawlik@charite.de>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+#include "overlayblend.h"
+
+#include <cstring>
+#include <algorithm>
+
+#include <opencv2/opencv.hpp>
+
+#include <helper/parallelfor.h>
+
+
+namespace
+{
+	// x/255 rounded, exact for x in [0, 255*255]
+	inline unsigned div255(unsigned x)
+	{
+		x += 128;
+		return (x + (x >> 8)) >> 8;
+	}
+}
+
+
+template<int channels>
+void OverlayBlend::blendRow(const uint8_t* src, const uint8_t* overlay, uint8_t* dest, int width, unsigned alpha256)
+{
+	for(int i = 0; i < width; ++i)
+	{
+		const unsigned a    = (overlay[3]*alpha256 + 128) >> 8;      // [0, 255]
+		const unsigned aInv = 255 - a;
+		for(int k = 0; k < 3; ++k)
+			dest[k] = static_cast<uint8_t>(div255(src[channels == 1 ? 0 : k]*aInv + overlay[k]*a));
+
+		overlay += 4;
+		dest    += 3;
+		src     += channels;
+	}
+}
+
+template void OverlayBlend::blendRow<1>(const uint8_t* src, const uint8_t* overlay, uint8_t* dest, int width, unsigned alpha256);
+template void OverlayBlend::blendRow<3>(const uint8_t* src, const uint8_t* overlay, uint8_t* dest, int width, unsigned alpha256);
+
+
+bool OverlayBlend::blend(const cv::Mat& image, const cv::Mat& overlay, cv::Mat& dest, double alpha, const cv::Rect* region)
+{
+	if(image.size() != overlay.size() || image.depth() != cv::DataType<uint8_t>::type || overlay.type() != CV_8UC4)
+		return false;
+
+	const int channels = image.channels();
+	if(channels != 1 && channels != 3)
+		return false;
+
+	const cv::Rect imageRect(0, 0, image.cols, image.rows);
+	if(dest.size() != image.size() || dest.type() != CV_8UC3)
+	{
+		dest.create(image.size(), CV_8UC3);
+		region = nullptr;
+	}
+
+	const cv::Rect blendRect = region ? (*region & imageRect) : imageRect;
+	if(blendRect.area() == 0)
+		return true;
+
+	const unsigned alpha256 = static_cast<unsigned>(std::min(std::max(alpha, 0.), 1.)*256 + 0.5);
+
+	ParallelFor::run(static_cast<std::size_t>(blendRect.height), [&](std::size_t i)
+	{
+		const int row = blendRect.y + static_cast<int>(i);
+		const uint8_t* srcRow     = image  .ptr<uint8_t>(row) + blendRect.x*channels;
+		const uint8_t* overlayRow = overlay.ptr<uint8_t>(row) + blendRect.x*4;
+		      uint8_t* destRow    = dest   .ptr<uint8_t>(row) + blendRect.x*3;
+
+		if(channels == 1)
+			blendRow<1>(srcRow, overlayRow, destRow, blendRect.width, alpha256);
+		else
+			blendRow<3>(srcRow, overlayRow, destRow, blendRect.width, alpha256);
+	}, 16);
+
+	return true;
+}
+
+
+cv::Rect OverlayBlend::changedRegion(const cv::Mat& a, const cv::Mat& b)
+{
+	if(a.size() != b.size() || a.type() != b.type())
+		return cv::Rect(0, 0, std::max(a.cols, b.cols), std::max(a.rows, b.rows));
+
+	const std::size_t pixelSize = a.elemSize();
+	const std::size_t rowSize   = pixelSize*static_cast<std::size_t>(a.cols);
+
+	int x1 = a.cols, x2 = -1;
+	int y1 = a.rows, y2 = -1;
+	for(int row = 0; row < a.rows; ++row)
+	{
+		const uint8_t* rowA = a.ptr<uint8_t>(row);
+		const uint8_t* rowB = b.ptr<uint8_t>(row);
+		if(std::memcmp(rowA, rowB, rowSize) == 0)
+			continue;
+
+		y1 = std::min(y1, row);
+		y2 = row;
+
+		int first = 0;
+		while(std::memcmp(rowA + first*pixelSize, rowB + first*pixelSize, pixelSize) == 0)
+			++first;
+		int last = a.cols - 1;
+		while(std::memcmp(rowA + last*pixelSize, rowB + last*pixelSize, pixelSize) == 0)
+			--last;
+
+		x1 = std::min(x1, first);
+		x2 = std::max(x2, last);
+	}
+
+	if(y2 < 0)
+		return cv::Rect();
+	return cv::Rect(x1, y1, x2 - x1 + 1, y2 - y1 + 1);
+}
@@ -0,0 +1,40 @@
+/*
+ * Copyright (c) 2018 Kay Gawlik <kaydev@amarunet.de> <kay.gawlik@beuth-hochschule.de> <kay.gawlik@charite.de>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+#ifndef OVERLAYBLEND_H
+#define OVERLAYBLEND_H
+
+#include <cstdint>
+
+namespace cv { class Mat; template<typename T> class Rect_; typedef Rect_<int> Rect; }
+
+// blends a BGRA overlay (overlay alpha * global alpha) onto a gray or BGR image, result is BGR
+// 8 bit fixed point arithmetic without branches, so that the compiler can vectorize the rows
+namespace OverlayBlend
+{
+	// alpha256: global alpha in [0, 256]
+	template<int channels>
+	void blendRow(const uint8_t* src, const uint8_t* overlay, uint8_t* dest, int width, unsigned alpha256);
+
+	// writes region (full image if nullptr) of dest, dest is (re)created if it has not the size of image
+	bool blend(const cv::Mat& image, const cv::Mat& overlay, cv::Mat& dest, double alpha, const cv::Rect* region = nullptr);
+
+	// bounding box of the pixels which differ in two images of the same size and type (empty if equal)
+	cv::Rect changedRegion(const cv::Mat& a, const cv::Mat& b);
+}
+
+#endif // OVERLAYBLEND_H
@@ -18,6 +18,7 @@
 
 #pragma once
 
+#include <cstddef>
 
 class MarkerCommand
 {
@@ -27,6 +28,7 @@ public:
 	virtual bool redo()  = 0;
 	virtual bool undo()  = 0;
 	virtual void apply() = 0;
+	virtual std::size_t getMemoryBytes() const = 0;             // for the memory accounting of the undo stacks
 	int getBScan() const { return bscan; }
 
 protected:
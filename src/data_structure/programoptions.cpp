@@ -36,6 +36,8 @@ OptionColor  ProgramOptions::bscanSegmetationLineColor   (Qt::red, "bscanSegmeta
 OptionInt    ProgramOptions::bscanSegmetationLineThicknes(1      , "bscanSegmetationLineThicknes", "ProgramOptions");
 OptionInt    ProgramOptions::bscanAspectRatioType        (0      , "bscanAspectRatioType"        , "ProgramOptions"); // 0 fix value, 1 from bscan, 2 best fit
 OptionBool   ProgramOptions::bscanAutoFitImage           (true   , "bscanAutoFitImage"           , "ProgramOptions");
+OptionInt    ProgramOptions::bscanPrerenderNeighbors     (2      , "bscanPrerenderNeighbors"     , "ProgramOptions", 0, 20);
+OptionInt    ProgramOptions::bscanNavigationSettleTime   (120    , "bscanNavigationSettleTime"   , "ProgramOptions", 0, 2000); // ms, 0 updates the modules synchronously
 
 OptionBool   ProgramOptions::bscanShowExtraSegmentationslines(true, "bscanShowExtraSegmentationslines", "ExtraData");
 
@@ -67,6 +69,7 @@ OptionString ProgramOptions::loadOctdataAtStart("" , "loadOctDataAtStart", "Prog
 
 OptionBool   ProgramOptions::autoSaveOctMarkers         (true, "autoSaveOctMarkers", "ProgramOptions");
 OptionInt    ProgramOptions::defaultFileformatOctMarkers(static_cast<int>(OctMarkerFileformat::INFO), "defaultFileformatOctMarkers", "ProgramOptions");
+OptionBool   ProgramOptions::compressOctMarkers         (false, "compressOctMarkers", "ProgramOptions");
 
 OptionInt    ProgramOptions::bscanMarkerToolId(-1, "bscanMarkerToolId", "ProgramOptions");
 OptionInt    ProgramOptions::  sloMarkerToolId(-1,   "sloMarkerToolId", "ProgramOptions");
@@ -86,10 +89,12 @@ OptionInt    ProgramOptions::layerSegSplinePointSize     (8         , "SplinePoi
 OptionBool   ProgramOptions::layerSegThicknessmapBlend   (true      , "ThicknessmapBlend", "LayerSeg");
 OptionBool   ProgramOptions::layerSegSloMapsAutoUpdate   (true      , "SloMapsAutoUpdate", "LayerSeg");
 OptionBool   ProgramOptions::layerSegHighlightSegLine    (true      , "HighlightSegLine", "LayerSeg");
+OptionBool   ProgramOptions::layerSegSaveLinesFloat32    (false     , "SaveLinesFloat32", "LayerSeg");
 
 
 OptionInt    ProgramOptions::freeFormedSegmetationLineThickness(1      , "bscanSegmetationLineThickness", "FreeFormedSegmentation", 1, 10);
 OptionBool   ProgramOptions::freeFormedSegmetationShowArea     (true   , "showArea"                     , "FreeFormedSegmentation");
+OptionBool   ProgramOptions::freeFormedSegmetationSaveCompact  (false  , "saveCompact"                  , "FreeFormedSegmentation");
 
 
 OptionBool   ProgramOptions::intervallMarkSloMapAuteGenerate(false    , "SloMapAuteGenerate", "IntervallMark");
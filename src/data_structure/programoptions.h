@@ -56,6 +56,8 @@ public:
 	static OptionInt    bscanSegmetationLineThicknes;
 	static OptionInt    bscanAspectRatioType;
 	static OptionBool   bscanAutoFitImage;
+	static OptionInt    bscanPrerenderNeighbors;
+	static OptionInt    bscanNavigationSettleTime;
 
 	static OptionBool   bscanShowExtraSegmentationslines;
 
@@ -84,6 +86,7 @@ public:
 	
 	static OptionBool   autoSaveOctMarkers;
 	static OptionInt    defaultFileformatOctMarkers;
+	static OptionBool   compressOctMarkers;
 
 	static OptionInt    bscanMarkerToolId;
 	static OptionInt    sloMarkerToolId;
@@ -103,10 +106,12 @@ public:
 	static OptionBool   layerSegThicknessmapBlend;
 	static OptionBool   layerSegSloMapsAutoUpdate;
 	static OptionBool   layerSegHighlightSegLine;
+	static OptionBool   layerSegSaveLinesFloat32;
 
 
 	static OptionInt    freeFormedSegmetationLineThickness;
 	static OptionBool   freeFormedSegmetationShowArea;
+	static OptionBool   freeFormedSegmetationSaveCompact;
 
 	static OptionBool   intervallMarkSloMapAuteGenerate;
 	
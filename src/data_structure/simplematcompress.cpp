@@ -18,6 +18,93 @@
 
 #include "simplematcompress.h"
 
+#include <limits>
+#include <sstream>
+
+#include <boost/archive/text_oarchive.hpp>
+#include <boost/archive/text_iarchive.hpp>
+
+#include <boost/iostreams/filtering_stream.hpp>
+#include <boost/iostreams/filter/zlib.hpp>
+#include <boost/iostreams/device/array.hpp>
+#include <boost/iostreams/device/back_inserter.hpp>
+
+#include <helper/base64.h>
+
+namespace io = boost::iostreams;
+
+
+namespace
+{
+	const char        binaryPrefix[]  = "smc1:";
+	const std::size_t binaryPrefixLen = sizeof(binaryPrefix) - 1;
+
+	const uint8_t binaryVersion = 1;
+	enum class BinaryCompression : uint8_t { None = 0, Deflate = 1 };
+
+	// runs smaller than this are not worth a deflate attempt
+	const std::size_t minDeflateSize = 64;
+
+	// deflate does not compress better than about 1032:1, larger sizes in a header are corrupt
+	const uint64_t maxDeflateRatio = 1032;
+
+
+	void putVarint(std::string& buffer, uint64_t value)
+	{
+		while(value >= 0x80)
+		{
+			buffer.push_back(static_cast<char>((value & 0x7f) | 0x80));
+			value >>= 7;
+		}
+		buffer.push_back(static_cast<char>(value));
+	}
+
+	bool getVarint(const unsigned char*& pos, const unsigned char* end, uint64_t& value)
+	{
+		value = 0;
+		for(int shift = 0; shift < 64 && pos < end; shift += 7)
+		{
+			const unsigned char byte = *pos++;
+			value |= static_cast<uint64_t>(byte & 0x7f) << shift;
+			if(!(byte & 0x80))
+				return true;
+		}
+		return false;
+	}
+
+	std::string deflate(const std::string& data)
+	{
+		std::string result;
+		io::filtering_ostream out;
+		out.push(io::zlib_compressor(io::zlib::best_speed));
+		out.push(io::back_inserter(result));
+		out.write(data.data(), static_cast<std::streamsize>(data.size()));
+		out.reset();
+		return result;
+	}
+
+	bool inflate(const unsigned char* pos, const unsigned char* end, std::size_t rawSize, std::string& result)
+	{
+		try
+		{
+			io::filtering_istream in;
+			in.push(io::zlib_decompressor());
+			in.push(io::array_source(reinterpret_cast<const char*>(pos), static_cast<std::size_t>(end - pos)));
+
+			// read one byte more to detect wrong sizes
+			result.resize(rawSize + 1);
+			in.read(&result[0], static_cast<std::streamsize>(rawSize + 1));
+			if(static_cast<std::size_t>(in.gcount()) != rawSize)
+				return false;
+			result.resize(rawSize);
+		}
+		catch(...)
+		{
+			return false;
+		}
+		return true;
+	}
+}
 
 
 SimpleMatCompress::SimpleMatCompress(int rows, int cols, uint8_t initValue)
@@ -93,6 +180,157 @@ bool SimpleMatCompress::isEmpty(uint8_t defaultValue) const
 	return false;
 }
 
+std::string SimpleMatCompress::toSerializationString(SerializationFormat format) const
+{
+	if(format == SerializationFormat::TextArchive)
+	{
+		std::stringstream ofs;
+		boost::archive::text_oarchive oa(ofs);
+		oa << *this;
+		return ofs.str();
+	}
+
+	std::string runs;
+	runs.reserve(segmentsChange.size()*3 + 16);
+	putVarint(runs, static_cast<uint64_t>(rows));
+	putVarint(runs, static_cast<uint64_t>(cols));
+	putVarint(runs, segmentsChange.size());
+	for(const MatSegment& segment : segmentsChange)
+	{
+		putVarint(runs, static_cast<uint64_t>(segment.length));
+		runs.push_back(static_cast<char>(segment.value));
+	}
+
+	std::string payload;
+	payload.push_back(static_cast<char>(binaryVersion));
+
+	std::string compressed;
+	if(format == SerializationFormat::BinaryDeflate && runs.size() >= minDeflateSize)
+		compressed = deflate(runs);
+
+	if(!compressed.empty() && compressed.size() + 4 < runs.size())
+	{
+		payload.push_back(static_cast<char>(BinaryCompression::Deflate));
+		putVarint(payload, runs.size());
+		payload.append(compressed);
+	}
+	else
+	{
+		payload.push_back(static_cast<char>(BinaryCompression::None));
+		payload.append(runs);
+	}
+
+	std::string result(binaryPrefix);
+	Base64::append(result, reinterpret_cast<const unsigned char*>(payload.data()), payload.size());
+	return result;
+}
+
+
+bool SimpleMatCompress::isBinarySerialization(const std::string& str)
+{
+	return str.compare(0, binaryPrefixLen, binaryPrefix) == 0;
+}
+
+
+bool SimpleMatCompress::fromSerializationString(const std::string& str)
+{
+	segmentsChange.clear();
+	rows        = 0;
+	cols        = 0;
+	sumSegments = 0;
+
+	if(str.compare(0, binaryPrefixLen, binaryPrefix) != 0)
+	{
+		try
+		{
+			std::stringstream ioa(str);
+			boost::archive::text_iarchive ia(ioa);
+			ia >> *this;
+		}
+		catch(...)
+		{
+			segmentsChange.clear();
+			return false;
+		}
+
+		int64_t sum = 0;
+		for(const MatSegment& segment : segmentsChange)
+			sum += segment.length;
+		if(sum > static_cast<int64_t>(rows)*cols) // writeToMat would write behind the mat
+		{
+			segmentsChange.clear();
+			return false;
+		}
+		sumSegments = static_cast<int>(sum);
+		return true;
+	}
+
+	const std::vector<unsigned char> payload = Base64::decode(str.data() + binaryPrefixLen, str.data() + str.size());
+	if(payload.size() < 2 || payload[0] != binaryVersion)
+		return false;
+
+	const unsigned char* pos = payload.data() + 2;
+	const unsigned char* end = payload.data() + payload.size();
+
+	std::string inflated;
+	switch(static_cast<BinaryCompression>(payload[1]))
+	{
+		case BinaryCompression::None:
+			break;
+		case BinaryCompression::Deflate:
+		{
+			uint64_t rawSize;
+			if(!getVarint(pos, end, rawSize) || rawSize > static_cast<uint64_t>(std::numeric_limits<int>::max()))
+				return false;
+			if(rawSize > static_cast<uint64_t>(end - pos)*maxDeflateRatio) // checked before inflate allocates rawSize bytes
+				return false;
+			if(!inflate(pos, end, static_cast<std::size_t>(rawSize), inflated))
+				return false;
+			pos = reinterpret_cast<const unsigned char*>(inflated.data());
+			end = pos + inflated.size();
+			break;
+		}
+		default:
+			return false;
+	}
+
+	const uint64_t maxInt = static_cast<uint64_t>(std::numeric_limits<int>::max());
+	uint64_t newRows, newCols, numSegments;
+	if(!getVarint(pos, end, newRows)
+	|| !getVarint(pos, end, newCols)
+	|| !getVarint(pos, end, numSegments))
+		return false;
+	if(newRows > maxInt || newCols > maxInt || (newCols > 0 && newRows > maxInt/newCols))
+		return false;
+	if(numSegments > static_cast<uint64_t>(end - pos)/2)
+		return false;
+
+	segmentsChange.reserve(static_cast<std::size_t>(numSegments));
+	uint64_t sum = 0;
+	for(uint64_t i = 0; i < numSegments; ++i)
+	{
+		uint64_t length;
+		if(!getVarint(pos, end, length) || pos >= end)
+			break;
+		sum += length;
+		if(length > maxInt || sum > newRows*newCols)
+			break;
+		segmentsChange.push_back(MatSegment(static_cast<int>(length), *pos++));
+	}
+
+	if(segmentsChange.size() != numSegments || sum != newRows*newCols)
+	{
+		segmentsChange.clear();
+		return false;
+	}
+
+	rows        = static_cast<int>(newRows);
+	cols        = static_cast<int>(newCols);
+	sumSegments = static_cast<int>(sum);
+	return true;
+}
+
+
 bool SimpleMatCompress::isEqual(const uint8_t* mat, int rows, int cols) const
 {
 	if(this->rows != rows || this->cols != cols || mat == nullptr)
@@ -20,6 +20,7 @@
 #define SIMPLEMATCOMPRESS_H
 
 #include <vector>
+#include <string>
 #include <cstdint>
 
 #include <boost/serialization/vector.hpp>
@@ -70,6 +71,11 @@ class SimpleMatCompress
 	void addSegment(int length, uint8_t value);
 
 public:
+	// TextArchive: boost text_oarchive (format of old marker files)
+	// Binary:      "smc1:" + base64 of varint coded runs
+	// BinaryDeflate: as Binary, the runs are deflated if this makes the string smaller
+	enum class SerializationFormat { TextArchive, Binary, BinaryDeflate };
+
 	SimpleMatCompress() = default;
 	SimpleMatCompress(int rows, int cols, uint8_t initValue);
 
@@ -78,9 +84,15 @@ public:
 	int getRows() const { return rows; }
 	int getCols() const { return cols; }
 
+	std::size_t getMemoryBytes() const { return sizeof(*this) + segmentsChange.capacity()*sizeof(MatSegment); }
+
 	bool readFromMat(const uint8_t* mat, int rows, int cols);
 	bool writeToMat (      uint8_t* mat, int rows, int cols) const;
 
+	std::string toSerializationString(SerializationFormat format) const;
+	bool      fromSerializationString(const std::string& str);          // detects the format
+	static bool isBinarySerialization(const std::string& str);          // Binary or BinaryDeflate, else TextArchive
+
 	bool isEqual(const uint8_t* mat, int rows, int cols) const;
 	bool operator==(const SimpleMatCompress& other) const;
 };
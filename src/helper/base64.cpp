@@ -0,0 +1,89 @@
+/*
+ * Copyright (c) 2018 Kay Gawlik <kaydev@amarunet.de> <kay.gawlik@beuth-hochschule.de> <kay.gawlik@charite.de>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+#include "base64.h"
+
+#include <cstdint>
+#include <cstring>
+
+
+namespace
+{
+	const char base64Chars[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+
+	struct DecodeTable
+	{
+		int8_t table[256];
+
+		DecodeTable()
+		{
+			std::memset(table, -1, sizeof(table));
+			for(int i = 0; i < 64; ++i)
+				table[static_cast<unsigned char>(base64Chars[i])] = static_cast<int8_t>(i);
+		}
+	};
+}
+
+
+void Base64::append(std::string& str, const unsigned char* data, std::size_t size)
+{
+	str.reserve(str.size() + (size+2)/3*4);
+
+	std::size_t i = 0;
+	for(; i + 2 < size; i += 3)
+	{
+		const uint32_t block = (uint32_t(data[i]) << 16) | (uint32_t(data[i+1]) << 8) | data[i+2];
+		str.push_back(base64Chars[(block >> 18) & 0x3f]);
+		str.push_back(base64Chars[(block >> 12) & 0x3f]);
+		str.push_back(base64Chars[(block >>  6) & 0x3f]);
+		str.push_back(base64Chars[ block        & 0x3f]);
+	}
+	if(i < size)
+	{
+		const uint32_t block = (uint32_t(data[i]) << 16) | (i + 1 < size ? uint32_t(data[i+1]) << 8 : 0);
+		str.push_back(base64Chars[(block >> 18) & 0x3f]);
+		str.push_back(base64Chars[(block >> 12) & 0x3f]);
+		str.push_back(i + 1 < size ? base64Chars[(block >> 6) & 0x3f] : '=');
+		str.push_back('=');
+	}
+}
+
+
+std::vector<unsigned char> Base64::decode(const char* pos, const char* end)
+{
+	static const DecodeTable decodeTable;
+
+	std::vector<unsigned char> result;
+	result.reserve(static_cast<std::size_t>(end - pos)/4*3);
+
+	uint32_t block = 0;
+	int      bits  = 0;
+	for(; pos != end; ++pos)
+	{
+		const int8_t v = decodeTable.table[static_cast<unsigned char>(*pos)];
+		if(v < 0)
+			break; // padding or end of data
+		block = (block << 6) | static_cast<uint32_t>(v);
+		bits += 6;
+		if(bits >= 8)
+		{
+			bits -= 8;
+			result.push_back(static_cast<unsigned char>(block >> bits));
+		}
+	}
+	return result;
+}
@@ -0,0 +1,31 @@
+/*
+ * Copyright (c) 2018 Kay Gawlik <kaydev@amarunet.de> <kay.gawlik@beuth-hochschule.de> <kay.gawlik@charite.de>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+#ifndef BASE64_H
+#define BASE64_H
+
+#include <string>
+#include <vector>
+
+// base64 coding (RFC 4648) for binary data in the text based marker files
+namespace Base64
+{
+	void                       append(std::string& str, const unsigned char* data, std::size_t size);
+	std::vector<unsigned char> decode(const char* pos, const char* end);   // stops at padding or the first invalid char
+};
+
+#endif // BASE64_H
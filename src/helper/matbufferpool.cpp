@@ -0,0 +1,56 @@
+/*
+ * Copyright (c) 2018 Kay Gawlik <kaydev@amarunet.de> <kay.gawlik@beuth-hochschule.de> <kay.gawlik@charite.de>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+#include "matbufferpool.h"
+
+
+bool MatBufferPool::isUnused(const cv::Mat& buffer)
+{
+#if CV_MAJOR_VERSION >= 3
+	return buffer.u && buffer.u->refcount == 1;
+#else
+	return buffer.refcount && *buffer.refcount == 1;
+#endif
+}
+
+cv::Mat MatBufferPool::get(int rows, int cols, int type)
+{
+	cv::Mat* freeBuffer = nullptr;
+	for(cv::Mat& buffer : buffers)
+	{
+		if(!isUnused(buffer))
+			continue;
+
+		if(buffer.rows == rows && buffer.cols == cols && buffer.type() == type)
+			return buffer;
+
+		if(!freeBuffer)
+			freeBuffer = &buffer;
+	}
+
+	if(!freeBuffer && buffers.size() < maxBuffers)
+	{
+		buffers.emplace_back();
+		freeBuffer = &buffers.back();
+	}
+
+	if(!freeBuffer)
+		return cv::Mat(rows, cols, type);                           // all buffers in use, no pooling
+
+	freeBuffer->create(rows, cols, type);
+	return *freeBuffer;
+}
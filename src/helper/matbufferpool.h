@@ -0,0 +1,42 @@
+/*
+ * Copyright (c) 2018 Kay Gawlik <kaydev@amarunet.de> <kay.gawlik@beuth-hochschule.de> <kay.gawlik@charite.de>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+#ifndef MATBUFFERPOOL_H
+#define MATBUFFERPOOL_H
+
+#include <vector>
+
+#include <opencv2/core/core.hpp>
+
+// reuses the memory of cv::Mat buffers, a buffer is handed out again when no cv::Mat outside the pool references it
+class MatBufferPool
+{
+	std::vector<cv::Mat> buffers;
+	std::size_t maxBuffers;
+
+public:
+	explicit MatBufferPool(std::size_t maxBuffers = 3) : maxBuffers(maxBuffers) {}
+
+	static bool isUnused(const cv::Mat& buffer);                    // no other cv::Mat references the data
+
+	cv::Mat get(int rows, int cols, int type);                      // uninitialized buffer
+	void clear()                                                    { buffers.clear(); }
+
+	const std::vector<cv::Mat>& getBuffers() const                  { return buffers; }
+};
+
+#endif // MATBUFFERPOOL_H
@@ -0,0 +1,105 @@
+/*
+ * Copyright (c) 2018 Kay Gawlik <kaydev@amarunet.de> <kay.gawlik@beuth-hochschule.de> <kay.gawlik@charite.de>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+#include "memoryusage.h"
+
+#include <map>
+#include <cstdio>
+#include <fstream>
+#include <algorithm>
+
+#include <QImage>
+
+#include <opencv2/core/core.hpp>
+
+
+namespace
+{
+	double toMiB(std::size_t bytes)                                 { return static_cast<double>(bytes)/(1024.*1024.); }
+}
+
+
+std::size_t MemoryUsage::getTotal() const
+{
+	std::size_t total = 0;
+	for(const Entry& entry : entries)
+		total += entry.bytes;
+	return total;
+}
+
+
+std::string MemoryUsage::getReport() const
+{
+	std::size_t nameWidth = 5;
+	std::map<std::string, std::size_t> categoryTotals;
+	std::vector<std::string> categories;                            // in order of appearance
+	for(const Entry& entry : entries)
+	{
+		nameWidth = std::max(nameWidth, entry.item.size() + 2);
+		if(categoryTotals.find(entry.category) == categoryTotals.end())
+			categories.push_back(entry.category);
+		categoryTotals[entry.category] += entry.bytes;
+		nameWidth = std::max(nameWidth, entry.category.size());
+	}
+
+	std::string report;
+	char line[128];
+	std::snprintf(line, sizeof(line), "%10s %12s\n", "count", "MiB");
+	report += std::string(nameWidth, ' ') + line;
+
+	for(const std::string& category : categories)
+	{
+		std::snprintf(line, sizeof(line), "%10s %12.2f\n", "", toMiB(categoryTotals[category]));
+		report += category + std::string(nameWidth - category.size(), ' ') + line;
+
+		for(const Entry& entry : entries)
+		{
+			if(entry.category != category)
+				continue;
+			std::snprintf(line, sizeof(line), "%10llu %12.2f\n", static_cast<unsigned long long>(entry.count), toMiB(entry.bytes));
+			report += "  " + entry.item + std::string(nameWidth - entry.item.size() - 2, ' ') + line;
+		}
+	}
+
+	std::snprintf(line, sizeof(line), "%10s %12.2f\n", "", toMiB(getTotal()));
+	report += "total" + std::string(nameWidth - 5, ' ') + line;
+	return report;
+}
+
+bool MemoryUsage::writeReport(const std::string& filename) const
+{
+	std::ofstream stream(filename);
+	if(!stream.good())
+		return false;
+	stream << getReport();
+	return stream.good();
+}
+
+
+std::size_t MemoryUsage::bytes(const cv::Mat& mat)
+{
+	if(mat.empty())
+		return 0;
+	return static_cast<std::size_t>(mat.rows)*mat.step[0];
+}
+
+std::size_t MemoryUsage::bytes(const QImage& image)
+{
+	if(image.isNull())
+		return 0;
+	return static_cast<std::size_t>(image.bytesPerLine())*static_cast<std::size_t>(image.height());
+}
@@ -0,0 +1,60 @@
+/*
+ * Copyright (c) 2018 Kay Gawlik <kaydev@amarunet.de> <kay.gawlik@beuth-hochschule.de> <kay.gawlik@charite.de>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+#pragma once
+
+#include <string>
+#include <vector>
+#include <cstddef>
+
+namespace cv { class Mat; }
+class QImage;
+
+// bytes held by the loaded data, the marker modules and the render caches
+// collected on request from the data structures (no bookkeeping on allocation), the sizes are the payload
+// of images and containers, shared image data is counted at every holder
+class MemoryUsage
+{
+public:
+	struct Entry
+	{
+		std::string category;                                       // e.g. "OCT data", "marker LayerSegmentation", "BScan view"
+		std::string item;
+		std::size_t bytes;
+		std::size_t count;
+	};
+
+	void add(const std::string& category, const std::string& item, std::size_t bytes, std::size_t count = 1)
+	                                                                { entries.push_back(Entry{category, item, bytes, count}); }
+
+	const std::vector<Entry>& getEntries() const                    { return entries; }
+	std::size_t getTotal() const;
+
+	std::string getReport() const;                                  // table with count and MiB, grouped by category
+	bool writeReport(const std::string& filename) const;
+
+	static const std::size_t graphicsItemBytes = 512;               // estimate for a QGraphicsRectItem with its private data
+
+	static std::size_t bytes(const cv::Mat& mat);
+	static std::size_t bytes(const QImage& image);
+	static std::size_t bytes(const std::string& str)                { return str.capacity(); }
+	template<typename T>
+	static std::size_t bytes(const std::vector<T>& vec)             { return vec.capacity()*sizeof(T); }
+
+private:
+	std::vector<Entry> entries;
+};
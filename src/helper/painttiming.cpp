@@ -0,0 +1,121 @@
+/*
+ * Copyright (c) 2018 Kay Gawlik <kaydev@amarunet.de> <kay.gawlik@beuth-hochschule.de> <kay.gawlik@charite.de>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+#include "painttiming.h"
+
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <algorithm>
+
+#include <QString>
+
+
+bool PaintTiming::enabled = false;
+
+
+namespace
+{
+	const int bucketsPerOctave = 8;
+	const int numBuckets       = bucketsPerOctave*32;
+
+	int bucketOf(double microseconds)
+	{
+		if(microseconds <= 1.)
+			return 0;
+		const int bucket = static_cast<int>(std::ceil(std::log2(microseconds)*bucketsPerOctave));
+		return std::min(bucket, numBuckets - 1);
+	}
+
+	double bucketUpperBound(int bucket)
+	{
+		return std::exp2(static_cast<double>(bucket)/bucketsPerOctave);
+	}
+}
+
+
+void PaintTiming::Statistic::add(double microseconds)
+{
+	if(histogram.empty())
+		histogram.resize(numBuckets);
+
+	++histogram[static_cast<std::size_t>(bucketOf(microseconds))];
+	++count;
+	sum += microseconds;
+	max  = std::max(max, microseconds);
+}
+
+double PaintTiming::Statistic::getPercentile(double p) const
+{
+	if(count == 0)
+		return 0;
+
+	const uint64_t rank = static_cast<uint64_t>(std::ceil(p*static_cast<double>(count)));
+	uint64_t seen = 0;
+	for(std::size_t bucket = 0; bucket < histogram.size(); ++bucket)
+	{
+		seen += histogram[bucket];
+		if(seen >= rank && seen > 0)
+			return std::min(bucketUpperBound(static_cast<int>(bucket)), max);
+	}
+	return max;
+}
+
+
+std::string PaintTiming::getReport() const
+{
+	std::size_t nameWidth = 5;
+	for(const std::pair<const std::string, Statistic>& stage : stages)
+		nameWidth = std::max(nameWidth, stage.first.size());
+
+	std::string report;
+	char line[128];
+	std::snprintf(line, sizeof(line), "%10s %10s %10s %10s %10s\n", "count", "mean ms", "p50 ms", "p95 ms", "max ms");
+	report += std::string(nameWidth, ' ') + line;
+
+	for(const std::pair<const std::string, Statistic>& stage : stages)
+	{
+		const Statistic& s = stage.second;
+		std::snprintf(line, sizeof(line), "%10llu %10.3f %10.3f %10.3f %10.3f\n"
+		            , static_cast<unsigned long long>(s.getCount())
+		            , s.getMean()/1000.
+		            , s.getPercentile(0.50)/1000.
+		            , s.getPercentile(0.95)/1000.
+		            , s.getMax()/1000.);
+		report += stage.first + std::string(nameWidth - stage.first.size(), ' ') + line;
+	}
+	return report;
+}
+
+bool PaintTiming::writeReport(const std::string& filename) const
+{
+	std::ofstream stream(filename);
+	if(!stream.good())
+		return false;
+	stream << getReport();
+	return stream.good();
+}
+
+
+void ScopedPaintTimer::stop()
+{
+	const double microseconds = std::chrono::duration<double, std::micro>(Clock::now() - start).count();
+	if(detail)
+		PaintTiming::getInstance().add(std::string(stage) + ' ' + detail->toStdString(), microseconds);
+	else
+		PaintTiming::getInstance().add(stage, microseconds);
+}
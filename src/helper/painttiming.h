@@ -0,0 +1,90 @@
+/*
+ * Copyright (c) 2018 Kay Gawlik <kaydev@amarunet.de> <kay.gawlik@beuth-hochschule.de> <kay.gawlik@charite.de>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+#pragma once
+
+#include <map>
+#include <string>
+#include <vector>
+#include <chrono>
+#include <cstdint>
+
+class QString;
+
+// durations of paint and event stages (GUI thread), measured with ScopedPaintTimer
+// disabled by default, then a timer only checks one flag
+class PaintTiming
+{
+public:
+	// logarithmic histogram, 8 buckets per octave from 1 us
+	class Statistic
+	{
+		std::vector<uint32_t> histogram;
+		uint64_t count = 0;
+		double   sum   = 0;
+		double   max   = 0;
+	public:
+		void add(double microseconds);
+
+		uint64_t getCount() const                                   { return count; }
+		double   getMean () const                                   { return count > 0 ? sum/static_cast<double>(count) : 0; }
+		double   getMax  () const                                   { return max; }
+		double   getPercentile(double p) const;                     // upper bound of the bucket, at most max
+	};
+
+	static PaintTiming& getInstance()                               { static PaintTiming instance; return instance; }
+
+	static bool isEnabled()                                         { return enabled; }
+	static void setEnabled(bool e)                                  { enabled = e; }
+
+	void add(const std::string& stage, double microseconds)         { stages[stage].add(microseconds); }
+	void reset()                                                    { stages.clear(); }
+
+	const std::map<std::string, Statistic>& getStages() const       { return stages; }
+
+	std::string getReport() const;                                  // table with count, mean, p50, p95 and max in ms
+	bool writeReport(const std::string& filename) const;
+
+private:
+	PaintTiming() = default;
+
+	static bool enabled;
+	std::map<std::string, Statistic> stages;
+};
+
+
+class ScopedPaintTimer
+{
+	typedef std::chrono::steady_clock Clock;
+
+	const char*       stage;
+	const QString*    detail = nullptr;
+	const bool        active;
+	Clock::time_point start;
+
+	void stop();
+
+	ScopedPaintTimer(const ScopedPaintTimer&)            = delete;
+	ScopedPaintTimer& operator=(const ScopedPaintTimer&) = delete;
+public:
+	explicit ScopedPaintTimer(const char* stage) : stage(stage), active(PaintTiming::isEnabled())
+	                                                                { if(active) start = Clock::now(); }
+	// detail (e.g. the marker id) is appended to the stage name, it must live as long as the timer
+	ScopedPaintTimer(const char* stage, const QString& detail) : stage(stage), detail(&detail), active(PaintTiming::isEnabled())
+	                                                                { if(active) start = Clock::now(); }
+	~ScopedPaintTimer()                                             { if(active) stop(); }
+};
@@ -0,0 +1,73 @@
+/*
+ * Copyright (c) 2018 Kay Gawlik <kaydev@amarunet.de> <kay.gawlik@beuth-hochschule.de> <kay.gawlik@charite.de>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+#pragma once
+
+#include <atomic>
+#include <thread>
+#include <vector>
+#include <exception>
+#include <algorithm>
+
+
+namespace ParallelFor
+{
+	// calls fun(i) for i in [0, count) from a set of worker threads, rethrows the first exception
+	template<typename Fun>
+	void run(std::size_t count, Fun fun, std::size_t minItemsPerThread = 1)
+	{
+		std::size_t numThreads = std::max(std::thread::hardware_concurrency(), 1u);
+		numThreads = std::min(numThreads, count/std::max(minItemsPerThread, static_cast<std::size_t>(1)));
+
+		if(numThreads <= 1)
+		{
+			for(std::size_t i = 0; i < count; ++i)
+				fun(i);
+			return;
+		}
+
+		std::atomic<std::size_t> nextItem(0);
+		std::exception_ptr       firstException;
+		std::atomic<bool>        exceptionSet(false);
+
+		auto worker = [&]()
+		{
+			try
+			{
+				for(std::size_t i = nextItem++; i < count; i = nextItem++)
+					fun(i);
+			}
+			catch(...)
+			{
+				if(!exceptionSet.exchange(true))
+					firstException = std::current_exception();
+				nextItem = count;
+			}
+		};
+
+		std::vector<std::thread> threads;
+		for(std::size_t i = 1; i < numThreads; ++i)
+			threads.emplace_back(worker);
+		worker();
+
+		for(std::thread& t : threads)
+			t.join();
+
+		if(firstException)
+			std::rethrow_exception(firstException);
+	}
+}
@@ -0,0 +1,71 @@
+/*
+ * Copyright (c) 2018 Kay Gawlik <kaydev@amarunet.de> <kay.gawlik@beuth-hochschule.de> <kay.gawlik@charite.de>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+#include "parallelgzip.h"
+#include "parallelfor.h"
+
+#include <vector>
+#include <istream>
+#include <ostream>
+#include <stdexcept>
+
+#include <boost/iostreams/filtering_stream.hpp>
+#include <boost/iostreams/filter/gzip.hpp>
+#include <boost/iostreams/device/back_inserter.hpp>
+
+namespace io = boost::iostreams;
+
+
+void ParallelGzip::write(std::ostream& stream, const std::string& data, std::size_t blockSize)
+{
+	const std::size_t numBlocks = std::max(static_cast<std::size_t>(1), (data.size() + blockSize - 1)/blockSize);
+
+	std::vector<std::string> compressedBlocks(numBlocks);
+	ParallelFor::run(numBlocks, [&](std::size_t block)
+	{
+		const std::size_t begin  = block*blockSize;
+		const std::size_t length = std::min(blockSize, data.size() - std::min(begin, data.size()));
+
+		std::string& compressed = compressedBlocks[block];
+		compressed.reserve(length/4);
+
+		io::filtering_ostream out;
+		out.push(io::gzip_compressor(io::gzip_params(io::gzip::best_speed)));
+		out.push(io::back_inserter(compressed));
+		out.write(data.data() + begin, static_cast<std::streamsize>(length));
+		out.reset();
+	});
+
+	for(const std::string& compressed : compressedBlocks)
+		stream.write(compressed.data(), static_cast<std::streamsize>(compressed.size()));
+}
+
+
+void ParallelGzip::read(std::istream& stream, std::string& data)
+{
+	io::filtering_istream in;
+	in.push(io::gzip_decompressor());
+	in.push(stream);
+
+	data.clear();
+	char buffer[1 << 16];
+	while(in.read(buffer, sizeof(buffer)) || in.gcount() > 0)
+		data.append(buffer, static_cast<std::size_t>(in.gcount()));
+
+	if(in.bad())
+		throw std::runtime_error("corrupt gzip data");
+}
@@ -0,0 +1,31 @@
+/*
+ * Copyright (c) 2018 Kay Gawlik <kaydev@amarunet.de> <kay.gawlik@beuth-hochschule.de> <kay.gawlik@charite.de>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+#ifndef PARALLELGZIP_H
+#define PARALLELGZIP_H
+
+#include <string>
+#include <iosfwd>
+
+// gzip files of independently compressed blocks (gzip members), readable by every gzip reader
+namespace ParallelGzip
+{
+	void write(std::ostream& stream, const std::string& data, std::size_t blockSize = 1 << 20); // compresses the blocks in parallel
+	void read (std::istream& stream, std::string& data);                                          // streaming decompression of all members
+};
+
+#endif // PARALLELGZIP_H
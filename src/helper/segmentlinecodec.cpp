@@ -0,0 +1,626 @@
+/*
+ * Copyright (c) 2018 Kay Gawlik <kaydev@amarunet.de> <kay.gawlik@beuth-hochschule.de> <kay.gawlik@charite.de>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+#include "segmentlinecodec.h"
+#include "base64.h"
+
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <cstdint>
+#include <clocale>
+#include <limits>
+
+
+namespace
+{
+	const char        float32Prefix[]  = "f32b64:";
+	const std::size_t float32PrefixLen = sizeof(float32Prefix) - 1;
+
+	const uint64_t maxExactInt = uint64_t(1) << 53;
+	const int      maxExactPow = 22;                // 10^22 is the largest exact power of ten
+	const double   powersOfTen[maxExactPow+1] = { 1e0 , 1e1 , 1e2 , 1e3 , 1e4 , 1e5 , 1e6 , 1e7 , 1e8 , 1e9 , 1e10, 1e11
+	                                            , 1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22 };
+
+
+	// floating point number f*2^e with a 64 bit significand (Grisu, Loitsch 2010)
+	struct DiyFp
+	{
+		uint64_t f;
+		int      e;
+
+		DiyFp(uint64_t f, int e) : f(f), e(e)                     {}
+
+		DiyFp operator-(const DiyFp& other) const                  { return DiyFp(f - other.f, e); }
+
+		DiyFp operator*(const DiyFp& other) const
+		{
+			const uint64_t mask = 0xFFFFFFFFu;
+			const uint64_t aLo = f & mask, aHi = f >> 32;
+			const uint64_t bLo = other.f & mask, bHi = other.f >> 32;
+
+			const uint64_t p0 = aLo*bLo;
+			const uint64_t p1 = aLo*bHi;
+			const uint64_t p2 = aHi*bLo;
+			const uint64_t p3 = aHi*bHi;
+
+			uint64_t mid = (p0 >> 32) + (p1 & mask) + (p2 & mask);
+			mid += uint64_t(1) << 31; // round
+			return DiyFp(p3 + (p1 >> 32) + (p2 >> 32) + (mid >> 32), e + other.e + 64);
+		}
+
+		DiyFp normalized() const
+		{
+			DiyFp x = *this;
+			for(int shift = 32; shift > 0; shift /= 2)
+			{
+				if(!(x.f >> (64 - shift)))
+				{
+					x.f <<= shift;
+					x.e  -= shift;
+				}
+			}
+			return x;
+		}
+
+		DiyFp normalizedTo(int targetE) const                      { return DiyFp(f << (e - targetE), targetE); }
+	};
+
+	struct CachedPower
+	{
+		uint64_t f;
+		int      e;
+		int      k;
+	};
+
+	// 10^k ~ f*2^e for k = -300, -292, ..., 324
+	const int         cachedPowersMinDecExp = -300;
+	const int         cachedPowersDecStep   = 8;
+	const CachedPower cachedPowers[] =
+	{
+		{ 0xAB70FE17C79AC6CA, -1060, -300 },
+		{ 0xFF77B1FCBEBCDC4F, -1034, -292 },
+		{ 0xBE5691EF416BD60C, -1007, -284 },
+		{ 0x8DD01FAD907FFC3C,  -980, -276 },
+		{ 0xD3515C2831559A83,  -954, -268 },
+		{ 0x9D71AC8FADA6C9B5,  -927, -260 },
+		{ 0xEA9C227723EE8BCB,  -901, -252 },
+		{ 0xAECC49914078536D,  -874, -244 },
+		{ 0x823C12795DB6CE57,  -847, -236 },
+		{ 0xC21094364DFB5637,  -821, -228 },
+		{ 0x9096EA6F3848984F,  -794, -220 },
+		{ 0xD77485CB25823AC7,  -768, -212 },
+		{ 0xA086CFCD97BF97F4,  -741, -204 },
+		{ 0xEF340A98172AACE5,  -715, -196 },
+		{ 0xB23867FB2A35B28E,  -688, -188 },
+		{ 0x84C8D4DFD2C63F3B,  -661, -180 },
+		{ 0xC5DD44271AD3CDBA,  -635, -172 },
+		{ 0x936B9FCEBB25C996,  -608, -164 },
+		{ 0xDBAC6C247D62A584,  -582, -156 },
+		{ 0xA3AB66580D5FDAF6,  -555, -148 },
+		{ 0xF3E2F893DEC3F126,  -529, -140 },
+		{ 0xB5B5ADA8AAFF80B8,  -502, -132 },
+		{ 0x87625F056C7C4A8B,  -475, -124 },
+		{ 0xC9BCFF6034C13053,  -449, -116 },
+		{ 0x964E858C91BA2655,  -422, -108 },
+		{ 0xDFF9772470297EBD,  -396, -100 },
+		{ 0xA6DFBD9FB8E5B88F,  -369,  -92 },
+		{ 0xF8A95FCF88747D94,  -343,  -84 },
+		{ 0xB94470938FA89BCF,  -316,  -76 },
+		{ 0x8A08F0F8BF0F156B,  -289,  -68 },
+		{ 0xCDB02555653131B6,  -263,  -60 },
+		{ 0x993FE2C6D07B7FAC,  -236,  -52 },
+		{ 0xE45C10C42A2B3B06,  -210,  -44 },
+		{ 0xAA242499697392D3,  -183,  -36 },
+		{ 0xFD87B5F28300CA0E,  -157,  -28 },
+		{ 0xBCE5086492111AEB,  -130,  -20 },
+		{ 0x8CBCCC096F5088CC,  -103,  -12 },
+		{ 0xD1B71758E219652C,   -77,   -4 },
+		{ 0x9C40000000000000,   -50,    4 },
+		{ 0xE8D4A51000000000,   -24,   12 },
+		{ 0xAD78EBC5AC620000,     3,   20 },
+		{ 0x813F3978F8940984,    30,   28 },
+		{ 0xC097CE7BC90715B3,    56,   36 },
+		{ 0x8F7E32CE7BEA5C70,    83,   44 },
+		{ 0xD5D238A4ABE98068,   109,   52 },
+		{ 0x9F4F2726179A2245,   136,   60 },
+		{ 0xED63A231D4C4FB27,   162,   68 },
+		{ 0xB0DE65388CC8ADA8,   189,   76 },
+		{ 0x83C7088E1AAB65DB,   216,   84 },
+		{ 0xC45D1DF942711D9A,   242,   92 },
+		{ 0x924D692CA61BE758,   269,  100 },
+		{ 0xDA01EE641A708DEA,   295,  108 },
+		{ 0xA26DA3999AEF774A,   322,  116 },
+		{ 0xF209787BB47D6B85,   348,  124 },
+		{ 0xB454E4A179DD1877,   375,  132 },
+		{ 0x865B86925B9BC5C2,   402,  140 },
+		{ 0xC83553C5C8965D3D,   428,  148 },
+		{ 0x952AB45CFA97A0B3,   455,  156 },
+		{ 0xDE469FBD99A05FE3,   481,  164 },
+		{ 0xA59BC234DB398C25,   508,  172 },
+		{ 0xF6C69A72A3989F5C,   534,  180 },
+		{ 0xB7DCBF5354E9BECE,   561,  188 },
+		{ 0x88FCF317F22241E2,   588,  196 },
+		{ 0xCC20CE9BD35C78A5,   614,  204 },
+		{ 0x98165AF37B2153DF,   641,  212 },
+		{ 0xE2A0B5DC971F303A,   667,  220 },
+		{ 0xA8D9D1535CE3B396,   694,  228 },
+		{ 0xFB9B7CD9A4A7443C,   720,  236 },
+		{ 0xBB764C4CA7A44410,   747,  244 },
+		{ 0x8BAB8EEFB6409C1A,   774,  252 },
+		{ 0xD01FEF10A657842C,   800,  260 },
+		{ 0x9B10A4E5E9913129,   827,  268 },
+		{ 0xE7109BFBA19C0C9D,   853,  276 },
+		{ 0xAC2820D9623BF429,   880,  284 },
+		{ 0x80444B5E7AA7CF85,   907,  292 },
+		{ 0xBF21E44003ACDD2D,   933,  300 },
+		{ 0x8E679C2F5E44FF8F,   960,  308 },
+		{ 0xD433179D9C8CB841,   986,  316 },
+		{ 0x9E19DB92B4E31BA9,  1013,  324 }
+	};
+	const int numCachedPowers = sizeof(cachedPowers)/sizeof(cachedPowers[0]);
+
+	const int grisuAlpha = -60;
+	const int grisuGamma = -32;
+
+
+	void computeBoundaries(double value, DiyFp& v, DiyFp& minus, DiyFp& plus)
+	{
+		const uint64_t hiddenBit = uint64_t(1) << 52;
+		const int      minExp    = 1 - 1075;
+
+		uint64_t bits;
+		std::memcpy(&bits, &value, sizeof(bits));
+		const uint64_t fraction = bits & (hiddenBit - 1);
+		const int      exponent = static_cast<int>((bits >> 52) & 0x7FF);
+
+		const DiyFp w = exponent == 0 ? DiyFp(fraction, minExp) : DiyFp(fraction + hiddenBit, exponent - 1075);
+		const bool lowerBoundaryIsCloser = fraction == 0 && exponent > 1;
+
+		plus  = DiyFp(2*w.f + 1, w.e - 1).normalized();
+		minus = (lowerBoundaryIsCloser ? DiyFp(4*w.f - 1, w.e - 2) : DiyFp(2*w.f - 1, w.e - 1)).normalizedTo(plus.e);
+		v     = w.normalized();
+	}
+
+	const CachedPower& cachedPowerForBinaryExponent(int e)
+	{
+		const int f = grisuAlpha - e - 1;
+		const int k = (f*78913)/(1 << 18) + (f > 0); // ceil(f*log10(2))
+		const int index = (-cachedPowersMinDecExp + k + (cachedPowersDecStep - 1))/cachedPowersDecStep;
+		return cachedPowers[index];
+	}
+
+	int largestPow10(uint32_t n, uint32_t& pow10)
+	{
+		static const uint32_t powers[] = { 1, 10, 100, 1000, 10000, 100000, 1000000, 10000000, 100000000, 1000000000 };
+		int digits = 10;
+		while(digits > 1 && n < powers[digits-1])
+			--digits;
+		pow10 = powers[digits-1];
+		return digits;
+	}
+
+	void grisuRound(char* buffer, int length, uint64_t dist, uint64_t delta, uint64_t rest, uint64_t tenK)
+	{
+		while(rest < dist
+		   && delta - rest >= tenK
+		   && (rest + tenK < dist || dist - rest > rest + tenK - dist))
+		{
+			--buffer[length - 1];
+			rest += tenK;
+		}
+	}
+
+	// shortest digits (in almost all cases) of value = digits * 10^decimalExponent, the digits are read back to value
+	int grisu2(char* buffer, int& decimalExponent, double value)
+	{
+		DiyFp v(0, 0), minus(0, 0), plus(0, 0);
+		computeBoundaries(value, v, minus, plus);
+
+		const CachedPower& cached = cachedPowerForBinaryExponent(plus.e);
+		const DiyFp c(cached.f, cached.e);
+
+		const DiyFp w      = v*c;
+		const DiyFp wMinus = minus*c;
+		const DiyFp wPlus  = plus*c;
+
+		const DiyFp mMinus(wMinus.f + 1, wMinus.e);
+		const DiyFp mPlus (wPlus .f - 1, wPlus .e);
+
+		decimalExponent = -cached.k;
+
+		uint64_t delta = (mPlus - mMinus).f;
+		uint64_t dist  = (mPlus - w     ).f;
+
+		const DiyFp one(uint64_t(1) << -mPlus.e, mPlus.e);
+
+		uint32_t p1 = static_cast<uint32_t>(mPlus.f >> -one.e);
+		uint64_t p2 = mPlus.f & (one.f - 1);
+
+		int length = 0;
+		uint32_t pow10;
+		for(int n = largestPow10(p1, pow10); n > 0; --n)
+		{
+			const uint32_t digit = p1/pow10;
+			p1 %= pow10;
+			buffer[length++] = static_cast<char>('0' + digit);
+
+			const uint64_t rest = (uint64_t(p1) << -one.e) + p2;
+			if(rest <= delta)
+			{
+				decimalExponent += n - 1;
+				grisuRound(buffer, length, dist, delta, rest, uint64_t(pow10) << -one.e);
+				return length;
+			}
+			pow10 /= 10;
+		}
+
+		for(;;)
+		{
+			p2 *= 10;
+			buffer[length++] = static_cast<char>('0' + (p2 >> -one.e));
+			p2 &= one.f - 1;
+			delta *= 10;
+			dist  *= 10;
+			--decimalExponent;
+			if(p2 <= delta)
+				break;
+		}
+		grisuRound(buffer, length, dist, delta, p2, one.f);
+		return length;
+	}
+
+	// fixed notation for moderate exponents, otherwise d.ddde+x
+	void appendDecimal(std::string& str, const char* digits, int length, int decimalExponent)
+	{
+		const int pointPos = length + decimalExponent; // position of the decimal point relative to the first digit
+
+		if(decimalExponent >= 0 && pointPos <= 21)
+		{
+			str.append(digits, static_cast<std::size_t>(length));
+			str.append(static_cast<std::size_t>(decimalExponent), '0');
+		}
+		else if(pointPos > 0 && pointPos <= 21)
+		{
+			str.append(digits, static_cast<std::size_t>(pointPos));
+			str.push_back('.');
+			str.append(digits + pointPos, static_cast<std::size_t>(length - pointPos));
+		}
+		else if(pointPos > -6 && pointPos <= 0)
+		{
+			str.append("0.");
+			str.append(static_cast<std::size_t>(-pointPos), '0');
+			str.append(digits, static_cast<std::size_t>(length));
+		}
+		else
+		{
+			str.push_back(digits[0]);
+			if(length > 1)
+			{
+				str.push_back('.');
+				str.append(digits + 1, static_cast<std::size_t>(length - 1));
+			}
+			str.push_back('e');
+			int exponent = pointPos - 1;
+			if(exponent < 0)
+			{
+				str.push_back('-');
+				exponent = -exponent;
+			}
+			char expDigits[4];
+			int  numExpDigits = 0;
+			do
+			{
+				expDigits[numExpDigits++] = static_cast<char>('0' + exponent%10);
+				exponent /= 10;
+			} while(exponent > 0);
+			while(numExpDigits > 0)
+				str.push_back(expDigits[--numExpDigits]);
+		}
+	}
+
+
+	bool matchWord(const char*& pos, const char* end, const char* word)
+	{
+		const char* p = pos;
+		for(; *word; ++word, ++p)
+			if(p == end || (*p | 0x20) != *word)
+				return false;
+		pos = p;
+		return true;
+	}
+
+	// strtod depends on LC_NUMERIC, which Qt sets from the environment
+	double parseDoubleFallback(const char* begin, const char* end)
+	{
+		std::string buffer(begin, end);
+		const char* point = std::localeconv()->decimal_point;
+		if(point && *point && *point != '.')
+			for(char& c : buffer)
+				if(c == '.')
+					c = *point;
+		return std::strtod(buffer.c_str(), nullptr);
+	}
+
+	// mantissa*10^exponent with an exact 64 bit mantissa, false if the rounding can't be decided
+	bool mantissaPow10ToDouble(uint64_t mantissa, int exponent, double& value)
+	{
+		if(mantissa == 0)
+		{
+			value = 0;
+			return true;
+		}
+		if(exponent < cachedPowersMinDecExp || exponent >= cachedPowersMinDecExp + numCachedPowers*cachedPowersDecStep)
+			return false;
+
+		static const uint64_t smallPowers[cachedPowersDecStep] = { 1, 10, 100, 1000, 10000, 100000, 1000000, 10000000 };
+
+		const int index  = (exponent - cachedPowersMinDecExp)/cachedPowersDecStep;
+		const int adjust = (exponent - cachedPowersMinDecExp)%cachedPowersDecStep;
+		const CachedPower& cached = cachedPowers[index];
+
+		DiyFp x = DiyFp(mantissa, 0).normalized()*DiyFp(cached.f, cached.e);
+		if(adjust > 0)
+			x = x*DiyFp(smallPowers[adjust], 0).normalized();
+		x = x.normalized();
+
+		// at most a few units of the last bit off, undecidable if near the half way point of the 53 bit rounding
+		const uint64_t maxError = 32;
+		const uint64_t lowBits  = x.f & 0x7FF;
+		if(lowBits + maxError >= 0x400 && lowBits <= 0x400 + maxError)
+			return false;
+
+		uint64_t significand = (x.f >> 11) + (lowBits > 0x400 ? 1 : 0);
+		int      binExponent = x.e + 11;
+		if(significand >> 53)
+		{
+			significand >>= 1;
+			++binExponent;
+		}
+
+		// denormal or overflow: leave it to strtod
+		if(binExponent + 52 < -1022 || binExponent + 52 > 1023)
+			return false;
+
+		value = std::ldexp(static_cast<double>(significand), binExponent);
+		return true;
+	}
+}
+
+
+void SegmentlineCodec::appendDouble(std::string& str, double value)
+{
+	if(std::isnan(value))
+	{
+		str.append("nan");
+		return;
+	}
+	if(std::isinf(value))
+	{
+		str.append(value < 0 ? "-inf" : "inf");
+		return;
+	}
+
+	if(std::signbit(value))
+	{
+		str.push_back('-');
+		value = -value;
+	}
+	if(value == 0)
+	{
+		str.push_back('0');
+		return;
+	}
+
+	char digits[32];
+	int  decimalExponent;
+	const int length = grisu2(digits, decimalExponent, value);
+	appendDecimal(str, digits, length, decimalExponent);
+}
+
+
+bool SegmentlineCodec::parseDouble(const char*& pos, const char* end, double& value)
+{
+	const char* p = pos;
+	bool negative = false;
+	if(p != end && (*p == '-' || *p == '+'))
+		negative = (*p++ == '-');
+
+	if(p != end && ((*p | 0x20) == 'n' || (*p | 0x20) == 'i'))
+	{
+		if(matchWord(p, end, "nan"))
+		{
+			if(p != end && *p == '(') // nan(char-sequence)
+			{
+				while(p != end && *p != ')')
+					++p;
+				if(p != end)
+					++p;
+			}
+			value = std::numeric_limits<double>::quiet_NaN();
+		}
+		else if(matchWord(p, end, "inf"))
+		{
+			matchWord(p, end, "inity");
+			value = std::numeric_limits<double>::infinity();
+		}
+		else
+			return false;
+
+		if(negative)
+			value = -value;
+		pos = p;
+		return true;
+	}
+
+	const char* numberBegin = pos;
+	uint64_t mantissa   = 0;
+	int      numDigits  = 0;
+	int      exponent   = 0;
+	bool     truncated  = false;
+	bool     anyDigit   = false;
+
+	for(; p != end && *p >= '0' && *p <= '9'; ++p)
+	{
+		anyDigit = true;
+		if(numDigits < 19)
+		{
+			mantissa = mantissa*10 + static_cast<uint64_t>(*p - '0');
+			if(mantissa > 0)
+				++numDigits;
+		}
+		else
+		{
+			++exponent;
+			truncated |= (*p != '0');
+		}
+	}
+	if(p != end && *p == '.')
+	{
+		for(++p; p != end && *p >= '0' && *p <= '9'; ++p)
+		{
+			anyDigit = true;
+			if(numDigits < 19)
+			{
+				mantissa = mantissa*10 + static_cast<uint64_t>(*p - '0');
+				if(mantissa > 0)
+					++numDigits;
+				--exponent;
+			}
+			else
+				truncated |= (*p != '0');
+		}
+	}
+	if(!anyDigit)
+		return false;
+
+	if(p != end && (*p | 0x20) == 'e')
+	{
+		const char* e = p + 1;
+		bool expNegative = false;
+		if(e != end && (*e == '-' || *e == '+'))
+			expNegative = (*e++ == '-');
+		if(e != end && *e >= '0' && *e <= '9')
+		{
+			int expValue = 0;
+			for(; e != end && *e >= '0' && *e <= '9'; ++e)
+				if(expValue < 100000)
+					expValue = expValue*10 + (*e - '0');
+			exponent += expNegative ? -expValue : expValue;
+			p = e;
+		}
+	}
+
+	if(!truncated && mantissa <= maxExactInt && exponent >= -maxExactPow && exponent <= maxExactPow)
+	{
+		// exact integer and exact power of ten: one correctly rounded operation (Clinger)
+		const double m = static_cast<double>(mantissa);
+		value = exponent < 0 ? m/powersOfTen[-exponent] : m*powersOfTen[exponent];
+		if(negative)
+			value = -value;
+	}
+	else if(!truncated && mantissaPow10ToDouble(mantissa, exponent, value))
+	{
+		if(negative)
+			value = -value;
+	}
+	else
+		value = parseDoubleFallback(numberBegin, p);
+
+	pos = p;
+	return true;
+}
+
+
+std::string SegmentlineCodec::encode(const std::vector<double>& line, Encoding encoding)
+{
+	std::string result;
+	switch(encoding)
+	{
+		case Encoding::Text:
+			result.reserve(line.size()*8);
+			for(double value : line)
+			{
+				appendDouble(result, value);
+				result.push_back(' ');
+			}
+			break;
+		case Encoding::Float32Base64:
+		{
+			std::vector<unsigned char> bytes;
+			bytes.reserve(line.size()*4);
+			for(double value : line)
+			{
+				const float f = std::isnan(value) ? std::numeric_limits<float>::quiet_NaN() : static_cast<float>(value);
+				uint32_t bits;
+				std::memcpy(&bits, &f, sizeof(bits));
+				for(int i = 0; i < 4; ++i)
+					bytes.push_back(static_cast<unsigned char>(bits >> (8*i))); // little endian
+			}
+			result.reserve(float32PrefixLen + (bytes.size()+2)/3*4);
+			result.append(float32Prefix);
+			Base64::append(result, bytes.data(), bytes.size());
+			break;
+		}
+	}
+	return result;
+}
+
+
+SegmentlineCodec::Encoding SegmentlineCodec::getEncoding(const std::string& str)
+{
+	if(str.compare(0, float32PrefixLen, float32Prefix) == 0)
+		return Encoding::Float32Base64;
+	return Encoding::Text;
+}
+
+std::vector<double> SegmentlineCodec::decode(const std::string& str)
+{
+	std::vector<double> result;
+	const char* pos = str.data();
+	const char* end = pos + str.size();
+
+	if(str.compare(0, float32PrefixLen, float32Prefix) == 0)
+	{
+		const std::vector<unsigned char> bytes = Base64::decode(pos + float32PrefixLen, end);
+		result.reserve(bytes.size()/4);
+		for(std::size_t i = 0; i + 3 < bytes.size(); i += 4)
+		{
+			const uint32_t bits = uint32_t(bytes[i]) | (uint32_t(bytes[i+1]) << 8) | (uint32_t(bytes[i+2]) << 16) | (uint32_t(bytes[i+3]) << 24);
+			float f;
+			std::memcpy(&f, &bits, sizeof(f));
+			result.push_back(static_cast<double>(f));
+		}
+		return result;
+	}
+
+	result.reserve(str.size()/4);
+	double value;
+	while(pos != end)
+	{
+		if(*pos == ' ')
+		{
+			++pos;
+			continue;
+		}
+		if(!parseDouble(pos, end, value))
+			break;
+		result.push_back(value);
+	}
+	return result;
+}
@@ -0,0 +1,37 @@
+/*
+ * Copyright (c) 2018 Kay Gawlik <kaydev@amarunet.de> <kay.gawlik@beuth-hochschule.de> <kay.gawlik@charite.de>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+#ifndef SEGMENTLINECODEC_H
+#define SEGMENTLINECODEC_H
+
+#include <string>
+#include <vector>
+
+// text encoding of segmentation lines in the marker files ("v v v ")
+namespace SegmentlineCodec
+{
+	enum class Encoding { Text, Float32Base64 };
+
+	void appendDouble(std::string& str, double value);                    // shortest text which is read back to the same value
+	bool parseDouble(const char*& pos, const char* end, double& value);  // locale independent, advances pos behind the number
+
+	std::string         encode(const std::vector<double>& line, Encoding encoding);
+	std::vector<double> decode(const std::string& str);                  // detects the encoding
+	Encoding            getEncoding(const std::string& str);
+};
+
+#endif // SEGMENTLINECODEC_H
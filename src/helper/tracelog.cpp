@@ -0,0 +1,168 @@
+/*
+ * Copyright (c) 2018 Kay Gawlik <kaydev@amarunet.de> <kay.gawlik@beuth-hochschule.de> <kay.gawlik@charite.de>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+#include "tracelog.h"
+
+#include <cstdio>
+#include <fstream>
+
+#include <QString>
+
+
+bool TraceLog::enabled = false;
+
+
+namespace
+{
+	const int      processId        = 1;
+	const uint32_t pipelineThreadId = 0;                            // own track for spans over several threads
+
+	std::string escapeJson(const std::string& str)
+	{
+		std::string result;
+		result.reserve(str.size());
+		for(char c : str)
+		{
+			switch(c)
+			{
+				case '"' : result += "\\\""; break;
+				case '\\': result += "\\\\"; break;
+				case '\n': result += "\\n" ; break;
+				case '\t': result += "\\t" ; break;
+				default:
+					if(static_cast<unsigned char>(c) < 0x20)
+					{
+						char buffer[8];
+						std::snprintf(buffer, sizeof(buffer), "\\u%04x", static_cast<unsigned>(c));
+						result += buffer;
+					}
+					else
+						result += c;
+			}
+		}
+		return result;
+	}
+}
+
+
+void TraceLog::start(const std::string& file)
+{
+	filename = file;
+	enabled  = true;
+}
+
+uint32_t TraceLog::getThreadId()
+{
+	const std::thread::id id = std::this_thread::get_id();
+	std::map<std::thread::id, uint32_t>::const_iterator it = threadIds.find(id);
+	if(it != threadIds.end())
+		return it->second;
+
+	const uint32_t newId = static_cast<uint32_t>(threadIds.size() + 1);
+	threadIds.emplace(id, newId);
+	return newId;
+}
+
+void TraceLog::addSpan(std::string name, const char* category, Clock::time_point begin, Clock::time_point end)
+{
+	std::lock_guard<std::mutex> lock(mutex);
+	events.push_back(Event{std::move(name), category, toUs(begin), std::chrono::duration<double, std::micro>(end - begin).count(), getThreadId()});
+}
+
+void TraceLog::setThreadName(const std::string& name)
+{
+	if(!enabled)
+		return;
+
+	std::lock_guard<std::mutex> lock(mutex);
+	threadNames[getThreadId()] = name;
+}
+
+
+void TraceLog::markFileOpen()
+{
+	if(!enabled)
+		return;
+
+	std::lock_guard<std::mutex> lock(mutex);
+	firstFrameState = FirstFrameState::Loading;
+	fileOpenTime    = Clock::now();
+}
+
+void TraceLog::markFileShown()
+{
+	if(!enabled)
+		return;
+
+	std::lock_guard<std::mutex> lock(mutex);
+	if(firstFrameState == FirstFrameState::Loading)
+		firstFrameState = FirstFrameState::Shown;
+}
+
+void TraceLog::markFramePainted()
+{
+	if(!enabled)
+		return;
+
+	std::lock_guard<std::mutex> lock(mutex);
+	if(firstFrameState != FirstFrameState::Shown)
+		return;
+
+	firstFrameState = FirstFrameState::Idle;
+	events.push_back(Event{"file open to first frame", "pipeline", toUs(fileOpenTime), toUs(Clock::now()) - toUs(fileOpenTime), pipelineThreadId});
+}
+
+
+bool TraceLog::write() const
+{
+	if(filename.empty())
+		return false;
+
+	std::ofstream stream(filename);
+	if(!stream.good())
+		return false;
+
+	std::lock_guard<std::mutex> lock(mutex);
+
+	stream << "{\"displayTimeUnit\": \"ms\", \"traceEvents\": [\n";
+	stream << "{\"name\": \"process_name\", \"ph\": \"M\", \"pid\": " << processId << ", \"args\": {\"name\": \"OCT-Marker\"}},\n";
+	stream << "{\"name\": \"thread_name\", \"ph\": \"M\", \"pid\": " << processId << ", \"tid\": " << pipelineThreadId << ", \"args\": {\"name\": \"pipeline\"}}";
+
+	for(const std::pair<const uint32_t, std::string>& threadName : threadNames)
+		stream << ",\n{\"name\": \"thread_name\", \"ph\": \"M\", \"pid\": " << processId << ", \"tid\": " << threadName.first
+		       << ", \"args\": {\"name\": \"" << escapeJson(threadName.second) << "\"}}";
+
+	char times[64];
+	for(const Event& event : events)
+	{
+		std::snprintf(times, sizeof(times), "\"ts\": %.3f, \"dur\": %.3f", event.beginUs, event.durationUs);
+		stream << ",\n{\"name\": \"" << escapeJson(event.name) << "\", \"cat\": \"" << event.category << "\", \"ph\": \"X\", "
+		       << times << ", \"pid\": " << processId << ", \"tid\": " << event.threadId << '}';
+	}
+	stream << "\n]}\n";
+
+	return stream.good();
+}
+
+
+void ScopedTrace::stop()
+{
+	if(detail)
+		TraceLog::getInstance().addSpan(std::string(name) + ' ' + detail->toStdString(), category, begin, TraceLog::Clock::now());
+	else
+		TraceLog::getInstance().addSpan(name, category, begin, TraceLog::Clock::now());
+}
@@ -0,0 +1,102 @@
+/*
+ * Copyright (c) 2018 Kay Gawlik <kaydev@amarunet.de> <kay.gawlik@beuth-hochschule.de> <kay.gawlik@charite.de>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+#pragma once
+
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+#include <chrono>
+#include <thread>
+#include <cstdint>
+
+class QString;
+
+// timeline of spans on all threads, written as Chrome trace JSON (chrome://tracing, ui.perfetto.dev)
+// disabled by default, then a span only checks one flag
+class TraceLog
+{
+public:
+	typedef std::chrono::steady_clock Clock;
+
+	static TraceLog& getInstance()                                  { static TraceLog instance; return instance; }
+
+	static bool isEnabled()                                         { return enabled; }
+	void start(const std::string& filename);                        // enables the tracing, the file is written by write()
+	bool write() const;
+
+	void addSpan(std::string name, const char* category, Clock::time_point begin, Clock::time_point end);
+	void setThreadName(const std::string& name);                    // name of the calling thread in the timeline
+
+	// span "file open to first frame": from the open request to the first BScan paint after the loaded series is shown
+	void markFileOpen();
+	void markFileShown();
+	void markFramePainted();
+
+private:
+	TraceLog() : startTime(Clock::now())                            {}
+
+	struct Event
+	{
+		std::string name;
+		const char* category;
+		double      beginUs;
+		double      durationUs;
+		uint32_t    threadId;
+	};
+
+	enum class FirstFrameState { Idle, Loading, Shown };
+
+	uint32_t getThreadId();                                         // mutex must be locked
+	double   toUs(Clock::time_point t) const                        { return std::chrono::duration<double, std::micro>(t - startTime).count(); }
+
+	static bool enabled;
+
+	const Clock::time_point startTime;
+	std::string filename;
+
+	mutable std::mutex mutex;
+	std::vector<Event> events;
+	std::map<std::thread::id, uint32_t> threadIds;
+	std::map<uint32_t, std::string>     threadNames;
+
+	FirstFrameState   firstFrameState = FirstFrameState::Idle;
+	Clock::time_point fileOpenTime;
+};
+
+
+class ScopedTrace
+{
+	const char*              name;
+	const char*              category;
+	const QString*           detail = nullptr;
+	const bool               active;
+	TraceLog::Clock::time_point begin;
+
+	void stop();
+
+	ScopedTrace(const ScopedTrace&)            = delete;
+	ScopedTrace& operator=(const ScopedTrace&) = delete;
+public:
+	explicit ScopedTrace(const char* name, const char* category = "octmarker") : name(name), category(category), active(TraceLog::isEnabled())
+	                                                                { if(active) begin = TraceLog::Clock::now(); }
+	// detail (e.g. the marker id) is appended to the name, it must live as long as the span
+	ScopedTrace(const char* name, const QString& detail, const char* category = "octmarker") : name(name), category(category), detail(&detail), active(TraceLog::isEnabled())
+	                                                                { if(active) begin = TraceLog::Clock::now(); }
+	~ScopedTrace()                                                  { if(active) stop(); }
+};
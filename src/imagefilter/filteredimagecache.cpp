@@ -0,0 +1,118 @@
+/*
+ * Copyright (c) 2018 Kay Gawlik <kaydev@amarunet.de> <kay.gawlik@beuth-hochschule.de> <kay.gawlik@charite.de>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+#include "filteredimagecache.h"
+
+#include "filterimage.h"
+
+#include <helper/memoryusage.h>
+#include <helper/matbufferpool.h>
+
+
+void FilteredImageCache::checkFilter(const FilterImage& filter)
+{
+	if(this->filter != &filter || parameterVersion != filter.getParameterVersion())
+	{
+		entries.clear();
+		this->filter     = &filter;
+		parameterVersion = filter.getParameterVersion();
+	}
+}
+
+bool FilteredImageCache::moveToFront(const cv::Mat& source)
+{
+	for(std::list<Entry>::iterator it = entries.begin(); it != entries.end(); ++it)
+	{
+		const cv::Mat& entrySource = it->source;
+		if(entrySource.data == source.data && entrySource.size() == source.size() && entrySource.type() == source.type() && entrySource.step[0] == source.step[0])
+		{
+			entries.splice(entries.begin(), entries, it);
+			return true;
+		}
+	}
+	return false;
+}
+
+bool FilteredImageCache::get(const FilterImage& filter, const cv::Mat& source, cv::Mat& filtered)
+{
+	checkFilter(filter);
+
+	if(!moveToFront(source))
+		return false;
+
+	filtered = entries.front().filtered;
+	return true;
+}
+
+bool FilteredImageCache::contains(const FilterImage& filter, const cv::Mat& source)
+{
+	checkFilter(filter);
+	return moveToFront(source);
+}
+
+cv::Mat FilteredImageCache::takeBuffer(int rows, int cols, int type)
+{
+	if(maxEntries == 0 || entries.size() < maxEntries)
+		return cv::Mat();
+
+	// evicted here instead of in put, the memory of the result is used again if nobody else shows it
+	cv::Mat buffer = entries.back().filtered;
+	entries.pop_back();
+
+	if(buffer.empty() || !MatBufferPool::isUnused(buffer))
+		return cv::Mat();
+
+	buffer.create(rows, cols, type);
+	return buffer;
+}
+
+std::size_t FilteredImageCache::getFilteredBytes() const
+{
+	std::size_t bytes = 0;
+	for(const Entry& entry : entries)
+		bytes += MemoryUsage::bytes(entry.filtered);
+	return bytes;
+}
+
+void FilteredImageCache::setMaxEntries(std::size_t max)
+{
+	maxEntries = max;
+	while(entries.size() > maxEntries)
+		entries.pop_back();
+}
+
+void FilteredImageCache::put(const FilterImage& filter, const cv::Mat& source, const cv::Mat& filtered)
+{
+	checkFilter(filter);
+
+	if(maxEntries == 0)
+		return;
+
+	if(moveToFront(source))
+	{
+		entries.front().filtered = filtered;
+		return;
+	}
+
+	Entry entry;
+	entry.source   = source;
+	entry.filtered = filtered;
+	entries.push_front(entry);
+
+	while(entries.size() > maxEntries)
+		entries.pop_back();
+}
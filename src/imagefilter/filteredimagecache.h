@@ -0,0 +1,60 @@
+/*
+ * Copyright (c) 2018 Kay Gawlik <kaydev@amarunet.de> <kay.gawlik@beuth-hochschule.de> <kay.gawlik@charite.de>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+#pragma once
+
+#include <list>
+#include <cstddef>
+
+#include <opencv2/core/core.hpp>
+
+class FilterImage;
+
+// filter results of the last shown images (e.g. per BScan), valid for one parameter set of one filter
+// the source images are held, so the data pointer identifies the image as long as it is cached
+class FilteredImageCache
+{
+	struct Entry
+	{
+		cv::Mat source;
+		cv::Mat filtered;
+	};
+
+	std::list<Entry>   entries;                                     // most recently used first
+	std::size_t        maxEntries;
+	const FilterImage* filter           = nullptr;
+	std::size_t        parameterVersion = 0;
+
+	void checkFilter(const FilterImage& filter);
+	bool moveToFront(const cv::Mat& source);
+
+public:
+	explicit FilteredImageCache(std::size_t maxEntries = 16) : maxEntries(maxEntries) {}
+
+	bool get(const FilterImage& filter, const cv::Mat& source, cv::Mat& filtered);
+	void put(const FilterImage& filter, const cv::Mat& source, const cv::Mat& filtered);
+	bool contains(const FilterImage& filter, const cv::Mat& source);   // marks the entry as recently used
+
+	cv::Mat takeBuffer(int rows, int cols, int type);               // for the next put, the least recently used result when the cache is full
+
+	void setMaxEntries(std::size_t max);
+
+	void clear()                                                    { entries.clear(); }
+
+	std::size_t size() const                                        { return entries.size(); }
+	std::size_t getFilteredBytes() const;                           // the source images belong to the caller
+};
@@ -21,31 +21,16 @@
 #include <opencv/cv.h>
 #include <cmath>
 
-#include <iostream>
 
 void FilterGammaContrastBrightness::applyFilter(const cv::Mat& in, cv::Mat& out) const
 {
-	if(in.type() != cv::DataType<uint8_t>::type || !in.isContinuous())
+	if(in.depth() != cv::DataType<uint8_t>::type)
 	{
 		out = in;
 		return;
 	}
 
-	if(&out != &in)
-	{
-		if(out.type() != cv::DataType<uint8_t>::type || out.rows != in.rows || out.cols != in.cols || out.channels() != in.channels())
-			out.create(in.rows, in.cols, CV_MAKETYPE(cv::DataType<uint8_t>::type, in.channels()));
-	}
-
-	const uint8_t* dataIn  = in .ptr<uint8_t>();
-	      uint8_t* dataOut = out.ptr<uint8_t>();
-
-	for(int i = 0; i < in.rows*in.cols*in.channels(); ++i)
-	{
-		*dataOut = lut[*dataIn];
-		++dataIn;
-		++dataOut;
-	}
+	applyLut(in, out, lut);
 }
 
 
@@ -61,5 +46,5 @@ void FilterGammaContrastBrightness::calcLut()
 		lut[i] = cv::saturate_cast<uchar>((gammaValue*contrast + brightness)*255.0);
 	}
 
-	parameterChanged();
+	notifyParameterChanged();
 }
@@ -41,7 +41,10 @@ public:
 		bool operator!=(const Parameter& other) const                  { return !operator==(other); }
 	};
 
+	FilterGammaContrastBrightness()                                { calcLut(); }
+
 	virtual void applyFilter(const cv::Mat& in, cv::Mat& out) const override;
+	virtual const uint8_t* getLut() const override                 { return lut; }
 
 	void setParameter(const Parameter& para)                        { if(parameter != para) { parameter = para; calcLut(); } }
 
@@ -50,7 +53,7 @@ private:
 
 	Parameter parameter;
 
-	unsigned char lut[256];
+	uint8_t lut[256];
 };
 
 #endif // FILTERGAMMACONTRASTBRIGHTNESS_H
@@ -1 +1,50 @@
+/*
+ * Copyright (c) 2018 Kay Gawlik <kaydev@amarunet.de> <kay.gawlik@beuth-hochschule.de> <kay.gawlik@charite.de>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
 #include "filterimage.h"
+
+#include <opencv2/opencv.hpp>
+
+
+void FilterImage::applyLut(const cv::Mat& in, cv::Mat& out, const uint8_t* lut)
+{
+	// cv::LUT is vectorized and runs in parallel for large images
+	const cv::Mat lutMat(1, 256, cv::DataType<uint8_t>::type, const_cast<uint8_t*>(lut));
+	cv::LUT(in, lutMat, out);
+}
+
+void FilterImage::applyFilterRegion(const cv::Mat& in, cv::Mat& out, const cv::Rect& region) const
+{
+	const cv::Rect imageRegion = region & cv::Rect(0, 0, in.cols, in.rows);
+	if(imageRegion.area() == 0)
+		return;
+
+	const uint8_t* lut = getLut();
+	if(lut && in.depth() == cv::DataType<uint8_t>::type && out.type() == in.type() && out.size() == in.size())
+	{
+		cv::Mat outRegion = out(imageRegion);
+		applyLut(in(imageRegion), outRegion, lut);
+		return;
+	}
+
+	cv::Mat filtered;
+	applyFilter(in, filtered);
+	if(out.type() == filtered.type() && out.size() == filtered.size())
+		filtered(imageRegion).copyTo(out(imageRegion));
+	else
+		out = filtered;
+}
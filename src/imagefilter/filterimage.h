@@ -15,21 +15,38 @@
  * along with this program.  If not, see <http://www.gnu.org/licenses/>.
  *
  */
-
 #pragma once
 
 #include <QObject>
 
-namespace cv { class Mat; }
+#include <cstdint>
+#include <cstddef>
+
+namespace cv { class Mat; template<typename T> class Rect_; typedef Rect_<int> Rect; }
 
 class FilterImage : public QObject
 {
 	Q_OBJECT
+
+	std::size_t parameterVersion = 0;
+
 public:
 	virtual void applyFilter(const cv::Mat& in, cv::Mat& out) const = 0;
 
+	// writes only region of out, out must already have the size and type of the filtered image
+	virtual void applyFilterRegion(const cv::Mat& in, cv::Mat& out, const cv::Rect& region) const;
+
+	// 256 entry lookup table for pointwise filters on 8 bit images, nullptr for other filters
+	virtual const uint8_t* getLut() const                          { return nullptr; }
+
+	// changes with every parameter change, key for cached filter results
+	std::size_t getParameterVersion() const                         { return parameterVersion; }
+
+	static void applyLut(const cv::Mat& in, cv::Mat& out, const uint8_t* lut);
+
+protected:
+	void notifyParameterChanged()                                   { ++parameterVersion; emit(parameterChanged()); }
 
 signals:
 	void parameterChanged();
 };
-
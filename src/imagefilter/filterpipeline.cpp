@@ -0,0 +1,110 @@
+/*
+ * Copyright (c) 2018 Kay Gawlik <kaydev@amarunet.de> <kay.gawlik@beuth-hochschule.de> <kay.gawlik@charite.de>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+#include "filterpipeline.h"
+
+#include <algorithm>
+
+#include <opencv2/opencv.hpp>
+
+
+void FilterPipeline::addFilter(const FilterImage* filter)
+{
+	if(!filter || std::find(filters.begin(), filters.end(), filter) != filters.end())
+		return;
+
+	filters.push_back(filter);
+	connect(filter, &FilterImage::parameterChanged, this, &FilterPipeline::filterParameterChanged);
+	filterParameterChanged();
+}
+
+void FilterPipeline::removeFilter(const FilterImage* filter)
+{
+	std::vector<const FilterImage*>::iterator it = std::find(filters.begin(), filters.end(), filter);
+	if(it == filters.end())
+		return;
+
+	disconnect(filter, &FilterImage::parameterChanged, this, &FilterPipeline::filterParameterChanged);
+	filters.erase(it);
+	filterParameterChanged();
+}
+
+void FilterPipeline::filterParameterChanged()
+{
+	updateStages();
+	notifyParameterChanged();
+}
+
+void FilterPipeline::updateStages()
+{
+	stages.clear();
+	for(const FilterImage* filter : filters)
+	{
+		const uint8_t* filterLut = filter->getLut();
+		if(!filterLut)
+		{
+			Stage stage;
+			stage.filter = filter;
+			stages.push_back(stage);
+			continue;
+		}
+
+		if(stages.empty() || stages.back().filter)
+		{
+			Stage stage;
+			std::copy(filterLut, filterLut + 256, stage.lut);
+			stages.push_back(stage);
+		}
+		else
+		{
+			uint8_t* lut = stages.back().lut;                        // fuse: lut(x) = filterLut(lut(x))
+			for(int i = 0; i < 256; ++i)
+				lut[i] = filterLut[lut[i]];
+		}
+	}
+}
+
+const uint8_t* FilterPipeline::getLut() const
+{
+	if(stages.size() == 1 && !stages.front().filter)
+		return stages.front().lut;
+	return nullptr;
+}
+
+void FilterPipeline::applyFilter(const cv::Mat& in, cv::Mat& out) const
+{
+	if(stages.empty())
+	{
+		out = in;
+		return;
+	}
+
+	cv::Mat actImage = in;
+	for(const Stage& stage : stages)
+	{
+		cv::Mat stageOut;
+		if(stage.filter)
+			stage.filter->applyFilter(actImage, stageOut);
+		else if(actImage.depth() == cv::DataType<uint8_t>::type)
+			applyLut(actImage, stageOut, stage.lut);
+		else
+			stageOut = actImage;
+		actImage = stageOut;
+	}
+
+	out = actImage;
+}
@@ -0,0 +1,49 @@
+/*
+ * Copyright (c) 2018 Kay Gawlik <kaydev@amarunet.de> <kay.gawlik@beuth-hochschule.de> <kay.gawlik@charite.de>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+#pragma once
+
+#include "filterimage.h"
+
+#include <vector>
+
+// chain of filters, consecutive pointwise filters (getLut) are fused to one lookup table
+class FilterPipeline : public FilterImage
+{
+	Q_OBJECT
+
+	struct Stage
+	{
+		const FilterImage* filter = nullptr;                        // nullptr: fused lookup table
+		uint8_t lut[256];
+	};
+
+	std::vector<const FilterImage*> filters;
+	std::vector<Stage>              stages;
+
+	void updateStages();
+
+public:
+	void addFilter   (const FilterImage* filter);
+	void removeFilter(const FilterImage* filter);
+
+	virtual void applyFilter(const cv::Mat& in, cv::Mat& out) const override;
+	virtual const uint8_t* getLut() const override;
+
+private slots:
+	void filterParameterChanged();
+};
@@ -30,6 +30,13 @@
 
 #include <windows/octmarkermainwindow.h>
 #include <windows/stupidsplinewindow.h>
+#include <widgets/bscanmarkerwidget.h>
+#include <widgets/sloimagewidget.h>
+#include <widgets/dwmemoryusage.h>
+#include <manager/octdatamanager.h>
+#include <manager/inputrecorder.h>
+#include <manager/inputreplay.h>
+#include <helper/tracelog.h>
 #include "data_structure/programoptions.h"
 
 #include <buildconstants.h>
@@ -94,6 +101,19 @@ int main(int argc, char **argv)
 		{{"i", "ini-file"},
 		    QCoreApplication::translate("main", "use config from ini file"),
 		    QCoreApplication::translate("main", "ini file")},
+		{"record-input",
+		    QCoreApplication::translate("main", "record the mouse and key events of the BScan and SLO view into a file"),
+		    QCoreApplication::translate("main", "file")},
+		{"replay-input",
+		    QCoreApplication::translate("main", "replay recorded events against the oct file, print the latency and quit (usable with QT_QPA_PLATFORM=offscreen)"),
+		    QCoreApplication::translate("main", "file")},
+		{"replay-realtime"         , QCoreApplication::translate("main", "replay with the recorded timing instead of as fast as possible")},
+		{"trace",
+		    QCoreApplication::translate("main", "write a timeline of file loading and painting as Chrome trace JSON at exit (chrome://tracing)"),
+		    QCoreApplication::translate("main", "file")},
+		{"memory-report",
+		    QCoreApplication::translate("main", "write the memory usage of the data, markers and caches at exit (also after --replay-input)"),
+		    QCoreApplication::translate("main", "file")},
 	});
 
 	parser.addHelpOption();
@@ -123,6 +143,18 @@ int main(int argc, char **argv)
 	if(parser.isSet("dont-save-options"))
 		ProgramOptions::setSaveOptions(false);
 
+	if(parser.isSet("trace"))
+	{
+		const std::string traceFile = parser.value("trace").toStdString();
+		TraceLog::getInstance().start(traceFile);
+		TraceLog::getInstance().setThreadName("GUI");
+		QObject::connect(&app, &QCoreApplication::aboutToQuit, [traceFile]()
+		{
+			if(!TraceLog::getInstance().write())
+				std::cerr << "Error: can't write trace file " << traceFile << '\n';
+		});
+	}
+
     const QStringList fileList = parser.positionalArguments();
 
 	bool gitTimeOk = true;
@@ -156,8 +188,59 @@ int main(int argc, char **argv)
 	else
 	{
 		ProgramOptions::readAllOptions();
+
+		InputReplay replay;
+		const bool replayInput = parser.isSet("replay-input");
+		if(replayInput)
+		{
+			if(fileList.size() == 0 || !replay.load(parser.value("replay-input")))
+			{
+				std::cerr << "Error: replay needs a readable recording and an oct file\n";
+				return 1;
+			}
+			// the replay must not change the options or the markers of the user
+			ProgramOptions::setSaveOptions(false);
+			ProgramOptions::autoSaveOctMarkers.setValue(false);
+			replay.setRealTime(parser.isSet("replay-realtime"));
+		}
+
 		bool loadFile = fileList.size() > 0;
 		OCTMarkerMainWindow octMarkerProg(!loadFile);
+
+		InputRecorder recorder;
+		if(parser.isSet("record-input"))
+		{
+			if(!recorder.start(parser.value("record-input")))
+				std::cerr << "Error: can't write input recording " << parser.value("record-input").toStdString() << '\n';
+			recorder.addWidget(octMarkerProg.findChild<BScanMarkerWidget*>(), "bscan");
+			recorder.addWidget(octMarkerProg.findChild<SLOImageWidget*   >(), "slo"  );
+		}
+
+		if(parser.isSet("memory-report"))
+		{
+			const std::string reportFile = parser.value("memory-report").toStdString();
+			const DWMemoryUsage* memoryUsage = octMarkerProg.findChild<DWMemoryUsage*>();
+			QObject::connect(&app, &QCoreApplication::aboutToQuit, [reportFile, memoryUsage]()
+			{
+				if(!memoryUsage->writeReport(reportFile))
+					std::cerr << "Error: can't write memory report " << reportFile << '\n';
+			});
+		}
+
+		if(replayInput)
+		{
+			replay.addWidget(octMarkerProg.findChild<BScanMarkerWidget*>(), "bscan");
+			replay.addWidget(octMarkerProg.findChild<SLOImageWidget*   >(), "slo"  );
+
+			// start when the file is completely loaded
+			QObject::connect(&OctDataManager::getInstance(), &OctDataManager::loadFileSignal, &replay, [&replay](bool loading)
+			{
+				if(!loading)
+					QMetaObject::invokeMethod(&replay, "run", Qt::QueuedConnection);
+			});
+			QObject::connect(&replay, &InputReplay::finished, &app, &QCoreApplication::exit, Qt::QueuedConnection);
+		}
+
 		if(loadFile)
 			octMarkerProg.loadFile(fileList.at(0));
 		octMarkerProg.show();
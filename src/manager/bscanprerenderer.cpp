@@ -0,0 +1,117 @@
+/*
+ * Copyright (c) 2018 Kay Gawlik <kaydev@amarunet.de> <kay.gawlik@beuth-hochschule.de> <kay.gawlik@charite.de>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+#include "bscanprerenderer.h"
+
+#include <algorithm>
+
+#include <imagefilter/filterimage.h>
+
+
+BScanPrerenderer::BScanPrerenderer()
+{
+	start(QThread::LowPriority);
+}
+
+BScanPrerenderer::~BScanPrerenderer()
+{
+	{
+		QMutexLocker locker(&mutex);
+		stop = true;
+		jobs.clear();
+	}
+	jobAvailable.wakeAll();
+	wait();
+}
+
+void BScanPrerenderer::request(const std::vector<std::pair<int, cv::Mat>>& images, const FilterImage& filter)
+{
+	const uint8_t* lut = filter.getLut();
+
+	QMutexLocker locker(&mutex);
+	++generation;
+	jobs.clear();
+	results.clear();
+
+	if(!lut)
+		return;
+
+	for(const std::pair<int, cv::Mat>& image : images)
+	{
+		if(image.second.empty() || image.second.depth() != cv::DataType<uint8_t>::type)
+			continue;
+
+		Job job;
+		job.bscan         = image.first;
+		job.source        = image.second;
+		job.generation    = generation;
+		job.filterVersion = filter.getParameterVersion();
+		std::copy(lut, lut + 256, job.lut);
+		jobs.push_back(job);
+	}
+
+	if(!jobs.empty())
+		jobAvailable.wakeOne();
+}
+
+void BScanPrerenderer::cancel()
+{
+	QMutexLocker locker(&mutex);
+	++generation;
+	jobs.clear();
+	results.clear();
+}
+
+std::vector<BScanPrerenderer::Result> BScanPrerenderer::takeResults()
+{
+	QMutexLocker locker(&mutex);
+	std::vector<Result> takenResults;
+	takenResults.swap(results);
+	return takenResults;
+}
+
+void BScanPrerenderer::run()
+{
+	for(;;)
+	{
+		Job job;
+		{
+			QMutexLocker locker(&mutex);
+			while(!stop && jobs.empty())
+				jobAvailable.wait(&mutex);
+			if(stop)
+				return;
+
+			job = jobs.front();
+			jobs.pop_front();
+		}
+
+		Result result;
+		result.bscan         = job.bscan;
+		result.filterVersion = job.filterVersion;
+		result.source        = job.source;
+		FilterImage::applyLut(job.source, result.filtered, job.lut);
+
+		{
+			QMutexLocker locker(&mutex);
+			if(job.generation != generation)                        // cancelled while rendering
+				continue;
+			results.push_back(result);
+		}
+		emit(imagesRendered());
+	}
+}
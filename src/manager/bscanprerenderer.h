@@ -0,0 +1,78 @@
+/*
+ * Copyright (c) 2018 Kay Gawlik <kaydev@amarunet.de> <kay.gawlik@beuth-hochschule.de> <kay.gawlik@charite.de>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+#pragma once
+
+#include <QThread>
+#include <QMutex>
+#include <QWaitCondition>
+
+#include <deque>
+#include <vector>
+#include <cstdint>
+
+#include <opencv2/core/core.hpp>
+
+class FilterImage;
+
+// filters the images of the neighbor BScans in the background, so that scrolling through the BScans only needs cached images
+// only pointwise filters (lookup table) are rendered, the table is copied for every request
+class BScanPrerenderer : public QThread
+{
+	Q_OBJECT
+
+public:
+	struct Result
+	{
+		int         bscan;
+		std::size_t filterVersion;
+		cv::Mat     source;
+		cv::Mat     filtered;
+	};
+
+	BScanPrerenderer();
+	~BScanPrerenderer();
+
+	// replaces (cancels) the pending requests, images are rendered in the given order
+	void request(const std::vector<std::pair<int, cv::Mat>>& images, const FilterImage& filter);
+	void cancel();
+
+	std::vector<Result> takeResults();
+
+signals:
+	void imagesRendered();                                          // emitted in the render thread
+
+protected:
+	void run() override;
+
+private:
+	struct Job
+	{
+		int         bscan;
+		cv::Mat     source;
+		std::size_t generation;
+		std::size_t filterVersion;
+		uint8_t     lut[256];
+	};
+
+	QMutex              mutex;
+	QWaitCondition      jobAvailable;
+	std::deque<Job>     jobs;
+	std::vector<Result> results;
+	std::size_t         generation = 0;
+	bool                stop       = false;
+};
@@ -0,0 +1,184 @@
+/*
+ * Copyright (c) 2018 Kay Gawlik <kaydev@amarunet.de> <kay.gawlik@beuth-hochschule.de> <kay.gawlik@charite.de>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+#include "inputrecorder.h"
+
+#include <QMouseEvent>
+#include <QWheelEvent>
+#include <QKeyEvent>
+#include <QStringList>
+#include <QUrl>
+
+#include <widgets/cvimagewidget.h>
+#include <manager/octmarkermanager.h>
+#include <markermodules/bscanmarkerbase.h>
+
+
+namespace
+{
+	QString encodeField(const QString& str)
+	{
+		if(str.isEmpty())
+			return "-";
+		return QString::fromLatin1(QUrl::toPercentEncoding(str));
+	}
+
+	QString decodeField(const QString& str)
+	{
+		if(str == "-")
+			return QString();
+		return QUrl::fromPercentEncoding(str.toLatin1());
+	}
+}
+
+
+bool InputEventRecord::isRecordedType(int type)
+{
+	switch(type)
+	{
+		case QEvent::MouseMove:
+		case QEvent::MouseButtonPress:
+		case QEvent::MouseButtonRelease:
+		case QEvent::MouseButtonDblClick:
+		case QEvent::Wheel:
+		case QEvent::KeyPress:
+		case QEvent::KeyRelease:
+			return true;
+		default:
+			return false;
+	}
+}
+
+QString InputEventRecord::toLine() const
+{
+	QStringList fields;
+	fields << QString::number(time) << encodeField(target) << QString::number(type)
+	       << QString::number(x, 'g', 10) << QString::number(y, 'g', 10)
+	       << QString::number(button) << QString::number(buttons) << QString::number(modifiers)
+	       << QString::number(key) << QString::number(delta)
+	       << QString::number(bscan) << encodeField(module) << encodeField(text);
+	return fields.join(' ');
+}
+
+bool InputEventRecord::fromLine(const QString& line)
+{
+	const QStringList fields = line.split(' ', QString::SkipEmptyParts);
+	if(fields.size() != 13)
+		return false;
+
+	bool ok = true;
+	bool allOk = true;
+	time      = fields[ 0].toLongLong(&ok); allOk &= ok;
+	target    = decodeField(fields[1]);
+	type      = fields[ 2].toInt   (&ok); allOk &= ok;
+	x         = fields[ 3].toDouble(&ok); allOk &= ok;
+	y         = fields[ 4].toDouble(&ok); allOk &= ok;
+	button    = fields[ 5].toInt   (&ok); allOk &= ok;
+	buttons   = fields[ 6].toInt   (&ok); allOk &= ok;
+	modifiers = fields[ 7].toInt   (&ok); allOk &= ok;
+	key       = fields[ 8].toInt   (&ok); allOk &= ok;
+	delta     = fields[ 9].toInt   (&ok); allOk &= ok;
+	bscan     = fields[10].toInt   (&ok); allOk &= ok;
+	module    = decodeField(fields[11]);
+	text      = decodeField(fields[12]);
+
+	return allOk && isRecordedType(type);
+}
+
+
+bool InputRecorder::start(const QString& filename)
+{
+	file.setFileName(filename);
+	if(!file.open(QIODevice::WriteOnly | QIODevice::Text))
+		return false;
+
+	stream.setDevice(&file);
+	stream << fileHeader() << '\n';
+	stream << "# time target type x y button buttons modifiers key delta bscan module text\n";
+	clock.start();
+	return true;
+}
+
+void InputRecorder::addWidget(CVImageWidget* widget, const QString& name)
+{
+	if(!widget)
+		return;
+
+	targets[widget] = name;
+	widget->installEventFilter(this);
+	connect(widget, &QObject::destroyed, this, [this](QObject* obj) { targets.remove(obj); });
+}
+
+bool InputRecorder::eventFilter(QObject* obj, QEvent* event)
+{
+	if(!file.isOpen() || !InputEventRecord::isRecordedType(event->type()))
+		return false;
+
+	QHash<QObject*, QString>::const_iterator it = targets.constFind(obj);
+	if(it == targets.constEnd())
+		return false;
+
+	const CVImageWidget* widget = static_cast<const CVImageWidget*>(obj);
+	const ScaleFactor& factor = widget->getImageScaleFactor();
+
+	InputEventRecord record;
+	record.time   = clock.elapsed();
+	record.target = it.value();
+	record.type   = static_cast<int>(event->type());
+
+	OctMarkerManager& markerManager = OctMarkerManager::getInstance();
+	record.bscan = markerManager.getActBScanNum();
+	BscanMarkerBase* actMarker = markerManager.getActBscanMarker();
+	if(actMarker)
+		record.module = actMarker->getMarkerId();
+
+	switch(event->type())
+	{
+		case QEvent::Wheel:
+		{
+			const QWheelEvent* wheelEvent = static_cast<const QWheelEvent*>(event);
+			record.x         = wheelEvent->posF().x()/factor.getFactorX();
+			record.y         = wheelEvent->posF().y()/factor.getFactorY();
+			record.buttons   = static_cast<int>(wheelEvent->buttons());
+			record.modifiers = static_cast<int>(wheelEvent->modifiers());
+			record.delta     = wheelEvent->delta();
+			break;
+		}
+		case QEvent::KeyPress:
+		case QEvent::KeyRelease:
+		{
+			const QKeyEvent* keyEvent = static_cast<const QKeyEvent*>(event);
+			record.key       = keyEvent->key();
+			record.modifiers = static_cast<int>(keyEvent->modifiers());
+			record.text      = keyEvent->text();
+			break;
+		}
+		default:
+		{
+			const QMouseEvent* mouseEvent = static_cast<const QMouseEvent*>(event);
+			record.x         = mouseEvent->localPos().x()/factor.getFactorX();
+			record.y         = mouseEvent->localPos().y()/factor.getFactorY();
+			record.button    = static_cast<int>(mouseEvent->button());
+			record.buttons   = static_cast<int>(mouseEvent->buttons());
+			record.modifiers = static_cast<int>(mouseEvent->modifiers());
+			break;
+		}
+	}
+
+	stream << record.toLine() << '\n';
+	return false;
+}
@@ -0,0 +1,74 @@
+/*
+ * Copyright (c) 2018 Kay Gawlik <kaydev@amarunet.de> <kay.gawlik@beuth-hochschule.de> <kay.gawlik@charite.de>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+#pragma once
+
+#include <QObject>
+#include <QString>
+#include <QFile>
+#include <QTextStream>
+#include <QElapsedTimer>
+#include <QHash>
+
+class QEvent;
+class CVImageWidget;
+
+// one mouse, wheel or key event of a recording, positions in image coordinates (independent of the zoom)
+struct InputEventRecord
+{
+	qint64  time      = 0;                                          // ms since the start of the recording
+	QString target;                                                 // name of the widget
+	int     type      = 0;                                          // QEvent::Type
+	double  x         = 0;
+	double  y         = 0;
+	int     button    = 0;
+	int     buttons   = 0;
+	int     modifiers = 0;
+	int     key       = 0;
+	int     delta     = 0;                                          // wheel
+	int     bscan     = 0;                                          // act BScan and module before the event
+	QString module;
+	QString text;
+
+	static bool isRecordedType(int type);
+
+	QString toLine() const;
+	bool fromLine(const QString& line);
+};
+
+
+// writes the input events of the registered widgets with the act BScan and module into a file
+class InputRecorder : public QObject
+{
+	Q_OBJECT
+
+	QFile                     file;
+	QTextStream               stream;
+	QElapsedTimer             clock;
+	QHash<QObject*, QString>  targets;
+
+public:
+	explicit InputRecorder(QObject* parent = nullptr) : QObject(parent) {}
+
+	bool start(const QString& filename);
+	void addWidget(CVImageWidget* widget, const QString& name);
+
+	static const char* fileHeader()                                 { return "# OCT-Marker input recording 1"; }
+
+protected:
+	bool eventFilter(QObject* obj, QEvent* event) override;
+};
@@ -0,0 +1,202 @@
+/*
+ * Copyright (c) 2018 Kay Gawlik <kaydev@amarunet.de> <kay.gawlik@beuth-hochschule.de> <kay.gawlik@charite.de>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+#include "inputreplay.h"
+
+#include <map>
+#include <chrono>
+#include <cstdio>
+#include <iostream>
+
+#include <QCoreApplication>
+#include <QFile>
+#include <QTextStream>
+#include <QElapsedTimer>
+#include <QMouseEvent>
+#include <QWheelEvent>
+#include <QKeyEvent>
+#include <QThread>
+
+#include <widgets/cvimagewidget.h>
+#include <manager/octmarkermanager.h>
+#include <markermodules/bscanmarkerbase.h>
+#include <helper/painttiming.h>
+
+
+namespace
+{
+	const char* eventTypeName(int type)
+	{
+		switch(type)
+		{
+			case QEvent::MouseMove          : return "mouse move";
+			case QEvent::MouseButtonPress   : return "mouse press";
+			case QEvent::MouseButtonRelease : return "mouse release";
+			case QEvent::MouseButtonDblClick: return "mouse double click";
+			case QEvent::Wheel              : return "wheel";
+			case QEvent::KeyPress           : return "key press";
+			case QEvent::KeyRelease         : return "key release";
+			default                         : return "other";
+		}
+	}
+}
+
+
+bool InputReplay::load(const QString& filename)
+{
+	QFile file(filename);
+	if(!file.open(QIODevice::ReadOnly | QIODevice::Text))
+		return false;
+
+	QTextStream stream(&file);
+	if(stream.readLine() != InputRecorder::fileHeader())
+		return false;
+
+	events.clear();
+	while(!stream.atEnd())
+	{
+		const QString line = stream.readLine();
+		if(line.isEmpty() || line.startsWith('#'))
+			continue;
+
+		InputEventRecord record;
+		if(!record.fromLine(line))
+		{
+			std::cerr << "InputReplay: invalid line: " << line.toStdString() << '\n';
+			continue;
+		}
+		events.push_back(record);
+	}
+	return true;
+}
+
+
+void InputReplay::restoreState(const InputEventRecord& record)
+{
+	OctMarkerManager& markerManager = OctMarkerManager::getInstance();
+
+	BscanMarkerBase* actMarker = markerManager.getActBscanMarker();
+	const QString actModule = actMarker ? actMarker->getMarkerId() : QString();
+	if(actModule != record.module)
+		markerManager.setBscanMarkerTextID(record.module);
+
+	if(markerManager.getActBScanNum() != record.bscan)
+		markerManager.chooseBScan(record.bscan);
+}
+
+bool InputReplay::sendEvent(const InputEventRecord& record)
+{
+	CVImageWidget* widget = targets.value(record.target, nullptr);
+	if(!widget)
+		return false;
+
+	const ScaleFactor& factor = widget->getImageScaleFactor();
+	const QPointF localPos(record.x*factor.getFactorX(), record.y*factor.getFactorY());
+	const QPointF globalPos = widget->mapToGlobal(localPos.toPoint());
+	const Qt::KeyboardModifiers modifiers = static_cast<Qt::KeyboardModifiers>(record.modifiers);
+	const Qt::MouseButtons      buttons   = static_cast<Qt::MouseButtons>(record.buttons);
+
+	switch(record.type)
+	{
+		case QEvent::Wheel:
+		{
+			QWheelEvent event(localPos, globalPos, record.delta, buttons, modifiers);
+			QCoreApplication::sendEvent(widget, &event);
+			break;
+		}
+		case QEvent::KeyPress:
+		case QEvent::KeyRelease:
+		{
+			QKeyEvent event(static_cast<QEvent::Type>(record.type), record.key, modifiers, record.text);
+			QCoreApplication::sendEvent(widget, &event);
+			break;
+		}
+		default:
+		{
+			QMouseEvent event(static_cast<QEvent::Type>(record.type), localPos, localPos, globalPos, static_cast<Qt::MouseButton>(record.button), buttons, modifiers);
+			QCoreApplication::sendEvent(widget, &event);
+			break;
+		}
+	}
+	return true;
+}
+
+
+void InputReplay::run()
+{
+	if(replayed)
+		return;
+	replayed = true;
+
+	std::map<std::string, PaintTiming::Statistic> latencies;
+	PaintTiming::Statistic allLatencies;
+	std::size_t skipped = 0;
+
+	QElapsedTimer replayClock;
+	replayClock.start();
+
+	for(const InputEventRecord& record : events)
+	{
+		restoreState(record);
+		QCoreApplication::processEvents();
+
+		if(realTime)
+		{
+			while(replayClock.elapsed() < record.time)
+			{
+				QCoreApplication::processEvents();
+				QThread::msleep(1);
+			}
+		}
+
+		const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+		if(!sendEvent(record))
+		{
+			++skipped;
+			continue;
+		}
+		QCoreApplication::processEvents();                          // paint events and updates caused by the event
+		const double latency = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count();
+
+		latencies[std::string(eventTypeName(record.type)) + " " + record.target.toStdString()].add(latency);
+		allLatencies.add(latency);
+	}
+
+	const double totalSeconds = static_cast<double>(replayClock.elapsed())/1000.;
+
+	std::cout << "replayed events : " << allLatencies.getCount() << " (" << skipped << " skipped, unknown target)\n";
+	std::cout << "total time      : " << totalSeconds << " s\n";
+	if(totalSeconds > 0)
+		std::cout << "throughput      : " << static_cast<double>(allLatencies.getCount())/totalSeconds << " events/s\n";
+
+	std::printf("%-32s %10s %10s %10s %10s %10s\n", "latency", "count", "mean ms", "p50 ms", "p95 ms", "max ms");
+	latencies["all"] = allLatencies;
+	for(const std::pair<const std::string, PaintTiming::Statistic>& entry : latencies)
+	{
+		const PaintTiming::Statistic& s = entry.second;
+		std::printf("%-32s %10llu %10.3f %10.3f %10.3f %10.3f\n"
+		          , entry.first.c_str()
+		          , static_cast<unsigned long long>(s.getCount())
+		          , s.getMean()/1000.
+		          , s.getPercentile(0.50)/1000.
+		          , s.getPercentile(0.95)/1000.
+		          , s.getMax()/1000.);
+	}
+	std::fflush(stdout);
+
+	emit(finished(allLatencies.getCount() > 0 ? 0 : 1));
+}
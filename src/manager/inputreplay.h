@@ -0,0 +1,57 @@
+/*
+ * Copyright (c) 2018 Kay Gawlik <kaydev@amarunet.de> <kay.gawlik@beuth-hochschule.de> <kay.gawlik@charite.de>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+#pragma once
+
+#include <vector>
+
+#include <QObject>
+#include <QHash>
+
+#include "inputrecorder.h"
+
+class CVImageWidget;
+
+// replays a recording of InputRecorder against the loaded OCT file and reports the processing latency
+// latency of one event: delivery to the widget and processing of the resulting paint and posted events
+class InputReplay : public QObject
+{
+	Q_OBJECT
+
+	std::vector<InputEventRecord>   events;
+	QHash<QString, CVImageWidget*>  targets;
+	bool                            realTime = false;
+	bool                            replayed = false;
+
+	void restoreState(const InputEventRecord& record);
+	bool sendEvent(const InputEventRecord& record);
+
+public:
+	explicit InputReplay(QObject* parent = nullptr) : QObject(parent) {}
+
+	bool load(const QString& filename);
+	void addWidget(CVImageWidget* widget, const QString& name)     { targets[name] = widget; }
+	void setRealTime(bool b)                                        { realTime = b; }
+
+	std::size_t numEvents() const                                   { return events.size(); }
+
+public slots:
+	void run();                                                     // prints the report to std::cout and emits finished
+
+signals:
+	void finished(int exitCode);
+};
@@ -34,24 +34,76 @@
 #include<QFileInfo>
 #include<QDir>
 
+#include <octdata/datastruct/patient.h>
+#include <octdata/datastruct/study.h>
 #include <octdata/datastruct/series.h>
 #include <octdata/datastruct/bscan.h>
+#include <octdata/datastruct/sloimage.h>
 #include <octdata/datastruct/oct.h>
 #include <octdata/octfileread.h>
 #include <octdata/filereadoptions.h>
 #include <octdata/filewriteoptions.h>
 
 #include <helper/ptreehelper.h>
+#include <helper/tracelog.h>
+#include <helper/memoryusage.h>
 #include <data_structure/programoptions.h>
 #include <data_structure/slobscandistancemap.h>
 
 #include "octmarkerio.h"
 #include "octmarkermanager.h"
 
+#include <markermodules/bscansegmentation/bscansegmentationptree.h>
+#include <markermodules/bscanlayersegmentation/bscanlayersegptree.h>
+
 namespace bpt = boost::property_tree;
 namespace bfs = boost::filesystem;
 
 
+namespace
+{
+	// node with key and data, the multi_index container of the childs adds about four pointers per node
+	void addPTreeBytes(const bpt::ptree& tree, std::size_t& bytes, std::size_t& nodes)
+	{
+		for(const bpt::ptree::value_type& child : tree)
+		{
+			bytes += sizeof(bpt::ptree::value_type) + 4*sizeof(void*) + child.first.capacity() + child.second.data().capacity();
+			++nodes;
+			addPTreeBytes(child.second, bytes, nodes);
+		}
+	}
+
+	template<typename Function>
+	void forEachChild(bpt::ptree& tree, const char* name, Function f)
+	{
+		for(bpt::ptree::value_type& child : tree)
+			if(child.first == name)
+				f(child.second);
+	}
+
+	// the BScan modules keep unchanged nodes as loaded, the format options may have changed since
+	void reencodeStoredMarkers(bpt::ptree& markerTree)
+	{
+		forEachChild(markerTree, "Patient", [](bpt::ptree& patientNode)
+		{
+			forEachChild(patientNode, "Study", [](bpt::ptree& studyNode)
+			{
+				forEachChild(studyNode, "Series", [](bpt::ptree& seriesNode)
+				{
+					boost::optional<bpt::ptree&> segNode = seriesNode.get_child_optional(BScanSegmentationPtree::markerId);
+					if(segNode)
+						BScanSegmentationPtree::reencodeStored(*segNode);
+
+					boost::optional<bpt::ptree&> layerSegNode = seriesNode.get_child_optional(BScanLayerSegPTree::markerId);
+					if(layerSegNode)
+						BScanLayerSegPTree::reencodeStored(*layerSegNode);
+				});
+			});
+		});
+	}
+}
+
+
 
 OctDataManager::OctDataManager()
 : markerstree(new bpt::ptree)
@@ -64,6 +116,8 @@ OctDataManager::OctDataManager()
 
 OctDataManager::~OctDataManager()
 {
+	deleteMarkerLoadThread();
+	waitForMarkerSave();
 	delete octData;
 	delete markerstree;
 	delete markerIO;
@@ -77,10 +131,54 @@ void OctDataManager::saveMarkersDefault()
 		triggerSaveMarkersDefault();
 }
 
+void OctDataManager::saveMarkersDefaultBackground()
+{
+	if(!ProgramOptions::autoSaveOctMarkers() || actFilename.isEmpty())
+		return;
+
+	// modules only serialize the BScans changed since the last save, the writer gets a snapshot of the tree
+	saveMarkerState(actSeries);
+	waitForMarkerSave();
+
+	markerSaveThread = new OctMarkerSaveThread(*markerstree
+	                                         , markerIO->getDefaultMarkerFilename(actFilename.toStdString())
+	                                         , markerIO->getDefaultLoadedFormat());
+	connect(markerSaveThread, &OctMarkerSaveThread::finished, this, &OctDataManager::markerSaveThreadFinish);
+	markerSaveThread->start();
+
+	OctMarkerManager::getInstance().resetChangedSinceLastSaveState();
+}
+
+void OctDataManager::waitForMarkerSave()
+{
+	if(markerSaveThread)
+	{
+		markerSaveThread->wait();
+		markerSaveThreadFinish();
+	}
+}
+
+void OctDataManager::markerSaveThreadFinish()
+{
+	if(!markerSaveThread || !markerSaveThread->isFinished()) // late finished signal of a thread handled by waitForMarkerSave
+		return;
+
+	const QString filename = QString::fromStdString(markerSaveThread->getFilename());
+	if(markerSaveThread->success())
+		emit(markerSaveFinished(true, tr("markers saved to %1").arg(filename)));
+	else
+		emit(markerSaveFinished(false, tr("autosave of %1 failed: %2").arg(filename).arg(markerSaveThread->getError())));
+
+	markerSaveThread->deleteLater();
+	markerSaveThread = nullptr;
+}
+
+
 void OctDataManager::triggerSaveMarkersDefault()
 {
 	if(!actFilename.isEmpty())
 	{
+		waitForMarkerSave();
 		saveMarkerState(actSeries);
 		markerIO->saveDefaultMarker(actFilename.toStdString());
 		OctMarkerManager::getInstance().resetChangedSinceLastSaveState();
@@ -90,6 +188,9 @@ void OctDataManager::triggerSaveMarkersDefault()
 
 void OctDataManagerThread::run()
 {
+	TraceLog::getInstance().setThreadName("oct load");
+	ScopedTrace trace("OctDataManagerThread::run");
+
 	if(!oct)
 	{
 		error = "oct variable is not set";
@@ -109,6 +210,7 @@ void OctDataManagerThread::run()
 		octOptions.rotateSlo           = ProgramOptions::loadRotateSlo();
 		octOptions.libPath             = octmarkerPath.dir().absolutePath().toStdString(); // QApplication::applicationFilePath().toStdString();
 
+		ScopedTrace readTrace("read oct file");
 		*oct = OctData::OctFileRead::openFile(filename.toStdString(), octOptions, this);
 	}
 	catch(boost::exception& e)
@@ -137,6 +239,90 @@ void OctDataManagerThread::run()
 	}
 }
 
+OctMarkerLoadThread::OctMarkerLoadThread(const QString& filename)
+: markerstree(new bpt::ptree)
+, markerIO(new OctMarkerIO(markerstree))
+, filename(filename)
+{
+}
+
+OctMarkerLoadThread::~OctMarkerLoadThread()
+{
+	delete markerIO;
+	delete markerstree;
+}
+
+void OctMarkerLoadThread::run()
+{
+	TraceLog::getInstance().setThreadName("marker load");
+	try
+	{
+		ScopedTrace trace("loadDefaultMarker");
+		markerIO->loadDefaultMarker(filename.toStdString());
+	}
+	catch(boost::exception& e)
+	{
+		error = QString::fromStdString(boost::diagnostic_information(e));
+	}
+	catch(std::exception& e)
+	{
+		error = QString::fromStdString(e.what());
+	}
+	catch(const char* str)
+	{
+		error = str;
+	}
+	catch(...)
+	{
+		error = QString("Unknow error in file %1 line %2").arg(__FILE__).arg(__LINE__);
+	}
+}
+
+
+OctMarkerSaveThread::OctMarkerSaveThread(const bpt::ptree& markers, const std::string& filename, OctMarkerFileformat format)
+: markerstree(new bpt::ptree(markers))
+, markerIO(new OctMarkerIO(markerstree))
+, filename(filename)
+, format(format)
+{
+}
+
+OctMarkerSaveThread::~OctMarkerSaveThread()
+{
+	delete markerIO;
+	delete markerstree;
+}
+
+void OctMarkerSaveThread::run()
+{
+	TraceLog::getInstance().setThreadName("marker save");
+	try
+	{
+		ScopedTrace trace("saveMarkers");
+		reencodeStoredMarkers(*markerstree);
+		saveSuccess = markerIO->saveMarkers(filename, format);
+		if(!saveSuccess)
+			error = tr("could not write file");
+	}
+	catch(boost::exception& e)
+	{
+		error = QString::fromStdString(boost::diagnostic_information(e));
+	}
+	catch(std::exception& e)
+	{
+		error = QString::fromStdString(e.what());
+	}
+	catch(const char* str)
+	{
+		error = str;
+	}
+	catch(...)
+	{
+		error = QString("Unknow error in file %1 line %2").arg(__FILE__).arg(__LINE__);
+	}
+}
+
+
 bool OctDataManager::checkAndAskSaveBeforContinue()
 {
 	if(OctMarkerManager::getInstance().hasChangedSinceLastSave()) // TODO: move to new class for handel gui
@@ -171,10 +357,19 @@ void OctDataManager::openFile(const QString& filename)
 			return;
 	}
 
+	ScopedTrace trace("OctDataManager::openFile", filename);
+	TraceLog::getInstance().markFileOpen();
+
 	loadFileSignal(true);
 	try
 	{
-		saveMarkersDefault();
+		saveMarkersDefaultBackground();
+		if(filename == actFilename)
+			waitForMarkerSave(); // reload the saved state
+
+		// parse the marker file while the oct data is decoded
+		markerLoadThread = new OctMarkerLoadThread(filename);
+		markerLoadThread->start();
 
 		octData4Loading = new OctData::OCT;
 
@@ -185,14 +380,86 @@ void OctDataManager::openFile(const QString& filename)
 	}
 	catch(...)
 	{
+		deleteMarkerLoadThread();
 		loadFileSignal(false);
 		throw;
 	}
 }
 
 
+void OctDataManager::takeLoadedMarkers()
+{
+	ScopedTrace trace("takeLoadedMarkers");
+
+	markerstree->clear();
+	if(!markerLoadThread)
+		return;
+
+	markerLoadThread->wait();
+	markerIO->takeDefaultMarker(markerLoadThread->getMarkerIO());
+
+	const QString error = markerLoadThread->getError();
+	deleteMarkerLoadThread();
+
+	if(!error.isEmpty())
+	{
+		QMessageBox msgBox;
+		msgBox.setText("OctDataManager::openFile: markerload failed: " + error);
+		msgBox.setIcon(QMessageBox::Critical);
+		msgBox.exec();
+	}
+}
+
+void OctDataManager::deleteMarkerLoadThread()
+{
+	if(markerLoadThread)
+		markerLoadThread->wait();
+	delete markerLoadThread;
+	markerLoadThread = nullptr;
+}
+
+void OctDataManager::setOctData(OctData::OCT* oct, const QString& filename)
+{
+	actFilename = filename;
+
+	delete octData;
+	octData = oct;
+
+	actPatient = nullptr;
+	actStudy   = nullptr;
+	actSeries  = nullptr;
+
+	if(octData && octData->size() > 0)
+	{
+		actPatient = octData->begin()->second;
+		if(actPatient->size() > 0)
+		{
+			actStudy = actPatient->begin()->second;
+
+			if(actStudy->size() > 0)
+			{
+				actSeries = actStudy->begin()->second;
+			}
+		}
+	}
+
+	{
+		ScopedTrace trace("octFileChanged");
+		emit(octFileChanged());
+		emit(octFileChanged(actFilename));
+		emit(octFileChanged(octData   ));
+		emit(patientChanged(actPatient));
+		emit(studyChanged  (actStudy  ));
+	}
+	ScopedTrace trace("seriesChanged");
+	emit(seriesChanged (actSeries ));
+}
+
+
 void OctDataManager::loadOctDataThreadFinish()
 {
+	ScopedTrace trace("loadOctDataThreadFinish");
+
 	loadFileSignal(false);
 
 	if(loadThread->success())
@@ -206,60 +473,12 @@ void OctDataManager::loadOctDataThreadFinish()
 		}
 		else
 		{
-			QString error;
-			try
-			{
-				markerstree->clear();
-				markerIO->loadDefaultMarker(loadThread->getFilename().toStdString());
-			}
-			catch(boost::exception& e)
-			{
-				error = QString::fromStdString(boost::diagnostic_information(e));
-			}
-			catch(std::exception& e)
-			{
-				error = QString::fromStdString(e.what());
-			}
-			catch(const char* str)
-			{
-				error = str;
-			}
-			catch(...)
-			{
-				error = QString("Unknow error in file %1 line %2").arg(__FILE__).arg(__LINE__);
-			}
-			if(!error.isEmpty())
-			{
-				QMessageBox msgBox;
-				msgBox.setText("OctDataManager::openFile: markerload failed: " + error);
-				msgBox.setIcon(QMessageBox::Critical);
-				msgBox.exec();
-			}
-
+			takeLoadedMarkers();
 
-			actFilename = loadThread->getFilename();
-
-			delete octData;
-			octData = octData4Loading;
+			setOctData(octData4Loading, loadThread->getFilename());
 			octData4Loading = nullptr;
+			TraceLog::getInstance().markFileShown();
 
-			actPatient = octData->begin()->second;
-			if(actPatient->size() > 0)
-			{
-				actStudy = actPatient->begin()->second;
-
-				if(actStudy->size() > 0)
-				{
-					actSeries = actStudy->begin()->second;
-				}
-			}
-
-			emit(octFileChanged());
-			emit(octFileChanged(actFilename));
-			emit(octFileChanged(octData   ));
-			emit(patientChanged(actPatient));
-			emit(studyChanged  (actStudy  ));
-			emit(seriesChanged (actSeries ));
 			OctMarkerManager::getInstance().resetChangedSinceLastSaveState();
 		}
 	}
@@ -275,6 +494,8 @@ void OctDataManager::loadOctDataThreadFinish()
 		}
 	}
 
+	deleteMarkerLoadThread();
+
 	delete loadThread;
 	delete octData4Loading;
 	loadThread      = nullptr;
@@ -282,13 +503,12 @@ void OctDataManager::loadOctDataThreadFinish()
 }
 
 
-
 void OctDataManager::chooseSeries(const OctData::Series* seriesReq)
 {
 	saveMarkerState(actSeries);
 	
 	
-	if(seriesReq == actSeries)
+	if(seriesReq == actSeries || !octData)
 		return;
 	
 	const OctData::Patient* patient;
@@ -341,6 +561,7 @@ boost::property_tree::ptree* OctDataManager::getMarkerTreeSeries(const OctData::
 
 bool OctDataManager::loadMarkers(QString filename, OctMarkerFileformat format)
 {
+	waitForMarkerSave();
 	markerstree->clear();
 	markerIO->loadMarkers(filename.toStdString(), format);
 	emit(loadMarkerStateAll());
@@ -350,7 +571,9 @@ bool OctDataManager::loadMarkers(QString filename, OctMarkerFileformat format)
 
 void OctDataManager::saveMarkers(QString filename, OctMarkerFileformat format)
 {
+	waitForMarkerSave();
 	saveMarkerState(actSeries);
+	reencodeStoredMarkers(*markerstree);
 	markerIO->saveMarkers(filename.toStdString(), format);
 	OctMarkerManager::getInstance().resetChangedSinceLastSaveState();
 }
@@ -370,6 +593,7 @@ const SloBScanDistanceMap* OctDataManager::getSeriesSLODistanceMap() const
 {
 	if(!seriesSLODistanceMap)
 	{
+		ScopedTrace trace("SloBScanDistanceMap::createData");
 		seriesSLODistanceMap = new SloBScanDistanceMap();
 		seriesSLODistanceMap->createData(actSeries);
 	}
@@ -377,6 +601,62 @@ const SloBScanDistanceMap* OctDataManager::getSeriesSLODistanceMap() const
 	return seriesSLODistanceMap;
 }
 
+void OctDataManager::addMemoryUsage(MemoryUsage& usage) const
+{
+	const std::string category = "OCT data";
+
+	std::size_t imageBytes = 0;
+	std::size_t rawBytes   = 0;
+	std::size_t sloBytes   = 0;
+	std::size_t numBScans  = 0;
+	std::size_t numRaw     = 0;
+	std::size_t numSlo     = 0;
+	if(octData)
+	{
+		for(const OctData::OCT::SubstructurePair& patientPair : *octData)
+			for(const OctData::Patient::SubstructurePair& studyPair : *patientPair.second)
+				for(const OctData::Study::SubstructurePair& seriesPair : *studyPair.second)
+				{
+					const OctData::Series* series = seriesPair.second;
+					for(const OctData::BScan* bscan : series->getBScans())
+					{
+						if(!bscan)
+							continue;
+						imageBytes += MemoryUsage::bytes(bscan->getImage());
+						++numBScans;
+
+						const std::size_t raw = MemoryUsage::bytes(bscan->getRawImage());
+						if(raw > 0)
+						{
+							rawBytes += raw;
+							++numRaw;
+						}
+					}
+
+					const std::size_t slo = MemoryUsage::bytes(series->getSloImage().getImage());
+					if(slo > 0)
+					{
+						sloBytes += slo;
+						++numSlo;
+					}
+				}
+	}
+	usage.add(category, "BScan images"    , imageBytes, numBScans);
+	usage.add(category, "BScan raw images", rawBytes  , numRaw   );
+	usage.add(category, "SLO images"      , sloBytes  , numSlo   );
+
+	std::size_t treeBytes = 0;
+	std::size_t treeNodes = 0;
+	addPTreeBytes(*markerstree, treeBytes, treeNodes);
+	usage.add(category, "marker tree", treeBytes, treeNodes);
+
+	if(seriesSLODistanceMap && seriesSLODistanceMap->getDataMatrix())
+	{
+		const SloBScanDistanceMap::PreCalcDataMatrix& matrix = *seriesSLODistanceMap->getDataMatrix();
+		usage.add(category, "SLO distance map", matrix.getSizeX()*matrix.getSizeY()*sizeof(SloBScanDistanceMap::PixelInfo));
+	}
+}
+
 void OctDataManager::clearSeriesCache()
 {
 	delete seriesSLODistanceMap;
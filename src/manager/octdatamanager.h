@@ -36,6 +36,7 @@
 class QString;
 class OctMarkerIO;
 class SloBScanDistanceMap;
+class MemoryUsage;
 
 namespace OctData
 {
@@ -46,6 +47,8 @@ namespace OctData
 }
 
 class OctDataManagerThread;
+class OctMarkerLoadThread;
+class OctMarkerSaveThread;
 
 class OctDataManager : public QObject
 {
@@ -64,13 +67,18 @@ public:
 	const OctData::Series * getSeries () const                      { return actSeries  ; }
 	boost::property_tree::ptree* getMarkerTree(const OctData::Series* series)
 	                                                                { return getMarkerTreeSeries(series); }
+
+	void addMemoryUsage(MemoryUsage& usage) const;                  // OCT data, marker tree and SLO distance map
 	
 	void saveMarkersDefault();
+	void saveMarkersDefaultBackground();
+	void waitForMarkerSave();
 	bool checkAndAskSaveBeforContinue();
 
 private slots:
 	void loadOctDataThreadProgress(double frac)                     { emit(loadFileProgress(frac)); }
 	void loadOctDataThreadFinish();
+	void markerSaveThreadFinish();
 	void clearSeriesCache();
 
 public slots:
@@ -107,6 +115,8 @@ signals:
 	void loadFileSignal(bool loading);
 	void loadFileProgress(double frac);
 
+	void markerSaveFinished(bool success, const QString& message);
+
 
 private:
 	
@@ -123,9 +133,15 @@ private:
 
 	mutable SloBScanDistanceMap* seriesSLODistanceMap = nullptr;
 	
-	OctDataManagerThread* loadThread = nullptr;
+	OctDataManagerThread* loadThread       = nullptr;
+	OctMarkerLoadThread*  markerLoadThread = nullptr;
+	OctMarkerSaveThread*  markerSaveThread = nullptr;
 	
 	OctDataManager();
+
+	void takeLoadedMarkers();
+	void deleteMarkerLoadThread();
+	void setOctData(OctData::OCT* oct, const QString& filename);
 	
 	boost::property_tree::ptree* getMarkerTreeSeries(const OctData::Series* series);
 	boost::property_tree::ptree* getMarkerTreeSeries(const OctData::Patient* pat, const OctData::Study* study, const OctData::Series*  series);
@@ -169,3 +185,52 @@ signals:
 	void stepCalulated(double);
 };
 
+
+
+class OctMarkerLoadThread : public QThread
+{
+	Q_OBJECT
+
+	boost::property_tree::ptree* const markerstree;
+	OctMarkerIO*                 const markerIO;
+
+	const QString filename;
+	QString  error;
+
+public:
+	explicit OctMarkerLoadThread(const QString& filename);
+	~OctMarkerLoadThread();
+
+	OctMarkerIO& getMarkerIO()                                      { return *markerIO; }
+	const QString& getError()                                const  { return error; }
+	const QString& getFilename()                             const  { return filename; }
+
+protected:
+	void run();
+};
+
+
+class OctMarkerSaveThread : public QThread
+{
+	Q_OBJECT
+
+	boost::property_tree::ptree* const markerstree;
+	OctMarkerIO*                 const markerIO;
+
+	const std::string   filename;
+	OctMarkerFileformat format;
+
+	bool    saveSuccess = false;
+	QString error;
+
+public:
+	OctMarkerSaveThread(const boost::property_tree::ptree& markers, const std::string& filename, OctMarkerFileformat format);
+	~OctMarkerSaveThread();
+
+	bool success()                                           const  { return saveSuccess; }
+	const QString& getError()                                const  { return error; }
+	const std::string& getFilename()                         const  { return filename; }
+
+protected:
+	void run();
+};
@@ -0,0 +1,385 @@
+/*
+ * Copyright (c) 2018 Kay Gawlik <kaydev@amarunet.de> <kay.gawlik@beuth-hochschule.de> <kay.gawlik@charite.de>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+#include "octmarkerbinaryio.h"
+
+#include <ostream>
+#include <fstream>
+#include <cstring>
+#include <stdexcept>
+
+#include <boost/property_tree/ptree.hpp>
+#include <boost/iostreams/device/mapped_file.hpp>
+#include <boost/filesystem.hpp>
+
+namespace bpt = boost::property_tree;
+namespace bfs = boost::filesystem;
+namespace io  = boost::iostreams;
+
+const std::size_t OctMarkerBinaryIO::ChunkInfo::noParent;
+
+
+namespace
+{
+	const char     headerMagic[8] = { 'O', 'C', 'T', 'M', 'R', 'K', 'B', '\n' };
+	const uint32_t formatVersion  = 1;
+	const uint32_t footerMagic    = 0x434f544d; // "MTOC"
+	const std::size_t headerSize  = sizeof(headerMagic) + sizeof(uint32_t);
+	const std::size_t footerSize  = sizeof(uint64_t) + 2*sizeof(uint32_t);
+	const std::size_t maxDepth    = 256;                          // nesting of the nodes, marker trees have about 10 levels
+
+	enum class ChildKind : uint8_t { Inline = 0, Chunk = 1 };
+
+
+	void putVarint(std::string& buffer, uint64_t value)
+	{
+		while(value >= 0x80)
+		{
+			buffer.push_back(static_cast<char>((value & 0x7f) | 0x80));
+			value >>= 7;
+		}
+		buffer.push_back(static_cast<char>(value));
+	}
+
+	void putString(std::string& buffer, const std::string& str)
+	{
+		putVarint(buffer, str.size());
+		buffer.append(str);
+	}
+
+	template<typename T>
+	void putFixed(std::string& buffer, T value)
+	{
+		for(std::size_t i = 0; i < sizeof(T); ++i)
+		{
+			buffer.push_back(static_cast<char>(value & 0xff));
+			value = static_cast<T>(value >> 8);
+		}
+	}
+
+	int getNodeId(const bpt::ptree& node)
+	{
+		boost::optional<const bpt::ptree&> idNode = node.get_child_optional("ID");
+		if(idNode)
+			return idNode->get_value<int>(-1);
+		return -1;
+	}
+
+	// modules of a series and BScans get their own chunk
+	bool isChunkNode(const std::string& key, const std::string& parentKey, const bpt::ptree& node)
+	{
+		if(node.empty())
+			return false;
+		return key == "BScan" || parentKey == "Series";
+	}
+
+
+	class Writer
+	{
+		std::ostream& stream;
+		uint64_t      position = 0;
+
+		std::vector<OctMarkerBinaryIO::ChunkInfo> toc;
+
+		void writeRaw(const std::string& data)
+		{
+			stream.write(data.data(), static_cast<std::streamsize>(data.size()));
+			position += data.size();
+		}
+
+		void encodeNode(std::string& buffer, std::vector<std::size_t>& childChunks, const std::string& key, const bpt::ptree& node)
+		{
+			putString(buffer, key);
+			putString(buffer, node.data());
+			putVarint(buffer, node.size());
+
+			for(const bpt::ptree::value_type& child : node)
+			{
+				if(isChunkNode(child.first, key, child.second))
+				{
+					buffer.push_back(static_cast<char>(ChildKind::Chunk));
+					putVarint(buffer, writeChunk(child.first, child.second));
+					childChunks.push_back(toc.size() - 1);
+				}
+				else
+				{
+					buffer.push_back(static_cast<char>(ChildKind::Inline));
+					encodeNode(buffer, childChunks, child.first, child.second);
+				}
+			}
+		}
+
+	public:
+		explicit Writer(std::ostream& stream) : stream(stream)      {}
+
+		std::size_t writeChunk(const std::string& key, const bpt::ptree& node)
+		{
+			std::string buffer;
+			std::vector<std::size_t> childChunks;
+			encodeNode(buffer, childChunks, key, node);
+
+			OctMarkerBinaryIO::ChunkInfo info;
+			info.key    = key;
+			info.id     = getNodeId(node);
+			info.offset = position;
+			info.size   = buffer.size();
+			writeRaw(buffer);
+
+			const std::size_t index = toc.size();
+			for(std::size_t child : childChunks)
+				toc[child].parent = index;
+
+			toc.push_back(info);
+			return index;
+		}
+
+		void writeHeader()
+		{
+			std::string buffer(headerMagic, sizeof(headerMagic));
+			putFixed<uint32_t>(buffer, formatVersion);
+			writeRaw(buffer);
+		}
+
+		void writeTocAndFooter(std::size_t rootChunk)
+		{
+			const uint64_t tocOffset = position;
+
+			std::string buffer;
+			putVarint(buffer, toc.size());
+			for(const OctMarkerBinaryIO::ChunkInfo& info : toc)
+			{
+				putVarint(buffer, info.parent == OctMarkerBinaryIO::ChunkInfo::noParent ? 0 : info.parent + 1);
+				putString(buffer, info.key);
+				putVarint(buffer, static_cast<uint64_t>(static_cast<int64_t>(info.id) + 1));
+				putVarint(buffer, info.offset);
+				putVarint(buffer, info.size);
+			}
+
+			putFixed<uint64_t>(buffer, tocOffset);
+			putFixed<uint32_t>(buffer, static_cast<uint32_t>(rootChunk));
+			putFixed<uint32_t>(buffer, footerMagic);
+			writeRaw(buffer);
+		}
+	};
+
+
+	class Reader
+	{
+		const char* const begin;
+		const char* const end;
+
+		[[noreturn]] static void corrupt()                          { throw std::runtime_error("corrupt binary marker file"); }
+
+	public:
+		class Cursor
+		{
+			const char* pos;
+			const char* end;
+		public:
+			Cursor(const char* pos, const char* end) : pos(pos), end(end) {}
+
+			uint64_t getVarint()
+			{
+				uint64_t value = 0;
+				for(int shift = 0; shift < 64; shift += 7)
+				{
+					if(pos >= end)
+						corrupt();
+					const uint8_t byte = static_cast<uint8_t>(*pos++);
+					value |= static_cast<uint64_t>(byte & 0x7f) << shift;
+					if(!(byte & 0x80))
+						return value;
+				}
+				corrupt();
+			}
+
+			uint8_t getByte()
+			{
+				if(pos >= end)
+					corrupt();
+				return static_cast<uint8_t>(*pos++);
+			}
+
+			template<typename T>
+			T getFixed()
+			{
+				if(static_cast<std::size_t>(end - pos) < sizeof(T))
+					corrupt();
+				T value = 0;
+				for(std::size_t i = 0; i < sizeof(T); ++i)
+					value = static_cast<T>(value | static_cast<T>(static_cast<T>(static_cast<uint8_t>(pos[i])) << (8*i)));
+				pos += sizeof(T);
+				return value;
+			}
+
+			void getString(std::string& str)
+			{
+				const uint64_t length = getVarint();
+				if(length > static_cast<uint64_t>(end - pos))
+					corrupt();
+				str.assign(pos, static_cast<std::size_t>(length));
+				pos += length;
+			}
+		};
+
+		Reader(const char* data, std::size_t size) : begin(data), end(data + size)
+		{
+			if(size < headerSize + footerSize || std::memcmp(data, headerMagic, sizeof(headerMagic)) != 0)
+				corrupt();
+
+			Cursor header(data + sizeof(headerMagic), end);
+			if(header.getFixed<uint32_t>() != formatVersion)
+				throw std::runtime_error("unsupported binary marker file version");
+
+			Cursor footer(end - footerSize, end);
+			tocOffset = footer.getFixed<uint64_t>();
+			rootChunk = footer.getFixed<uint32_t>();
+			if(footer.getFixed<uint32_t>() != footerMagic || tocOffset > size - footerSize)
+				corrupt();
+
+			Cursor tocCursor(begin + tocOffset, end - footerSize);
+			const uint64_t numChunks = tocCursor.getVarint();
+			if(numChunks > size)
+				corrupt();
+			toc.resize(static_cast<std::size_t>(numChunks));
+			for(OctMarkerBinaryIO::ChunkInfo& info : toc)
+			{
+				const uint64_t parent = tocCursor.getVarint();
+				info.parent = parent == 0 ? OctMarkerBinaryIO::ChunkInfo::noParent : static_cast<std::size_t>(parent - 1);
+				tocCursor.getString(info.key);
+				info.id     = static_cast<int>(static_cast<int64_t>(tocCursor.getVarint()) - 1);
+				info.offset = tocCursor.getVarint();
+				info.size   = tocCursor.getVarint();
+
+				if(info.offset < headerSize || info.offset > tocOffset || info.size > tocOffset - info.offset)
+					corrupt();
+			}
+			if(rootChunk >= toc.size())
+				corrupt();
+			chunkDecoded.assign(toc.size(), false);
+		}
+
+		uint64_t tocOffset = 0;
+		uint32_t rootChunk = 0;
+		std::vector<OctMarkerBinaryIO::ChunkInfo> toc;
+		std::vector<bool> chunkDecoded;
+
+		void decodeChunk(std::size_t index, bpt::ptree& node, std::string& key, std::size_t depth)
+		{
+			if(index >= toc.size() || chunkDecoded[index])          // every chunk has one parent, shared chunks would expand exponentially
+				corrupt();
+			chunkDecoded[index] = true;
+
+			const OctMarkerBinaryIO::ChunkInfo& info = toc[index];
+			const char* chunkBegin = begin + info.offset;
+			Cursor cursor(chunkBegin, chunkBegin + info.size);
+			decodeNode(cursor, node, key, depth);
+		}
+
+		// modules of a series are chunks in the root chunk (see isChunkNode), the toc is in order of the tree
+		bool decodeSeriesModule(const std::string& moduleId, bpt::ptree& node)
+		{
+			for(std::size_t index = 0; index < toc.size(); ++index)
+			{
+				if(toc[index].parent == rootChunk && toc[index].key == moduleId)
+				{
+					std::string key;
+					decodeChunk(index, node, key, 0);
+					return true;
+				}
+			}
+			return false;
+		}
+
+		void decodeNode(Cursor& cursor, bpt::ptree& node, std::string& key, std::size_t depth)
+		{
+			if(depth > maxDepth)                                    // crafted or corrupt files must not overflow the stack
+				corrupt();
+
+			cursor.getString(key);
+			cursor.getString(node.data());
+
+			const uint64_t numChilds = cursor.getVarint();
+			std::string childKey;
+			for(uint64_t i = 0; i < numChilds; ++i)
+			{
+				bpt::ptree child;
+				switch(static_cast<ChildKind>(cursor.getByte()))
+				{
+					case ChildKind::Inline:
+						decodeNode(cursor, child, childKey, depth + 1);
+						break;
+					case ChildKind::Chunk:
+						decodeChunk(static_cast<std::size_t>(cursor.getVarint()), child, childKey, depth + 1);
+						break;
+					default:
+						corrupt();
+				}
+				node.push_back(bpt::ptree::value_type(childKey, bpt::ptree()))->second.swap(child);
+			}
+		}
+	};
+}
+
+
+void OctMarkerBinaryIO::write(std::ostream& stream, const bpt::ptree& tree)
+{
+	Writer writer(stream);
+	writer.writeHeader();
+	const std::size_t rootChunk = writer.writeChunk(std::string(), tree);
+	writer.writeTocAndFooter(rootChunk);
+}
+
+void OctMarkerBinaryIO::read(const bfs::path& file, bpt::ptree& tree)
+{
+	io::mapped_file_source mappedFile(file);
+	read(mappedFile.data(), mappedFile.size(), tree);
+}
+
+void OctMarkerBinaryIO::read(const char* data, std::size_t size, bpt::ptree& tree)
+{
+	Reader reader(data, size);
+
+	std::string rootKey;
+	tree.clear();
+	reader.decodeChunk(reader.rootChunk, tree, rootKey, 0);
+}
+
+bool OctMarkerBinaryIO::readSeriesModule(const bfs::path& file, const std::string& moduleId, bpt::ptree& moduleNode)
+{
+	io::mapped_file_source mappedFile(file);
+	Reader reader(mappedFile.data(), mappedFile.size());
+
+	moduleNode.clear();
+	return reader.decodeSeriesModule(moduleId, moduleNode);
+}
+
+std::vector<OctMarkerBinaryIO::ChunkInfo> OctMarkerBinaryIO::readTableOfContents(const bfs::path& file)
+{
+	io::mapped_file_source mappedFile(file);
+	Reader reader(mappedFile.data(), mappedFile.size());
+	return reader.toc;
+}
+
+bool OctMarkerBinaryIO::isBinaryMarkerFile(const bfs::path& file)
+{
+	std::ifstream stream(file.string(), std::ios::binary);
+	char magic[sizeof(headerMagic)];
+	if(!stream.read(magic, sizeof(magic)))
+		return false;
+	return std::memcmp(magic, headerMagic, sizeof(headerMagic)) == 0;
+}
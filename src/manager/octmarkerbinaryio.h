@@ -0,0 +1,66 @@
+/*
+ * Copyright (c) 2018 Kay Gawlik <kaydev@amarunet.de> <kay.gawlik@beuth-hochschule.de> <kay.gawlik@charite.de>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+#ifndef OCTMARKERBINARYIO_H
+#define OCTMARKERBINARYIO_H
+
+#include <string>
+#include <vector>
+#include <iosfwd>
+#include <cstdint>
+
+#include <boost/property_tree/ptree_fwd.hpp>
+
+namespace boost{ namespace filesystem { class path; }}
+
+
+/*
+ * Binary marker container (.boctmarker)
+ *
+ *   header  "OCTMRKB\n", uint32 format version
+ *   chunks  one per marker module of a series, one per BScan node, one for the rest of the tree
+ *   toc     varint count, per chunk: parent, key, id, offset, size
+ *   footer  uint64 toc offset, uint32 root chunk, uint32 "MTOC"
+ *
+ * A node is stored as key, value, child count and its children; a child is either inline
+ * or a reference to another chunk. Integers are little endian, varints LEB128.
+ * Values are kept byte for byte, so conversion from and to the text formats is lossless.
+ */
+class OctMarkerBinaryIO
+{
+public:
+	struct ChunkInfo
+	{
+		static const std::size_t noParent = static_cast<std::size_t>(-1);
+
+		std::size_t parent = noParent;
+		std::string key;
+		int         id     = -1;
+		uint64_t    offset = 0;
+		uint64_t    size   = 0;
+	};
+
+	static void write(std::ostream& stream, const boost::property_tree::ptree& tree);
+	static void read (const boost::filesystem::path& file, boost::property_tree::ptree& tree);
+	static void read (const char* data, std::size_t size, boost::property_tree::ptree& tree);
+	static bool readSeriesModule(const boost::filesystem::path& file, const std::string& moduleId, boost::property_tree::ptree& moduleNode); // first series, only the chunks of the module are decoded
+
+	static std::vector<ChunkInfo> readTableOfContents(const boost::filesystem::path& file);
+	static bool isBinaryMarkerFile(const boost::filesystem::path& file);
+};
+
+#endif // OCTMARKERBINARYIO_H
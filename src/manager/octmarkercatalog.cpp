@@ -0,0 +1,417 @@
+/*
+ * Copyright (c) 2018 Kay Gawlik <kaydev@amarunet.de> <kay.gawlik@beuth-hochschule.de> <kay.gawlik@charite.de>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+#include "octmarkercatalog.h"
+#include "octmarkerio.h"
+#include "octmarkerbinaryio.h"
+
+#include <set>
+
+#include <helper/parallelfor.h>
+
+#include <boost/property_tree/ptree.hpp>
+#include <boost/iostreams/device/file_descriptor.hpp>
+#include <boost/iostreams/stream.hpp>
+#include <boost/filesystem.hpp>
+
+namespace bpt = boost::property_tree;
+namespace bfs = boost::filesystem;
+namespace io  = boost::iostreams;
+
+
+namespace
+{
+	const char* const catalogNodeName = "OctMarkerCatalog";
+	const int         catalogVersion  = 1;
+
+	// only short scan wide values are kept in the catalog
+	const std::size_t maxValueLength     = 128;
+	const std::size_t maxValuesPerModule = 64;
+
+	std::string directoryPrefix(const bfs::path& directory)
+	{
+		std::string prefix = bfs::absolute(directory).generic_string();
+		while(!prefix.empty() && prefix.back() == '/')
+			prefix.pop_back();
+		return prefix + '/';
+	}
+
+	std::string makeRelative(const std::string& file, const std::string& prefix)
+	{
+		if(file.compare(0, prefix.size(), prefix) == 0)
+			return file.substr(prefix.size());
+		return file;
+	}
+
+	std::string makeAbsolute(const std::string& file, const std::string& prefix)
+	{
+		if(bfs::path(file).is_absolute())
+			return file;
+		return prefix + file;
+	}
+
+
+	bool hasData(const bpt::ptree& node)
+	{
+		for(const bpt::ptree::value_type& child : node)
+		{
+			if(child.second.empty())
+			{
+				if(child.first != "ID" && !child.second.data().empty())
+					return true;
+			}
+			else if(hasData(child.second))
+				return true;
+		}
+		return false;
+	}
+
+	void summarizeModuleNode(const bpt::ptree& node, const std::string& path, OctMarkerCatalog::ModuleSummary& summary, bool& moduleHasData)
+	{
+		for(const bpt::ptree::value_type& child : node)
+		{
+			if(child.first == "BScan")
+			{
+				if(hasData(child.second))
+				{
+					++summary.markedBScans;
+					moduleHasData = true;
+				}
+			}
+			else if(child.second.empty())
+			{
+				const std::string& value = child.second.data();
+				if(child.first == "ID" || value.empty())
+					continue;
+
+				moduleHasData = true;
+				if(value.size() <= maxValueLength && summary.values.size() < maxValuesPerModule)
+					summary.values.emplace_back(path + child.first, value);
+			}
+			else
+				summarizeModuleNode(child.second, path + child.first + '/', summary, moduleHasData);
+		}
+	}
+
+	void summarizeSeries(const bpt::ptree& seriesNode, OctMarkerCatalog::SeriesSummary& summary)
+	{
+		for(const bpt::ptree::value_type& moduleNode : seriesNode)
+		{
+			if(moduleNode.first == "ID" || moduleNode.first == "SeriesUID")
+				continue;
+
+			OctMarkerCatalog::ModuleSummary moduleSummary;
+			moduleSummary.moduleId = moduleNode.first;
+
+			bool moduleHasData = false;
+			summarizeModuleNode(moduleNode.second, std::string(), moduleSummary, moduleHasData);
+			if(moduleHasData)
+				summary.modules.push_back(std::move(moduleSummary));
+		}
+	}
+
+	template<typename Fun>
+	void forEachChild(const bpt::ptree& node, const char* key, Fun fun)
+	{
+		for(const bpt::ptree::value_type& child : node)
+			if(child.first == key)
+				fun(child.second);
+	}
+
+
+	void fillPTree(bpt::ptree& fileNode, const OctMarkerCatalog::FileEntry& entry, const std::string& octFile, const std::string& prefix)
+	{
+		fileNode.put("OctFile"   , makeRelative(octFile         , prefix));
+		fileNode.put("MarkerFile", makeRelative(entry.markerFile, prefix));
+		fileNode.put("Format"    , OctMarkerIO::fileformat2Int(entry.format));
+		fileNode.put("MTime"     , entry.mtime);
+		fileNode.put("Size"      , entry.size );
+		if(entry.readError)
+			fileNode.put("ReadError", true);
+
+		for(const OctMarkerCatalog::SeriesSummary& series : entry.series)
+		{
+			bpt::ptree& seriesNode = fileNode.add("SeriesSummary", "");
+			seriesNode.put("Patient", series.patientId);
+			seriesNode.put("Study"  , series.studyId  );
+			seriesNode.put("Series" , series.seriesId );
+			if(!series.seriesUID.empty())
+				seriesNode.put("SeriesUID", series.seriesUID);
+
+			for(const OctMarkerCatalog::ModuleSummary& module : series.modules)
+			{
+				bpt::ptree& moduleNode = seriesNode.add("Module", "");
+				moduleNode.put("Name"        , module.moduleId    );
+				moduleNode.put("MarkedBScans", module.markedBScans);
+				for(const std::pair<std::string, std::string>& value : module.values)
+				{
+					bpt::ptree& valueNode = moduleNode.add("Value", "");
+					valueNode.put("Path", value.first );
+					valueNode.put("Data", value.second);
+				}
+			}
+		}
+	}
+
+	std::string parsePTree(const bpt::ptree& fileNode, OctMarkerCatalog::FileEntry& entry, const std::string& prefix)
+	{
+		entry.markerFile = makeAbsolute(fileNode.get<std::string>("MarkerFile"), prefix);
+		entry.format     = OctMarkerIO::int2Fileformat(fileNode.get<int>("Format"));
+		entry.mtime      = fileNode.get<int64_t >("MTime");
+		entry.size       = fileNode.get<uint64_t>("Size" );
+		entry.readError  = fileNode.get<bool>("ReadError", false);
+
+		forEachChild(fileNode, "SeriesSummary", [&entry](const bpt::ptree& seriesNode)
+		{
+			OctMarkerCatalog::SeriesSummary series;
+			series.patientId = seriesNode.get<int>("Patient", -1);
+			series.studyId   = seriesNode.get<int>("Study"  , -1);
+			series.seriesId  = seriesNode.get<int>("Series" , -1);
+			series.seriesUID = seriesNode.get<std::string>("SeriesUID", std::string());
+
+			forEachChild(seriesNode, "Module", [&series](const bpt::ptree& moduleNode)
+			{
+				OctMarkerCatalog::ModuleSummary module;
+				module.moduleId     = moduleNode.get<std::string>("Name");
+				module.markedBScans = moduleNode.get<std::size_t>("MarkedBScans", 0);
+				forEachChild(moduleNode, "Value", [&module](const bpt::ptree& valueNode)
+				{
+					module.values.emplace_back(valueNode.get<std::string>("Path"), valueNode.get<std::string>("Data"));
+				});
+				series.modules.push_back(std::move(module));
+			});
+			entry.series.push_back(std::move(series));
+		});
+
+		return makeAbsolute(fileNode.get<std::string>("OctFile"), prefix);
+	}
+}
+
+
+bool OctMarkerCatalog::FileEntry::hasMarkers() const
+{
+	for(const SeriesSummary& s : series)
+		if(!s.modules.empty())
+			return true;
+	return false;
+}
+
+bool OctMarkerCatalog::FileEntry::hasModule(const std::string& moduleId) const
+{
+	for(const SeriesSummary& s : series)
+		for(const ModuleSummary& module : s.modules)
+			if(module.moduleId == moduleId)
+				return true;
+	return false;
+}
+
+
+OctMarkerCatalog::FileEntry OctMarkerCatalog::summarizeMarkerFile(const bfs::path& markerFile, OctMarkerFileformat format)
+{
+	FileEntry entry;
+	entry.markerFile = markerFile.generic_string();
+	entry.format     = format;
+
+	try
+	{
+		entry.mtime = static_cast<int64_t>(bfs::last_write_time(markerFile));
+		entry.size  = static_cast<uint64_t>(bfs::file_size(markerFile));
+
+		bpt::ptree markers;
+		OctMarkerIO markerIO(&markers);
+		if(!markerIO.loadMarkers(markerFile, format))
+		{
+			entry.readError = true;
+			return entry;
+		}
+
+		forEachChild(markers, "Patient", [&entry](const bpt::ptree& patientNode)
+		{
+			forEachChild(patientNode, "Study", [&entry, &patientNode](const bpt::ptree& studyNode)
+			{
+				forEachChild(studyNode, "Series", [&entry, &patientNode, &studyNode](const bpt::ptree& seriesNode)
+				{
+					SeriesSummary series;
+					series.patientId = patientNode.get<int>("ID", -1);
+					series.studyId   = studyNode  .get<int>("ID", -1);
+					series.seriesId  = seriesNode .get<int>("ID", -1);
+					series.seriesUID = seriesNode .get<std::string>("SeriesUID", std::string());
+					summarizeSeries(seriesNode, series);
+					entry.series.push_back(std::move(series));
+				});
+			});
+		});
+	}
+	catch(...)
+	{
+		entry.readError = true;
+		entry.series.clear();
+	}
+	return entry;
+}
+
+
+void OctMarkerCatalog::update(const bfs::path& directory)
+{
+	// OCT files with at least one marker file
+	std::set<std::string> octFiles;
+	try
+	{
+		for(bfs::recursive_directory_iterator it(bfs::absolute(directory)), end; it != end; ++it)
+		{
+			const bfs::path& file = it->path();
+			if(OctMarkerIO::getFormatFromExtension(file) == OctMarkerFileformat::Unknown || !bfs::is_regular_file(it->status()))
+				continue;
+
+			const bfs::path markerFile = OctMarkerIO::isCompressedFile(file) ? file.parent_path() / file.stem() : file;
+			octFiles.insert((markerFile.parent_path() / markerFile.stem()).generic_string());
+		}
+	}
+	catch(const bfs::filesystem_error&)
+	{
+		// unreadable directory: keep the files found so far
+	}
+
+	// default marker file of every OCT file, the file OctMarkerIO::loadDefaultMarker loads
+	std::map<std::string, std::pair<bfs::path, OctMarkerFileformat>> markerFiles;
+	for(const std::string& octFile : octFiles)
+	{
+		bfs::path markerFile;
+		const OctMarkerFileformat format = OctMarkerIO::findDefaultMarkerFile(octFile, markerFile);
+		if(format != OctMarkerFileformat::Unknown)
+			markerFiles.emplace(octFile, std::make_pair(markerFile, format));
+	}
+
+	// unchanged files are taken from the old catalog
+	EntryMap newEntries;
+	std::vector<EntryMap::iterator> changedEntries;
+	for(const std::pair<const std::string, std::pair<bfs::path, OctMarkerFileformat>>& markerFile : markerFiles)
+	{
+		const bfs::path& markerPath = markerFile.second.first;
+		EntryMap::iterator newIt = newEntries.emplace(markerFile.first, FileEntry()).first;
+
+		boost::system::error_code ec;
+		const int64_t  mtime = static_cast<int64_t >(bfs::last_write_time(markerPath, ec));
+		const uint64_t size  = static_cast<uint64_t>(bfs::file_size      (markerPath, ec));
+
+		EntryMap::const_iterator oldIt = entries.find(markerFile.first);
+		if(!ec && oldIt != entries.end()
+		&& oldIt->second.markerFile == markerPath.generic_string()
+		&& oldIt->second.mtime == mtime
+		&& oldIt->second.size  == size)
+			newIt->second = oldIt->second;
+		else
+			changedEntries.push_back(newIt);
+	}
+
+	ParallelFor::run(changedEntries.size(), [&changedEntries, &markerFiles](std::size_t i)
+	{
+		EntryMap::iterator it = changedEntries[i];
+		const std::pair<bfs::path, OctMarkerFileformat>& markerFile = markerFiles.at(it->first);
+		it->second = summarizeMarkerFile(markerFile.first, markerFile.second);
+	});
+
+	entries.swap(newEntries);
+}
+
+
+bool OctMarkerCatalog::load(const bfs::path& directory, const bfs::path& catalogFile)
+{
+	if(!bfs::exists(catalogFile))
+		return false;
+
+	EntryMap newEntries;
+	try
+	{
+		bpt::ptree tree;
+		OctMarkerBinaryIO::read(catalogFile, tree);
+
+		const bpt::ptree& catalogNode = tree.get_child(catalogNodeName);
+		if(catalogNode.get<int>("Version", -1) != catalogVersion)
+			return false;
+
+		const std::string prefix = directoryPrefix(directory);
+		forEachChild(catalogNode, "File", [&newEntries, &prefix](const bpt::ptree& fileNode)
+		{
+			FileEntry entry;
+			const std::string octFile = parsePTree(fileNode, entry, prefix);
+			newEntries[octFile] = std::move(entry);
+		});
+	}
+	catch(...)
+	{
+		return false;
+	}
+
+	entries.swap(newEntries);
+	return true;
+}
+
+
+bool OctMarkerCatalog::save(const bfs::path& directory, const bfs::path& catalogFile) const
+{
+	const std::string prefix = directoryPrefix(directory);
+
+	bpt::ptree tree;
+	bpt::ptree& catalogNode = tree.put(catalogNodeName, "");
+	catalogNode.put("Version", catalogVersion);
+	for(const std::pair<const std::string, FileEntry>& entry : entries)
+		fillPTree(catalogNode.add("File", ""), entry.second, entry.first, prefix);
+
+	// write to a temporary file and replace the catalog when complete
+	const bfs::path tmpPath(catalogFile.native() + bfs::path(".tmp").native());
+	{
+		io::file_descriptor_sink fs(tmpPath);
+		io::stream<io::file_descriptor_sink> fsstream(fs);
+		OctMarkerBinaryIO::write(fsstream, tree);
+
+		fsstream.flush();
+		if(!fsstream.good())
+		{
+			fsstream.close();
+			bfs::remove(tmpPath);
+			return false;
+		}
+	}
+
+	bfs::rename(tmpPath, catalogFile);
+	return true;
+}
+
+
+void OctMarkerCatalog::merge(const OctMarkerCatalog& other, const bfs::path& directory)
+{
+	const std::string prefix = directoryPrefix(directory);
+	for(EntryMap::iterator it = entries.lower_bound(prefix); it != entries.end() && it->first.compare(0, prefix.size(), prefix) == 0; )
+		it = entries.erase(it);
+
+	for(const std::pair<const std::string, FileEntry>& entry : other.entries)
+		entries[entry.first] = entry.second;
+}
+
+
+const OctMarkerCatalog::FileEntry* OctMarkerCatalog::getEntry(const std::string& octFilename) const
+{
+	EntryMap::const_iterator it = entries.find(octFilename);
+	if(it != entries.end())
+		return &it->second;
+
+	if(octFilename.size() > 3 && octFilename.compare(octFilename.size()-3, 3, ".gz") == 0)
+		return getEntry(octFilename.substr(0, octFilename.size()-3));
+
+	return nullptr;
+}
@@ -0,0 +1,90 @@
+/*
+ * Copyright (c) 2018 Kay Gawlik <kaydev@amarunet.de> <kay.gawlik@beuth-hochschule.de> <kay.gawlik@charite.de>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+#ifndef OCTMARKERCATALOG_H
+#define OCTMARKERCATALOG_H
+
+#include <string>
+#include <vector>
+#include <map>
+#include <cstdint>
+
+#include <globaldefinitions.h>
+
+namespace boost{ namespace filesystem { class path; }}
+
+
+/*
+ * Summary of the marker files of a directory tree
+ *
+ * For every OCT file with a default marker file the catalog records which
+ * marker modules have data per series, the number of BScans with markers,
+ * the scan wide values (e.g. classifier states) and the marker file time.
+ * The catalog is stored as binary marker container in a file given by the
+ * caller (exam directories are often read only or shared, OctFilesModel uses
+ * the cache directory of the user); an update only reads changed marker files.
+ */
+class OctMarkerCatalog
+{
+public:
+	struct ModuleSummary
+	{
+		std::string moduleId;
+		std::size_t markedBScans = 0;
+		std::vector<std::pair<std::string, std::string>> values;     // path in module node, value
+	};
+
+	struct SeriesSummary
+	{
+		int patientId = -1;
+		int studyId   = -1;
+		int seriesId  = -1;
+		std::string seriesUID;
+		std::vector<ModuleSummary> modules;
+	};
+
+	struct FileEntry
+	{
+		std::string         markerFile;                              // absolute, generic format
+		OctMarkerFileformat format    = OctMarkerFileformat::Unknown;
+		int64_t             mtime     = 0;
+		uint64_t            size      = 0;
+		bool                readError = false;
+		std::vector<SeriesSummary> series;
+
+		bool hasMarkers() const;
+		bool hasModule(const std::string& moduleId) const;
+	};
+
+	typedef std::map<std::string, FileEntry> EntryMap;             // key: OCT filename (absolute, generic format)
+
+	bool load(const boost::filesystem::path& directory, const boost::filesystem::path& catalogFile); // reads the stored catalog
+	bool save(const boost::filesystem::path& directory, const boost::filesystem::path& catalogFile) const;
+	void update(const boost::filesystem::path& directory);          // scans the directory tree, reads new and changed marker files
+
+	void merge(const OctMarkerCatalog& other, const boost::filesystem::path& directory); // replaces the entries below directory
+
+	const FileEntry* getEntry(const std::string& octFilename) const;
+	const EntryMap& getEntries()                            const   { return entries; }
+
+	static FileEntry summarizeMarkerFile(const boost::filesystem::path& markerFile, OctMarkerFileformat format);
+
+private:
+	EntryMap entries;
+};
+
+#endif // OCTMARKERCATALOG_H
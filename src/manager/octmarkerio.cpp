@@ -17,6 +17,7 @@
  */
 
 #include "octmarkerio.h"
+#include "octmarkerbinaryio.h"
 
 #ifndef MEX_COMPILE
 	#include <data_structure/programoptions.h>
@@ -26,6 +27,7 @@
 #endif
 
 #include <helper/ptreehelper.h>
+#include <helper/parallelgzip.h>
 #include <oct_cpp_framework/platform_helper/filename_unicode.h>
 
 #include <boost/property_tree/ptree.hpp>
@@ -35,6 +37,10 @@
 
 #include <boost/iostreams/device/file_descriptor.hpp>
 #include <boost/iostreams/stream.hpp>
+#include <boost/iostreams/filtering_stream.hpp>
+#include <boost/iostreams/filter/gzip.hpp>
+#include <sstream>
+#include <ctime>
 #include <boost/filesystem.hpp>
 #include <iostream>
 
@@ -59,6 +65,8 @@ namespace
 	{
 		const char* mainNodeName = "OctMarker";
 		const int   version      = 1;
+
+		const char* compressedExtension = ".gz";
 	}
 }
 
@@ -82,6 +90,7 @@ OctMarkerFileformat OctMarkerIO::getDefaultFileFormat()
 		case OctMarkerFileformat::XML:
 		case OctMarkerFileformat::Json:
 		case OctMarkerFileformat::INFO:
+		case OctMarkerFileformat::Binary:
 			return format;
 		case OctMarkerFileformat::Unknown:
 		case OctMarkerFileformat::Auto:
@@ -91,6 +100,15 @@ OctMarkerFileformat OctMarkerIO::getDefaultFileFormat()
 	return OctMarkerFileformat::Json;
 }
 
+bool OctMarkerIO::getDefaultCompression()
+{
+#ifndef MEX_COMPILE
+	return ProgramOptions::compressOctMarkers();
+#else
+	return false;
+#endif
+}
+
 
 int OctMarkerIO::fileformat2Int(OctMarkerFileformat format)
 {
@@ -102,6 +120,8 @@ int OctMarkerIO::fileformat2Int(OctMarkerFileformat format)
 			return static_cast<int>(OctMarkerFileformat::Json);
 		case OctMarkerFileformat::INFO:
 			return static_cast<int>(OctMarkerFileformat::INFO);
+		case OctMarkerFileformat::Binary:
+			return static_cast<int>(OctMarkerFileformat::Binary);
 		case OctMarkerFileformat::Unknown:
 		case OctMarkerFileformat::Auto:
 		case OctMarkerFileformat::NoExtension:
@@ -120,6 +140,8 @@ OctMarkerFileformat OctMarkerIO::int2Fileformat(int formatId)
 			return OctMarkerFileformat::Json;
 		case static_cast<int>(OctMarkerFileformat::INFO):
 			return OctMarkerFileformat::INFO;
+		case static_cast<int>(OctMarkerFileformat::Binary):
+			return OctMarkerFileformat::Binary;
 	}
 	return OctMarkerFileformat::Unknown;
 }
@@ -132,8 +154,19 @@ OctMarkerFileformat OctMarkerIO::getFormatFromExtension(const std::string& filen
 	return getFormatFromExtension(markersPath);
 }
 
+bool OctMarkerIO::isCompressedFile(const boost::filesystem::path& markersPath)
+{
+	return markersPath.extension().generic_string() == Constants::compressedExtension;
+}
+
 OctMarkerFileformat OctMarkerIO::getFormatFromExtension(const boost::filesystem::path& markersPath)
 {
+	if(isCompressedFile(markersPath))
+	{
+		const OctMarkerFileformat format = getFormatFromExtension(markersPath.stem());
+		return format == OctMarkerFileformat::NoExtension ? OctMarkerFileformat::Unknown : format;
+	}
+
 	std::string extension = markersPath.extension().generic_string();
 	if(extension.length() == 0)
 		return OctMarkerFileformat::NoExtension;
@@ -146,6 +179,8 @@ OctMarkerFileformat OctMarkerIO::getFormatFromExtension(const boost::filesystem:
 		return OctMarkerFileformat::XML;
 	if(extension == getFileExtension(OctMarkerFileformat::INFO))
 		return OctMarkerFileformat::INFO;
+	if(extension == getFileExtension(OctMarkerFileformat::Binary))
+		return OctMarkerFileformat::Binary;
 
 	return OctMarkerFileformat::Unknown;
 }
@@ -161,6 +196,8 @@ const char* OctMarkerIO::getFileExtension(OctMarkerFileformat format)
 			return "xoctmarker";
 		case OctMarkerFileformat::INFO:
 			return "ioctmarker";
+		case OctMarkerFileformat::Binary:
+			return "boctmarker";
 		case OctMarkerFileformat::Unknown:
 		case OctMarkerFileformat::Auto:
 		case OctMarkerFileformat::NoExtension:
@@ -176,24 +213,61 @@ std::string OctMarkerIO::addMarkerExtension(const std::string& file, OctMarkerFi
 
 
 
-bool OctMarkerIO::loadDefaultMarker(const std::string& octFilename)
+OctMarkerFileformat OctMarkerIO::findDefaultMarkerFile(const std::string& octFilename, boost::filesystem::path& markersFile, std::size_t* numFound)
 {
-	loadedDefaultFilename.clear();
 	OctMarkerFileformat formats[] = { OctMarkerFileformat::Json,
 	                                  OctMarkerFileformat::XML,
-	                                  OctMarkerFileformat::INFO };
-	
+	                                  OctMarkerFileformat::INFO,
+	                                  OctMarkerFileformat::Binary };
+
+	// several marker files (e.g. after a change of the default format): the newest is used, on equal time the first in formats
+	OctMarkerFileformat newestFormat = OctMarkerFileformat::Unknown;
+	std::time_t         newestTime   = 0;
+	std::size_t         found        = 0;
 	for(std::size_t i = 0; i < sizeof(formats)/sizeof(formats[0]); ++i)
 	{
-		bfs::path markersFile = filenameConv(addMarkerExtension(octFilename, formats[i]));
-		if(bfs::exists(markersFile))
+		const std::string markersFilename = addMarkerExtension(octFilename, formats[i]);
+		for(const std::string& filename : { markersFilename, markersFilename + Constants::compressedExtension })
 		{
-			defaultLoadedFormat = formats[i];
-			loadedDefaultFilename = markersFile.generic_string();
-			return loadMarkers(markersFile, defaultLoadedFormat);
+			bfs::path file = filenameConv(filename);
+			if(bfs::exists(file))
+			{
+				boost::system::error_code ec;
+				const std::time_t writeTime = bfs::last_write_time(file, ec);
+				if(found == 0 || (!ec && writeTime > newestTime))
+				{
+					markersFile  = file;
+					newestFormat = formats[i];
+					newestTime   = ec ? 0 : writeTime;
+				}
+				++found;
+			}
 		}
 	}
 
+	if(numFound)
+		*numFound = found;
+	return newestFormat;
+}
+
+
+bool OctMarkerIO::loadDefaultMarker(const std::string& octFilename)
+{
+	loadedDefaultFilename.clear();
+
+	bfs::path   markersFile;
+	std::size_t numFound = 0;
+	const OctMarkerFileformat format = findDefaultMarkerFile(octFilename, markersFile, &numFound);
+	if(format != OctMarkerFileformat::Unknown)
+	{
+		if(numFound > 1)
+			std::cerr << "several marker files for " << octFilename << ", loading the newest: " << markersFile.generic_string() << '\n';
+
+		defaultLoadedFormat = format;
+		loadedDefaultFilename = markersFile.generic_string();
+		return loadMarkers(markersFile, defaultLoadedFormat);
+	}
+
 
 	if(octFilename.substr(octFilename.size()-3, 3) == ".gz")
 		return loadDefaultMarker(octFilename.substr(0, octFilename.size()-3));
@@ -203,12 +277,29 @@ bool OctMarkerIO::loadDefaultMarker(const std::string& octFilename)
 }
 
 
-bool OctMarkerIO::saveDefaultMarker(const std::string& octFilename)
+void OctMarkerIO::takeDefaultMarker(OctMarkerIO& loader)
+{
+	markerstree->swap(*loader.markerstree);
+	defaultLoadedFormat = loader.defaultLoadedFormat;
+	loadedDefaultFilename.swap(loader.loadedDefaultFilename);
+}
+
+
+std::string OctMarkerIO::getDefaultMarkerFilename(const std::string& octFilename) const
 {
 	if(loadedDefaultFilename.empty())
-		return saveMarkers(addMarkerExtension(octFilename, defaultLoadedFormat), defaultLoadedFormat);
-	else
-		return saveMarkers(loadedDefaultFilename, defaultLoadedFormat);
+	{
+		if(getDefaultCompression())
+			return addMarkerExtension(octFilename, defaultLoadedFormat) + Constants::compressedExtension;
+		return addMarkerExtension(octFilename, defaultLoadedFormat);
+	}
+	return loadedDefaultFilename;
+}
+
+
+bool OctMarkerIO::saveDefaultMarker(const std::string& octFilename)
+{
+	return saveMarkers(getDefaultMarkerFilename(octFilename), defaultLoadedFormat);
 }
 
 bool OctMarkerIO::loadMarkers(const boost::filesystem::path& markersPath, OctMarkerFileformat format)
@@ -227,9 +318,41 @@ bool OctMarkerIO::loadMarkers(const boost::filesystem::path& markersPath, OctMar
 
 	bpt::ptree loadTree;
 
-    io::file_descriptor_source fs(markersPath);
-    io::stream<io::file_descriptor_source> fsstream(fs);
+	if(isCompressedFile(markersPath))
+	{
+		io::file_descriptor_source fs(markersPath);
+		io::stream<io::file_descriptor_source> fsstream(fs);
+		if(format == OctMarkerFileformat::Binary)
+		{
+			std::string data;
+			ParallelGzip::read(fsstream, data);
+			OctMarkerBinaryIO::read(data.data(), data.size(), loadTree);
+		}
+		else
+		{
+			io::filtering_istream decompressed;
+			decompressed.push(io::gzip_decompressor());
+			decompressed.push(fsstream);
+			if(!readTextTree(decompressed, loadTree, format))
+				return false;
+		}
+	}
+	else if(format == OctMarkerFileformat::Binary)
+		OctMarkerBinaryIO::read(markersPath, loadTree);
+	else
+	{
+		io::file_descriptor_source fs(markersPath);
+		io::stream<io::file_descriptor_source> fsstream(fs);
+		if(!readTextTree(fsstream, loadTree, format))
+			return false;
+	}
 
+	return takeMarkersFromSaveTree(loadTree);
+}
+
+
+bool OctMarkerIO::readTextTree(std::istream& fsstream, bpt::ptree& loadTree, OctMarkerFileformat format)
+{
 	switch(format)
 	{
 		case OctMarkerFileformat::Json:
@@ -244,9 +367,15 @@ bool OctMarkerIO::loadMarkers(const boost::filesystem::path& markersPath, OctMar
 		case OctMarkerFileformat::Auto: // avoid compiler warnings
 		case OctMarkerFileformat::Unknown:
 		case OctMarkerFileformat::NoExtension:
+		case OctMarkerFileformat::Binary:
 			return false;
 	}
+	return true;
+}
+
 
+bool OctMarkerIO::takeMarkersFromSaveTree(bpt::ptree& loadTree)
+{
 	boost::optional<bpt::ptree&> nodeMain = loadTree.get_child_optional(Constants::mainNodeName);
 	if(!nodeMain)
 		return false;
@@ -263,7 +392,7 @@ bool OctMarkerIO::loadMarkers(const boost::filesystem::path& markersPath, OctMar
 	if(!nodeMarkers)
 		return false;
 
-	*markerstree = *nodeMarkers;
+	markerstree->swap(*nodeMarkers);
 
 	return true;
 }
@@ -297,31 +426,65 @@ bool OctMarkerIO::saveMarkersPrivat(const std::string& markersFilename, OctMarke
 	bpt::ptree saveTree;
 	bpt::ptree& markerTree = saveTree.put(Constants::mainNodeName, "");
 	markerTree.put("Version", Constants::version);
-    markerTree.add_child("Markers", *markerstree);
+	bpt::ptree& markersNode = markerTree.add_child("Markers", bpt::ptree());
+
+	// borrow the marker tree instead of copying it, give it back in all cases
+	struct TreeSwap
+	{
+		bpt::ptree& a;
+		bpt::ptree& b;
+		TreeSwap(bpt::ptree& a, bpt::ptree& b) : a(a), b(b)        { a.swap(b); }
+		~TreeSwap()                                                 { a.swap(b); }
+	} treeSwap(markersNode, *markerstree);
 
 
+	// write to a temporary file and replace the marker file when complete
 	boost::filesystem::path p(filenameConv(markersFilename));
-    io::file_descriptor_sink fs(p);
-    io::stream<io::file_descriptor_sink> fsstream(fs);
+	boost::filesystem::path tmpPath(p.native() + boost::filesystem::path(".tmp").native());
+	{
+		io::file_descriptor_sink fs(tmpPath);
+		io::stream<io::file_descriptor_sink> fsstream(fs);
 
+		// compressed files: serialize to memory, compress the blocks in parallel
+		const bool compressed = isCompressedFile(p);
+		std::ostringstream uncompressedStream;
+		std::ostream& outstream = compressed ? static_cast<std::ostream&>(uncompressedStream) : fsstream;
 
-	switch(format)
-	{
-		case OctMarkerFileformat::Json:
-			bpt::write_json(fsstream, saveTree);
-			break;
-		case OctMarkerFileformat::XML:
-			bpt::write_xml(fsstream, saveTree, bpt::xml_writer_make_settings<bpt::ptree::key_type>('\t', 1u));
-			break;
-		case OctMarkerFileformat::INFO:
-			bpt::write_info(fsstream, saveTree, bpt::info_writer_settings<char>('\t', 1u));
-			break;
-		case OctMarkerFileformat::Unknown:
-		case OctMarkerFileformat::Auto:
-		case OctMarkerFileformat::NoExtension:
+		switch(format)
+		{
+			case OctMarkerFileformat::Json:
+				bpt::write_json(outstream, saveTree);
+				break;
+			case OctMarkerFileformat::XML:
+				bpt::write_xml(outstream, saveTree, bpt::xml_writer_make_settings<bpt::ptree::key_type>('\t', 1u));
+				break;
+			case OctMarkerFileformat::INFO:
+				bpt::write_info(outstream, saveTree, bpt::info_writer_settings<char>('\t', 1u));
+				break;
+			case OctMarkerFileformat::Binary:
+				OctMarkerBinaryIO::write(outstream, saveTree);
+				break;
+			case OctMarkerFileformat::Unknown:
+			case OctMarkerFileformat::Auto:
+			case OctMarkerFileformat::NoExtension:
+				fsstream.close();
+				bfs::remove(tmpPath);
+				return false;
+		}
+
+		if(compressed)
+			ParallelGzip::write(fsstream, uncompressedStream.str());
+
+		fsstream.flush();
+		if(!fsstream.good())
+		{
+			fsstream.close();
+			bfs::remove(tmpPath);
 			return false;
+		}
 	}
 
+	bfs::rename(tmpPath, p);
+
 	return true;
 }
-
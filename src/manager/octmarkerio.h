@@ -20,6 +20,7 @@
 #define OCTMARKERIO_H
 
 #include<string>
+#include<iosfwd>
 
 #include<boost/property_tree/ptree_fwd.hpp>
 
@@ -31,6 +32,7 @@ namespace boost{ namespace filesystem { class path; }}
 class OctMarkerIO
 {
 	static OctMarkerFileformat getDefaultFileFormat();
+	static bool getDefaultCompression();
 
 	OctMarkerFileformat defaultLoadedFormat = OctMarkerFileformat::Json;
 	std::string loadedDefaultFilename;
@@ -38,6 +40,8 @@ class OctMarkerIO
 	boost::property_tree::ptree* markerstree = nullptr;
 
 	bool saveMarkersPrivat(const std::string& markersFilename, OctMarkerFileformat format);
+	bool takeMarkersFromSaveTree(boost::property_tree::ptree& loadTree);
+	static bool readTextTree(std::istream& fsstream, boost::property_tree::ptree& loadTree, OctMarkerFileformat format);
 	
 public:
 	explicit OctMarkerIO(boost::property_tree::ptree* markerTree);
@@ -47,13 +51,18 @@ public:
 	static OctMarkerFileformat getFormatFromExtension(const std::string            & filename);
 	static OctMarkerFileformat getFormatFromExtension(const boost::filesystem::path& markersPath);
 	static std::string addMarkerExtension(const std::string& file, OctMarkerFileformat format);
+	static bool isCompressedFile(const boost::filesystem::path& markersPath);   // gzip compressed marker file (<marker file>.gz)
+	static OctMarkerFileformat findDefaultMarkerFile(const std::string& octFilename, boost::filesystem::path& markersFile, std::size_t* numFound = nullptr); // Unknown if there is none
 	
 	static OctMarkerFileformat int2Fileformat(int formatId);
 	static int fileformat2Int(OctMarkerFileformat format);
 	
 	
 	bool saveDefaultMarker(const std::string& octFilename);
+	std::string getDefaultMarkerFilename(const std::string& octFilename) const;
+	OctMarkerFileformat getDefaultLoadedFormat() const              { return defaultLoadedFormat; }
 	bool loadDefaultMarker(const std::string& octFilename);
+	void takeDefaultMarker(OctMarkerIO& loader); // takes the markers and the default file information from an other (loader) instance
 	
 	bool loadMarkers(const std::string&             markersFilename, OctMarkerFileformat format);
 	bool loadMarkers(const boost::filesystem::path& markersPath    , OctMarkerFileformat format);
@@ -35,6 +35,7 @@
 #include <QMessageBox>
 
 #include <QTime>
+#include <QTimer>
 
 #include "octdatamanager.h"
 
@@ -49,6 +50,7 @@
 #include <markermodules/distancemeter/distancemeter.h>
 
 #include <helper/ptreehelper.h>
+#include <helper/tracelog.h>
 
 #include <boost/property_tree/ptree.hpp>
 
@@ -78,12 +80,17 @@ OctMarkerManager::OctMarkerManager()
 		connect(obj, &BscanMarkerBase::requestFullUpdate      , this, &OctMarkerManager::udateFromMarkerModul             );
 		connect(obj, &BscanMarkerBase::sloViewHasChanged      , this, &OctMarkerManager::handleSloRedrawAfterMarkerChange );
 		connect(obj, &BscanMarkerBase::requestSloOverlayUpdate, this, &OctMarkerManager::sloOverlayUpdateFromMarkerModul  );
+		connect(obj, &BscanMarkerBase::requestSloOverlayRegionUpdate, this, &OctMarkerManager::sloOverlayRegionUpdateFromMarkerModul);
 		connect(obj, &BscanMarkerBase::undoRedoChanged        , this, &OctMarkerManager::updateUndoRedowState             );
 		connect(obj, &BscanMarkerBase::requestChangeBscan     , this, &OctMarkerManager::bscanChangeRequestFromMarkerModul);
 	}
 
 
 	sloMarkerObj.push_back(new SloObjectMarker(this));
+
+	settleTimer = new QTimer(this);
+	settleTimer->setSingleShot(true);
+	connect(settleTimer, &QTimer::timeout, this, &OctMarkerManager::settleBScan);
 	
 	setBscanMarker(ProgramOptions::bscanMarkerToolId());
 	setSloMarker  (ProgramOptions::  sloMarkerToolId());
@@ -111,21 +118,39 @@ void OctMarkerManager::chooseBScan(int bscan)
 
 	actBScan = bscan;
 
-// 	if(actBscanMarker)
-// 		actBscanMarker->setActBScan(actBScan);
-
-	// TODO bessere Implementierung (nur aktualisieren was angezeigt wird)
 	for(BscanMarkerBase* marker : bscanMarkerObj)
-		marker->setActBScan(actBScan);
+		marker->previewActBScan(actBScan);
 
+	// the expensive module updates wait until the navigation settles,
+	// a new request restarts the timer and so cancels the update of the skipped bscan
+	const int settleTime = ProgramOptions::bscanNavigationSettleTime();
+	if(settleTime > 0)
+		settleTimer->start(settleTime);
+	else
+		settleBScan();
 
 	emit(newBScanShowed(series->getBScan(actBScan)));
 	emit(bscanChanged(actBScan));
 }
 
+void OctMarkerManager::settleBScan()
+{
+	settleTimer->stop();
+	if(settledBScan == actBScan || actBScan < 0 || !series)
+		return;
+
+	settledBScan = actBScan;
+	for(BscanMarkerBase* marker : bscanMarkerObj)
+		marker->setActBScan(static_cast<std::size_t>(actBScan));
+
+	emit(bscanSettled(actBScan));
+}
+
 
 void OctMarkerManager::showSeries(const OctData::Series* s)
 {
+	ScopedTrace trace("OctMarkerManager::showSeries");
+
 	series = s;
 	bpt::ptree* markerTree = OctDataManager::getInstance().getMarkerTree(s);
 
@@ -144,6 +169,7 @@ void OctMarkerManager::showSeries(const OctData::Series* s)
 	{
 		const QString& markerId = obj->getMarkerId();
 		bpt::ptree& subtree = PTreeHelper::get_put(*markerTree, markerId.toStdString());
+		ScopedTrace trace("newSeriesLoaded", markerId);
 		obj->newSeriesLoaded(s, subtree);
 	}
 
@@ -151,17 +177,24 @@ void OctMarkerManager::showSeries(const OctData::Series* s)
 	{
 		const QString& markerId = obj->getMarkerId();
 		bpt::ptree& subtree = PTreeHelper::get_put(*markerTree, markerId.toStdString());
+		ScopedTrace trace("newSeriesLoaded", markerId);
 		obj->newSeriesLoaded(s, subtree);
 	}
 
 	if(s)
+	{
+		ScopedTrace trace("loadExtraData");
 		extraSeriesData->loadExtraData(*s, *markerTree);
+	}
 
 
 // 	emit(newBScanShowed(series->getBScan(actBScan)));
 	emit(newSeriesShowed(s));
-	actBScan = -1;
+	settleTimer->stop();
+	actBScan     = -1;
+	settledBScan = -1;
 	chooseBScan(0);
+	settleBScan();
 }
 
 void OctMarkerManager::setBscanMarkerTextID(QString id)
@@ -190,6 +223,7 @@ void OctMarkerManager::setBscanMarker(int id)
 	
 	if(newMarker != actBscanMarker)
 	{
+		settleBScan();
 		actBscanMarkerId = id;
 		if(actBscanMarker)
 		{
@@ -245,6 +279,7 @@ void OctMarkerManager::saveMarkerStateSlot(const OctData::Series* s)
 	if(!markerTree)
 		return;
 
+	settleBScan();
 
 	for(BscanMarkerBase* obj : bscanMarkerObj)
 	{
@@ -273,11 +308,13 @@ void OctMarkerManager::loadMarkerStateSlot(const OctData::Series* s)
 	if(!markerTree)
 		return;
 
+	settleBScan();
 
 	for(BscanMarkerBase* obj : bscanMarkerObj)
 	{
 		const QString& markerId = obj->getMarkerId();
 		bpt::ptree& subtree = PTreeHelper::get_put(*markerTree, markerId.toStdString());
+		ScopedTrace trace("loadState", markerId);
 		obj->loadState(subtree);
 	}
 
@@ -285,6 +322,7 @@ void OctMarkerManager::loadMarkerStateSlot(const OctData::Series* s)
 	{
 		const QString& markerId = obj->getMarkerId();
 		bpt::ptree& subtree = PTreeHelper::get_put(*markerTree, markerId.toStdString());
+		ScopedTrace trace("loadState", markerId);
 		obj->loadState(subtree);
 	}
 }
@@ -314,6 +352,7 @@ void OctMarkerManager::bscanChangeRequestFromMarkerModul(int bscan)
 	 if(obj == actBscanMarker)
 	 {
 		chooseBScan(bscan);
+		settleBScan(); // the module continues with the state of this bscan
 	 }
 }
 
@@ -338,6 +377,12 @@ void OctMarkerManager::sloOverlayUpdateFromMarkerModul()
 	emit(sloOverlayChanged());
 }
 
+void OctMarkerManager::sloOverlayRegionUpdateFromMarkerModul(const QRect& region)
+{
+	if(sender() == actBscanMarker)
+		emit(sloOverlayRegionChanged(region));
+}
+
 
 const OctData::BScan* OctMarkerManager::getActBScan() const
 {
@@ -367,12 +412,14 @@ std::size_t OctMarkerManager::numUndoSteps() const
 
 void OctMarkerManager::callRedoStep()
 {
+	settleBScan();
 	if(actBscanMarker)
 		actBscanMarker->callRedoStep();
 }
 
 void OctMarkerManager::callUndoStep()
 {
+	settleBScan();
 	if(actBscanMarker)
 		actBscanMarker->callUndoStep();
 }
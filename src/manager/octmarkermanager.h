@@ -20,6 +20,7 @@
 #define MARKERMANAGER_H
 
 #include <QObject>
+#include <QRect>
 #include <vector>
 
 // #include <boost/property_tree/ptree_fwd.hpp>
@@ -35,6 +36,7 @@ class SloMarkerBase;
 class ExtraSeriesData;
 class ExtraImageData;
 class QPaintEvent;
+class QTimer;
 
 class BScanMarkerWidget;
 
@@ -44,6 +46,7 @@ public:
 	static OctMarkerManager& getInstance()                          { static OctMarkerManager instance; return instance; }
 
 	int getActBScanNum() const                                      { return actBScan; }
+	bool isBScanSettled() const                                     { return settledBScan == actBScan; }
 	const OctData::Series* getSeries() const                        { return series;   }
 	const OctData::BScan * getActBScan () const;
 
@@ -72,6 +75,8 @@ private:
 	virtual ~OctMarkerManager();
 
 	int                    actBScan = 0;
+	int                    settledBScan = -1;                       // bscan of the last setActBScan call to the marker modules
+	QTimer*                settleTimer = nullptr;
 	const OctData::Series* series   = nullptr;
 	
 	std::vector<BscanMarkerBase*> bscanMarkerObj;
@@ -96,6 +101,7 @@ private slots:
 	virtual void udateFromMarkerModul();
 	void bscanChangeRequestFromMarkerModul(int bscan);
 	void sloOverlayUpdateFromMarkerModul();
+	void sloOverlayRegionUpdateFromMarkerModul(const QRect& region);
 
 	void handleSloRedrawAfterMarkerChange();
 
@@ -103,6 +109,7 @@ private slots:
 
 public slots:
 	virtual void chooseBScan(int bscan);
+	void settleBScan();                                             // runs the deferred module updates of the actual bscan now
 	virtual void inkrementBScan(int inkrement)                      { chooseBScan(actBScan + inkrement); }
 
 	virtual void nextBScan()                                        { inkrementBScan(+1); }
@@ -116,12 +123,14 @@ public slots:
 
 signals:
 	void bscanChanged      (int bscan);
+	void bscanSettled      (int bscan);
 	void sloViewChanged    ();
 	void newSeriesShowed   (const OctData::Series* series);
 	void newBScanShowed    (const OctData::BScan * series);
 	void bscanMarkerChanged(BscanMarkerBase* marker);
 	void sloMarkerChanged  (SloMarkerBase  * marker);
 	void sloOverlayChanged ();
+	void sloOverlayRegionChanged(const QRect& region);          // SLO pixel coordinates
 	void undoRedoStateChange();
 
 private:
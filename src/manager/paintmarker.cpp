@@ -29,6 +29,8 @@
 
 #include <markermodules/bscanmarkerbase.h>
 
+#include <helper/painttiming.h>
+
 PaintMarker::PaintMarker()
 {
 	connect(&model, &PaintMarkerModel::viewChanged, this, &PaintMarker::viewChanged);
@@ -55,11 +57,15 @@ void PaintMarker::paintMarker(QPainter& painter, BScanMarkerWidget* widget, cons
 			const BscanMarkerBase* marker = pmi.getMarker();
 			if(marker != actBscanMarker && marker)
 			{
+				ScopedPaintTimer timer("drawMarker", marker->getMarkerId());
 				marker->drawMarker(painter, widget, rect);
 			}
 		}
 	}
 
 	if(actBscanMarker)
+	{
+		ScopedPaintTimer timer("drawMarker", actBscanMarker->getMarkerId());
 		actBscanMarker->drawMarker(painter, widget, rect);
+	}
 }
@@ -61,6 +61,8 @@
 
 #include<data_structure/programoptions.h>
 #include<helper/signalblocker.h>
+#include<helper/tracelog.h>
+#include<helper/memoryusage.h>
 
 BScanIntervalMarker::BScanIntervalMarker(OctMarkerManager* markerManager)
 : BscanMarkerBase(markerManager)
@@ -344,12 +346,14 @@ void BScanIntervalMarker::generateSloMap()
 	const SloBScanDistanceMap* distMap = manager.getSeriesSLODistanceMap();
 	if(distMap && actCollectionValid())
 	{
+		ScopedTrace trace("SloIntervallMap::createMap");
 		SloIntervallMap tm;
 
 		tm.createMap(*distMap, actCollection->second.markers, getSeries());
 // 					tm.createMap(*distMap, lines, OctData::Segmentationlines::SegmentlineType::ILM, OctData::Segmentationlines::SegmentlineType::BM, factor, *thicknessmapColor);
+		const cv::Mat oldSloOverlay = *sloOverlayImage;
 		*sloOverlayImage = tm.getSloMap();
-		requestSloOverlayUpdate();
+		reportSloOverlayChange(oldSloOverlay, *sloOverlayImage);
 
 		std::cout << "Creating slomap took " << timer.elapsed() << " milliseconds" << std::endl;
 	}
@@ -532,6 +536,28 @@ void BScanIntervalMarker::saveState(boost::property_tree::ptree& markerTree)
 }
 
 
+void BScanIntervalMarker::addMemoryUsage(MemoryUsage& usage) const
+{
+	BscanMarkerBase::addMemoryUsage(usage);
+	const std::string category = "marker " + getMarkerId().toStdString();
+
+	// interval_map is a std::map, a tree node holds the value and three pointers plus the color
+	const std::size_t nodeBytes = sizeof(MarkerMap::value_type) + 4*sizeof(void*);
+	for(const MarkersCollectionsDataList::value_type& collection : markersCollectionsData)
+	{
+		std::size_t bytes        = MemoryUsage::bytes(collection.second.markers);
+		std::size_t numIntervals = 0;
+		for(const MarkerMap& markerMap : collection.second.markers)
+			numIntervals += markerMap.iterative_size();
+		bytes += numIntervals*nodeBytes;
+
+		usage.add(category, "intervals " + collection.first, bytes, numIntervals);
+	}
+
+	if(sloOverlayImage)
+		usage.add(category, "slo overlay", MemoryUsage::bytes(*sloOverlayImage));
+}
+
 void BScanIntervalMarker::loadState(boost::property_tree::ptree& markerTree)
 {
 	SignalBlocker sb(this);
@@ -677,10 +703,10 @@ std::size_t BScanIntervalMarker::getMaxBscanWidth() const
 	return maxBscanWidth;
 }
 
-bool BScanIntervalMarker::drawSLOOverlayImage(const cv::Mat& sloImage, cv::Mat& outSloImage, double alpha) const
+bool BScanIntervalMarker::drawSLOOverlayImage(const cv::Mat& sloImage, cv::Mat& outSloImage, double alpha, const cv::Rect* region) const
 {
 	if(sloOverlayImage)
-		return BscanMarkerBase::drawSLOOverlayImage(sloImage, outSloImage, alpha, *sloOverlayImage);
+		return BscanMarkerBase::drawSLOOverlayImage(sloImage, outSloImage, alpha, *sloOverlayImage, region);
 	return false;
 }
 
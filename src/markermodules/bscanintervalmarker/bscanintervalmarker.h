@@ -86,7 +86,7 @@ public:
 	virtual void drawBScanSLOLine  (QPainter&, std::size_t bscanNr, const OctData::CoordSLOpx& start_px, const OctData::CoordSLOpx& end_px   , SLOImageWidget*) const override;
 	virtual void drawBScanSLOCircle(QPainter&, std::size_t bscanNr, const OctData::CoordSLOpx& start_px, const OctData::CoordSLOpx& center_px, bool clockwise, SLOImageWidget*) const override;
 	virtual void drawMarker(QPainter&, BScanMarkerWidget*, const QRect&) const override;
-	virtual bool drawSLOOverlayImage(const cv::Mat& sloImage, cv::Mat& outSloImage, double alpha) const override;
+	virtual bool drawSLOOverlayImage(const cv::Mat& sloImage, cv::Mat& outSloImage, double alpha, const cv::Rect* region = nullptr) const override;
 	virtual bool drawBScan() const                         override { return true;  }
 	
 	virtual RedrawRequest mouseMoveEvent   (QMouseEvent*, BScanMarkerWidget*) override;
@@ -100,6 +100,8 @@ public:
 	virtual void saveState(boost::property_tree::ptree& markerTree)  override;
 	virtual void loadState(boost::property_tree::ptree& markerTree)  override;
 
+	virtual void addMemoryUsage(MemoryUsage& usage) const            override;
+
 	void setActBScan(std::size_t bscan) override;
 	
 	const IntervalMarker* getMarkersList(const MarkerCollectionWork& collection) const
@@ -59,6 +59,9 @@
 
 
 #include <helper/signalblocker.h>
+#include <helper/parallelfor.h>
+#include <helper/tracelog.h>
+#include <helper/memoryusage.h>
 
 const std::array<OctData::Segmentationlines::SegmentlineType, 10> BScanLayerSegmentation::keySeglines = {{
 	  OctData::Segmentationlines::SegmentlineType::RPE
@@ -80,7 +83,7 @@ BScanLayerSegmentation::BScanLayerSegmentation(OctMarkerManager* markerManager)
 , thicknesMapImage(new cv::Mat)
 {
 	name = tr("Layer Segmentation");
-	id   = "LayerSegmentation";
+	id   = BScanLayerSegPTree::markerId;
 	icon = QIcon(":/icons/typicons_mod/layer_seg.svg");
 
 	setSegMethod(SegMethod::Pen);
@@ -142,15 +145,22 @@ void BScanLayerSegmentation::drawMarker(QPainter& painter, BScanMarkerWidget* wi
 		if(highlightLine && acthighlightLineType == type)
 		{
 			painter.setPen(penHighlight);
-			BScanMarkerWidget::paintSegmentationLine(painter, bScanHeight, lines[getActBScanNr()].lines.getSegmentLine(type), scaleFactor);
+			widget->paintSegmentationLine(painter, bScanHeight, lines[getActBScanNr()].lines.getSegmentLine(type), scaleFactor);
 			painter.setPen(penNormal);
 		}
 		else
-			BScanMarkerWidget::paintSegmentationLine(painter, bScanHeight, lines[getActBScanNr()].lines.getSegmentLine(type), scaleFactor);
+			widget->paintSegmentationLine(painter, bScanHeight, lines[getActBScanNr()].lines.getSegmentLine(type), scaleFactor);
 	}
 
 	painter.setPen(penEdit);
-	BScanMarkerWidget::paintSegmentationLine(painter, bScanHeight, tempLine, scaleFactor);
+	// until the navigation settles the edit line and its edit method belong to the previous bscan
+	if(tempLineBScan != getActBScanNr())
+	{
+		widget->paintSegmentationLine(painter, bScanHeight, lines[getActBScanNr()].lines.getSegmentLine(actEditType), scaleFactor);
+		return;
+	}
+
+	widget->paintSegmentationLine(painter, bScanHeight, tempLine, scaleFactor);
 
 
 	if(actEditMethod)
@@ -233,6 +243,10 @@ void BScanLayerSegmentation::resetMarkers(std::size_t bscanNr)
 
 	segData.lines  = bscan->getSegmentLines();
 	segData.filled = true;
+	segData.saved        = false;
+	segData.decoded      = true;
+	segData.storedInTree = false;
+	segData.storedLines.clear();
 
 	for(OctData::Segmentationlines::SegmentlineType type : OctData::Segmentationlines::getSegmentlineTypes())
 	{
@@ -329,7 +343,9 @@ void BScanLayerSegmentation::modifiedSegPart(std::size_t bscan, OctData::Segment
 	if(lines.size() <= bscan)
 		return;
 
+	decodeLines(bscan);
 	lines[bscan].lineModified[static_cast<std::size_t>(segLine)] = true;
+	lines[bscan].saved = false;
 	OctData::Segmentationlines::Segmentline& line = lines[bscan].lines.getSegmentLine(segLine);
 
 	if(line.size() <= start)
@@ -433,10 +449,17 @@ void BScanLayerSegmentation::generateThicknessmap()
 		{
 			double factor = bscan->getScaleFactor().getZ()*1000; // milli meter -> micro meter
 
+			{
+				ScopedTrace trace("decodeAllLines");
+				decodeAllLines();
+			}
+
+			ScopedTrace trace("ThicknessMap::createMap");
 			ThicknessMap tm;
 			tm.createMap(*distMap, lines, thicknessmapConfig.upperLayer, thicknessmapConfig.lowerLayer, factor, *thicknessmapConfig.colormap);
+			const cv::Mat oldThicknessMap = *thicknesMapImage;
 			*thicknesMapImage = tm.getThicknessMap();
-			requestSloOverlayUpdate();
+			reportSloOverlayChange(oldThicknessMap, *thicknesMapImage);
 
 // 			std::cout << "Creating thickness map took " << timer.elapsed() << " milliseconds" << std::endl;
 		}
@@ -446,10 +469,10 @@ void BScanLayerSegmentation::generateThicknessmap()
 }
 
 
-bool BScanLayerSegmentation::drawSLOOverlayImage(const cv::Mat& sloImage, cv::Mat& outSloImage, double alpha) const
+bool BScanLayerSegmentation::drawSLOOverlayImage(const cv::Mat& sloImage, cv::Mat& outSloImage, double alpha, const cv::Rect* region) const
 {
 	if(thicknesMapImage && showThicknessmap)
-		return BscanMarkerBase::drawSLOOverlayImage(sloImage, outSloImage, alpha, *thicknesMapImage);
+		return BscanMarkerBase::drawSLOOverlayImage(sloImage, outSloImage, alpha, *thicknesMapImage, region);
 	return false;
 }
 
@@ -527,6 +550,11 @@ void BScanLayerSegmentation::copySegLinesFromOctDataWhenNotFilled(std::size_t bs
 	}
 }
 
+void BScanLayerSegmentation::previewActBScan(std::size_t bscan)
+{
+	decodeLines(bscan);
+}
+
 void BScanLayerSegmentation::setActBScan(std::size_t bscan)
 {
 	BscanMarkerBase::setActBScan(bscan);
@@ -544,6 +572,42 @@ void BScanLayerSegmentation::loadState(boost::property_tree::ptree& markerTree)
 
 	BscanMarkerBase::loadState(markerTree);
 	BScanLayerSegPTree::parsePTree(markerTree, this);
+	updateEditLine();
+
+	idleDecodePos = 0;
+	startIdleDecoding();
+}
+
+void BScanLayerSegmentation::addMemoryUsage(MemoryUsage& usage) const
+{
+	BscanMarkerBase::addMemoryUsage(usage);
+	const std::string category = "marker " + getMarkerId().toStdString();
+
+	std::size_t lineBytes      = MemoryUsage::bytes(lines);
+	std::size_t numLines       = 0;
+	std::size_t storedBytes    = 0;
+	std::size_t numStored      = 0;
+	for(const BScanSegData& segData : lines)
+	{
+		for(OctData::Segmentationlines::SegmentlineType type : OctData::Segmentationlines::getSegmentlineTypes())
+		{
+			const OctData::Segmentationlines::Segmentline& line = segData.lines.getSegmentLine(type);
+			lineBytes += MemoryUsage::bytes(line);
+			if(!line.empty())
+				++numLines;
+		}
+
+		storedBytes += MemoryUsage::bytes(segData.storedLines);
+		for(const BScanSegData::StoredLine& stored : segData.storedLines)
+			storedBytes += MemoryUsage::bytes(stored.second);
+		numStored += segData.storedLines.size();
+	}
+	usage.add(category, "segmentation lines", lineBytes  , numLines );
+	usage.add(category, "stored lines"      , storedBytes, numStored);
+	usage.add(category, "edit line"         , MemoryUsage::bytes(tempLine));
+
+	if(thicknesMapImage)
+		usage.add(category, "thickness map", MemoryUsage::bytes(*thicknesMapImage));
 }
 
 void BScanLayerSegmentation::saveState(boost::property_tree::ptree& markerTree)
@@ -554,6 +618,7 @@ void BScanLayerSegmentation::saveState(boost::property_tree::ptree& markerTree)
 
 bool BScanLayerSegmentation::saveSegmentation2Bin(const std::string& filename)
 {
+	decodeAllLines();
 	return LayerSegmentationIO::saveSegmentation2Bin(*this, filename);
 }
 
@@ -644,14 +709,51 @@ void BScanLayerSegmentation::updateEditLine()
 	if(lines.size() <= bscanNr)
 		return;
 
+	decodeLines(bscanNr); // drawMarker shows all lines of the actual bscan
 	OctData::Segmentationlines::Segmentline& line = lines[bscanNr].lines.getSegmentLine(actEditType);
-	tempLine = line;
+	tempLine      = line;
+	tempLineBScan = bscanNr;
 
 	if(actEditMethod)
 		actEditMethod->segLineChanged(&tempLine);
 }
 
 
+void BScanLayerSegmentation::decodeLines(std::size_t bscanNr)
+{
+	if(bscanNr < lines.size() && !lines[bscanNr].decoded)
+		BScanLayerSegPTree::decodeLines(this, bscanNr);
+}
+
+void BScanLayerSegmentation::decodeAllLines()
+{
+	std::vector<std::size_t> undecoded;
+	for(std::size_t i = 0; i < lines.size(); ++i)
+		if(!lines[i].decoded)
+			undecoded.push_back(i);
+
+	// every bscan has its own lines, parse them on all cores
+	ParallelFor::run(undecoded.size(), [this, &undecoded](std::size_t i)
+	{
+		BScanLayerSegPTree::decodeLines(this, undecoded[i]);
+	}, 4);
+}
+
+bool BScanLayerSegmentation::decodeIdleStep()
+{
+	const std::size_t batchSize = 16;
+	for(std::size_t decoded = 0; idleDecodePos < lines.size() && decoded < batchSize; ++idleDecodePos)
+	{
+		if(!lines[idleDecodePos].decoded)
+		{
+			BScanLayerSegPTree::decodeLines(this, idleDecodePos);
+			++decoded;
+		}
+	}
+	return idleDecodePos < lines.size();
+}
+
+
 bool BScanLayerSegmentation::hasChangedSinceLastSave() const
 {
 	for(const BScanSegData& data : lines)
@@ -22,6 +22,8 @@
 #include<octdata/datastruct/segmentationlines.h>
 
 #include<array>
+#include<string>
+#include<utility>
 
 #include "../bscanmarkerbase.h"
 
@@ -48,10 +50,16 @@ class BScanLayerSegmentation : public BscanMarkerBase
 public:
 	struct BScanSegData
 	{
+		typedef std::pair<OctData::Segmentationlines::SegmentlineType, std::string> StoredLine;
+
 		OctData::Segmentationlines lines;
 		std::array<bool, std::tuple_size<OctData::Segmentationlines::SegLinesTypeList>::value> lineModified;
 		std::array<bool, std::tuple_size<OctData::Segmentationlines::SegLinesTypeList>::value> lineLoaded;
 		bool filled = false;
+		bool saved  = false; // lines are unchanged since the last fillPTree/parsePTree
+		bool decoded      = true;  // storedLines are parsed into lines on first access
+		bool storedInTree = false; // saved before decoding, the tree holds a copy of storedLines
+		std::vector<StoredLine> storedLines; // values moved out of the marker tree, written back by the next fillPTree
 	};
 
 	class ThicknessmapConfig
@@ -76,7 +84,7 @@ public:
 	~BScanLayerSegmentation();
 
 	virtual void drawMarker(QPainter& painter, BScanMarkerWidget* widget, const QRect& /*drawrect*/) const override;
-	virtual bool drawSLOOverlayImage(const cv::Mat& sloImage, cv::Mat& outSloImage, double alpha) const override;
+	virtual bool drawSLOOverlayImage(const cv::Mat& sloImage, cv::Mat& outSloImage, double alpha, const cv::Rect* region = nullptr) const override;
 
 	virtual RedrawRequest mouseMoveEvent   (QMouseEvent*, BScanMarkerWidget*) override;
 	virtual RedrawRequest mousePressEvent  (QMouseEvent*, BScanMarkerWidget*) override;
@@ -86,7 +94,10 @@ public:
 	virtual void saveState(boost::property_tree::ptree& markerTree)  override;
 	virtual void loadState(boost::property_tree::ptree& markerTree)  override;
 
+	virtual void addMemoryUsage(MemoryUsage& usage) const            override;
+
 
+	virtual void previewActBScan(std::size_t bscan) override;
 	virtual void setActBScan(std::size_t bscan) override;
 	virtual bool hasChangedSinceLastSave() const override;
 
@@ -118,6 +129,7 @@ public:
 
 private:
 	OctData::Segmentationlines::Segmentline tempLine;
+	std::size_t tempLineBScan = 0;                                  // bscan of tempLine
 	std::vector<BScanSegData> lines;
 	OctData::Segmentationlines::SegmentlineType actEditType = OctData::Segmentationlines::SegmentlineType::ILM;
 
@@ -128,6 +140,10 @@ private:
 	void resetMarkers(const OctData::Series* series);
 	void resetMarkers(std::size_t bscanNr);
 
+	std::size_t idleDecodePos = 0;
+	void decodeLines(std::size_t bscanNr);
+	void decodeAllLines();
+
 	QWidget* widgetPtr2WGLayerSeg = nullptr;
 	ThicknessmapLegend*  thicknessMapLegend = nullptr;
 	WidgetOverlayLegend* legendWG = nullptr;
@@ -159,6 +175,10 @@ private:
 	void updateEditLine();
 
 	std::vector<double> getSegPart(const std::vector<double>& segLine, std::size_t ascanBegin, std::size_t ascanEnd);
+
+protected:
+	virtual bool decodeIdleStep() override;
+
 signals:
 	void segMethodChanged();
 	void segLineIdChanged(std::size_t id);
@@ -20,19 +20,19 @@
 
 #include"bscanlayersegmentation.h"
 
-#include<sstream>
 #include<iostream>
+#include<map>
+#include<iterator>
 
 #include <boost/property_tree/ptree.hpp>
 #include <boost/lexical_cast.hpp>
 
 namespace bpt = boost::property_tree;
 
-#include<boost/spirit/include/qi.hpp>
-namespace qi = boost::spirit::qi;
-
 #include<octdata/datastruct/segmentationlines.h>
 #include <helper/ptreehelper.h>
+#include <helper/segmentlinecodec.h>
+#include <data_structure/programoptions.h>
 
 
 
@@ -47,42 +47,89 @@ namespace
 		return true;
 	}
 
-	template<typename T>
-	std::vector<T> fillToVector(const bpt::ptree& pt)
+	void fillFromVector(bpt::ptree& pt, const std::vector<double>& vec, SegmentlineCodec::Encoding encoding)
 	{
-		std::vector<T> r;
-
-		boost::optional<std::string> s = pt.get_value_optional<std::string>();
-		if(s)
-		{
-			std::string::const_iterator f(s->begin()), l(s->end());
-			/*bool ok = */qi::parse(f,l,qi::double_ % ' ',r);
-		}
-	    return r;
+		pt.clear();
+		pt.data() = SegmentlineCodec::encode(vec, encoding);
 	}
 
-	template<typename T>
-	void fillFromVector(bpt::ptree& pt, const std::vector<T>& vec)
+	SegmentlineCodec::Encoding getEncoding()
 	{
-		pt.clear();
+		return ProgramOptions::layerSegSaveLinesFloat32() ? SegmentlineCodec::Encoding::Float32Base64
+		                                                  : SegmentlineCodec::Encoding::Text;
+	}
 
-		std::stringstream sstream;
-		for(const T& val : vec)
-			sstream << val << ' ';
+	// kept lines are encoded again when the encoding option was changed since they were written
+	void reencodeLines(bpt::ptree& bscanNode, SegmentlineCodec::Encoding encoding)
+	{
+		boost::optional<bpt::ptree&> linesNode = bscanNode.get_child_optional("Lines");
+		if(!linesNode)
+			return;
 
-		pt.put_value(sstream.str());
+		for(bpt::ptree::value_type& lineNode : *linesNode)
+		{
+			std::string& data = lineNode.second.data();
+			if(SegmentlineCodec::getEncoding(data) != encoding)
+				data = SegmentlineCodec::encode(SegmentlineCodec::decode(data), encoding);
+		}
 	}
 
 }
 
 
-void BScanLayerSegPTree::fillPTree(boost::property_tree::ptree& ptree, const BScanLayerSegmentation* markerManager)
+const char* const BScanLayerSegPTree::markerId = "LayerSegmentation";
+
+
+void BScanLayerSegPTree::fillPTree(boost::property_tree::ptree& ptree, BScanLayerSegmentation* markerManager)
 {
-	ptree.clear(); // TODO
+	// nodes of unchanged BScans are kept, only changed BScans are written again
+	std::map<std::size_t, bpt::ptree::iterator> bscanNodes;
+	for(bpt::ptree::iterator it = ptree.begin(); it != ptree.end(); ++it)
+		if(it->first == "BScan")
+			bscanNodes[it->second.get<std::size_t>("ID", markerManager->lines.size())] = it;
+
+	const SegmentlineCodec::Encoding encoding = getEncoding();
 
 	std::size_t bscan = 0;
-	for(const BScanLayerSegmentation::BScanSegData& bscanData : markerManager->lines)
+	for(BScanLayerSegmentation::BScanSegData& bscanData : markerManager->lines)
 	{
+		std::map<std::size_t, bpt::ptree::iterator>::iterator nodeIt = bscanNodes.find(bscan);
+
+		if(bscanData.saved)
+		{
+			if(nodeIt == bscanNodes.end() && !bscanData.storedLines.empty())
+			{
+				ptree.add("BScan", "").add("ID", bscan);
+				nodeIt = bscanNodes.emplace(bscan, std::prev(ptree.end())).first;
+			}
+
+			// kept node, the values moved out by parsePTree are put back unchanged (reencodeStored adapts the encoding in the save thread)
+			if(nodeIt != bscanNodes.end() && !bscanData.storedLines.empty() && !bscanData.storedInTree)
+			{
+				bpt::ptree& linesNode = PTreeHelper::get_put(nodeIt->second->second, "Lines");
+				for(BScanLayerSegmentation::BScanSegData::StoredLine& line : bscanData.storedLines)
+				{
+					std::string& data = PTreeHelper::get_put(linesNode, OctData::Segmentationlines::getSegmentlineName(line.first)).data();
+					if(bscanData.decoded)
+						data.swap(line.second);
+					else
+						data = line.second; // still needed for decoding, the copy of the module is dropped in decodeLines
+				}
+
+				if(bscanData.decoded)
+					std::vector<BScanLayerSegmentation::BScanSegData::StoredLine>().swap(bscanData.storedLines);
+				else
+					bscanData.storedInTree = true;
+			}
+			++bscan;
+			continue;
+		}
+
+		if(nodeIt != bscanNodes.end())
+			ptree.erase(nodeIt->second);
+		std::vector<BScanLayerSegmentation::BScanSegData::StoredLine>().swap(bscanData.storedLines); // changed lines are written from the decoded values
+		bscanData.storedInTree = false;
+
 		const OctData::Segmentationlines& lines = bscanData.lines;
 
 		PTreeHelper::NodeCreator bscanNode("BScan", ptree);
@@ -103,24 +150,33 @@ void BScanLayerSegPTree::fillPTree(boost::property_tree::ptree& ptree, const BSc
 			if(!emptySegLine(line))
 			{
 				bpt::ptree& lineNode = PTreeHelper::get_put(linesNode.getNode(), name);
-				fillFromVector(lineNode, line);
+				fillFromVector(lineNode, line, encoding);
 			}
 		}
 
+		bscanData.saved = true;
 		++bscan;
 	}
 }
 
-bool BScanLayerSegPTree::parsePTree(const boost::property_tree::ptree& ptree, BScanLayerSegmentation* markerManager)
+bool BScanLayerSegPTree::parsePTree(boost::property_tree::ptree& ptree, BScanLayerSegmentation* markerManager)
 {
+	// the line values are moved out of the tree and parsed on first access or when idle (decodeLines), fillPTree puts them back
+	for(BScanLayerSegmentation::BScanSegData& bscanData : markerManager->lines)
+	{
+		bscanData.saved        = false;
+		bscanData.decoded      = true;
+		bscanData.storedInTree = false;
+		bscanData.storedLines.clear();
+	}
 
-	for(const std::pair<const std::string, const bpt::ptree>& bscanPair : ptree)
+	for(std::pair<const std::string, bpt::ptree>& bscanPair : ptree)
 	{
 		if(bscanPair.first != "BScan")
 			continue;
 
-		const bpt::ptree& bscanNode = bscanPair.second;
-		boost::optional<const bpt::ptree&> idNode = bscanNode.get_child_optional("ID");
+		bpt::ptree& bscanNode = bscanPair.second;
+		boost::optional<bpt::ptree&> idNode = bscanNode.get_child_optional("ID");
 		if(!idNode)
 			continue;
 
@@ -128,13 +184,14 @@ bool BScanLayerSegPTree::parsePTree(const boost::property_tree::ptree& ptree, BS
 		if(bscanId < 0 || static_cast<std::size_t>(bscanId) >= markerManager->lines.size())
 			continue;
 
-		boost::optional<const bpt::ptree&> linesNode = bscanNode.get_child_optional("Lines");
+		boost::optional<bpt::ptree&> linesNode = bscanNode.get_child_optional("Lines");
 		if(!linesNode)
 			continue;
 
 		BScanLayerSegmentation::BScanSegData& bscanData = markerManager->lines[bscanId];
+		bscanData.saved = true;
 
-		for(const std::pair<const std::string, const bpt::ptree>& segLinesNodePair : *linesNode)
+		for(std::pair<const std::string, bpt::ptree>& segLinesNodePair : *linesNode)
 		{
 			const std::string& name = segLinesNodePair.first;
 
@@ -158,10 +215,32 @@ bool BScanLayerSegPTree::parsePTree(const boost::property_tree::ptree& ptree, BS
 				continue;
 			}
 
-			bscanData.lines.getSegmentLine(actType) = fillToVector<double>(segLinesNodePair.second);
+			bscanData.storedLines.emplace_back(actType, std::string());
+			bscanData.storedLines.back().second.swap(segLinesNodePair.second.data());
+			bscanData.decoded = false;
 			bscanData.lineLoaded[static_cast<std::size_t>(actType)] = true;
 		}
 	}
 
 	return true;
 }
+
+void BScanLayerSegPTree::decodeLines(BScanLayerSegmentation* markerManager, std::size_t bscan)
+{
+	BScanLayerSegmentation::BScanSegData& bscanData = markerManager->lines.at(bscan);
+
+	for(const BScanLayerSegmentation::BScanSegData::StoredLine& line : bscanData.storedLines)
+		bscanData.lines.getSegmentLine(line.first) = SegmentlineCodec::decode(line.second);
+
+	bscanData.decoded = true;
+	if(bscanData.storedInTree)
+		std::vector<BScanLayerSegmentation::BScanSegData::StoredLine>().swap(bscanData.storedLines);
+}
+
+void BScanLayerSegPTree::reencodeStored(boost::property_tree::ptree& ptree)
+{
+	const SegmentlineCodec::Encoding encoding = getEncoding();
+	for(std::pair<const std::string, bpt::ptree>& bscanPair : ptree)
+		if(bscanPair.first == "BScan")
+			reencodeLines(bscanPair.second, encoding);
+}
@@ -19,6 +19,7 @@
 #ifndef BSCANLAYERSEGPTREE_H
 #define BSCANLAYERSEGPTREE_H
 
+#include <cstddef>
 #include <boost/property_tree/ptree_fwd.hpp>
 
 class BScanLayerSegmentation;
@@ -26,8 +27,15 @@ class BScanLayerSegmentation;
 class BScanLayerSegPTree
 {
 public:
-	static bool parsePTree(const boost::property_tree::ptree& ptree,       BScanLayerSegmentation* markerManager);
-	static void fillPTree (      boost::property_tree::ptree& ptree, const BScanLayerSegmentation* markerManager);
+	static bool parsePTree(boost::property_tree::ptree& ptree, BScanLayerSegmentation* markerManager);
+	static void fillPTree (boost::property_tree::ptree& ptree, BScanLayerSegmentation* markerManager);
+
+	static void decodeLines(BScanLayerSegmentation* markerManager, std::size_t bscan);
+
+	// kept nodes are in the encoding of their last save, called in the save thread on a copy of the marker tree
+	static void reencodeStored(boost::property_tree::ptree& ptree);
+
+	static const char* const markerId;
 };
 
 #endif // BSCANLAYERSEGPTREE_H
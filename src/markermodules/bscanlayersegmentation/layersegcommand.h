@@ -46,6 +46,7 @@ public:
 	virtual void apply() override;
 	virtual bool undo()  override;
 	virtual bool redo()  override;
+	virtual std::size_t getMemoryBytes() const override         { return sizeof(*this) + (newPart.capacity() + oldPart.capacity())*sizeof(double); }
 };
 
 #endif // LAYERSEGCOMMAND_H
@@ -23,11 +23,14 @@
 #include <octdata/datastruct/bscan.h>
 
 #include <QToolBar>
+#include <QTimer>
 
 #include<opencv/cv.hpp>
 
 #include <manager/octmarkermanager.h>
+#include <algos/overlayblend.h>
 #include<data_structure/markercommand.h>
+#include<helper/memoryusage.h>
 
 std::size_t BscanMarkerBase::getActBScanNr() const
 {
@@ -104,40 +107,25 @@ bool BscanMarkerBase::setMarkerActive(bool active, BScanMarkerWidget*)
 }
 
 
-namespace
+void BscanMarkerBase::startIdleDecoding()
 {
-	template<int channels>
-	bool drawSLOOverlayImage4Datatype(const cv::Mat& sloImage, cv::Mat& outSloImage, double alpha, const cv::Mat& sloOverlay)
+	if(!idleDecodingTimer)
 	{
-		outSloImage.create(sloImage.size(), CV_8UC3);
-		const std::size_t length = static_cast<std::size_t>(sloImage.cols*sloImage.rows);
-
-		const uint8_t* thi  = sloOverlay .ptr<uint8_t>(0);
-		const uint8_t* src  =    sloImage.ptr<uint8_t>(0);
-		      uint8_t* dest = outSloImage.ptr<uint8_t>(0);
-
-		for(std::size_t i = 0; i<length; ++i)
-		{
-			uint8_t alphaThicknes = thi[3];
-			if(alphaThicknes > 0)
-			{
-				double blend = static_cast<double>(alphaThicknes)/255. * alpha;
-				for(int k = 0; k<3; ++k)
-					dest[k] = static_cast<uint8_t>(src[k % channels]*(1-blend) + thi[k]*blend);
-			}
-			else
-				for(int k = 0; k<3; ++k)
-					dest[k] = src[k % channels];
-
-			thi  += 4;
-			dest += 3;
-			src += channels;
-		}
-		return true;
+		idleDecodingTimer = new QTimer(this);
+		idleDecodingTimer->setInterval(0); // timeout when the event queue is empty
+		connect(idleDecodingTimer, &QTimer::timeout, this, &BscanMarkerBase::idleDecodingStep);
 	}
+	idleDecodingTimer->start();
+}
+
+void BscanMarkerBase::idleDecodingStep()
+{
+	if(!decodeIdleStep())
+		idleDecodingTimer->stop();
 }
 
-bool BscanMarkerBase::drawSLOOverlayImage(const cv::Mat& sloImage, cv::Mat& outSloImage, double alpha, const cv::Mat& sloOverlay) const
+
+bool BscanMarkerBase::drawSLOOverlayImage(const cv::Mat& sloImage, cv::Mat& outSloImage, double alpha, const cv::Mat& sloOverlay, const cv::Rect* region) const
 {
 	if(alpha == -1.)
 	{
@@ -147,27 +135,29 @@ bool BscanMarkerBase::drawSLOOverlayImage(const cv::Mat& sloImage, cv::Mat& outS
 
 	if(sloOverlay.cols == sloImage.cols && sloOverlay.rows == sloImage.rows)
 	{
-		if(sloImage.depth() != cv::DataType<uint8_t>::type || sloOverlay.type() != CV_8UC4)
+		if(sloImage.channels() != 1 && sloImage.channels() != 3)
 		{
-			qDebug("%d != %d || %d != %d", sloImage.depth(), cv::DataType<uint8_t>::type, sloOverlay.type(), CV_8UC4);
+			qDebug("Unsupported number of channels: %d", sloImage.channels());
 			return false;
 		}
-		switch(sloImage.channels())
-		{
-			case 1:
-				drawSLOOverlayImage4Datatype<1>(sloImage, outSloImage, alpha, sloOverlay);
-				return true;
-			case 3:
-				drawSLOOverlayImage4Datatype<3>(sloImage, outSloImage, alpha, sloOverlay);
-				return true;
-			default:
-				qDebug("Unsupported number of channels: %d", sloImage.channels());
-				return false;
-		}
+		return OverlayBlend::blend(sloImage, sloOverlay, outSloImage, alpha, region);
 	}
 	return false;
 }
 
+void BscanMarkerBase::reportSloOverlayChange(const cv::Mat& oldOverlay, const cv::Mat& newOverlay)
+{
+	if(oldOverlay.size() != newOverlay.size() || oldOverlay.type() != newOverlay.type())
+	{
+		requestSloOverlayUpdate();
+		return;
+	}
+
+	const cv::Rect changed = OverlayBlend::changedRegion(oldOverlay, newOverlay);
+	if(changed.area() > 0)
+		requestSloOverlayRegionUpdate(QRect(changed.x, changed.y, changed.width, changed.height));
+}
+
 
 // Undo redo functions
 
@@ -232,6 +222,19 @@ void BscanMarkerBase::clearRedo()
 	redoList.clear();
 }
 
+void BscanMarkerBase::addMemoryUsage(MemoryUsage& usage) const
+{
+	const std::string category = "marker " + getMarkerId().toStdString();
+
+	std::size_t undoBytes = MemoryUsage::bytes(undoList) + MemoryUsage::bytes(redoList);
+	for(const MarkerCommand* command : undoList)
+		undoBytes += command->getMemoryBytes();
+	for(const MarkerCommand* command : redoList)
+		undoBytes += command->getMemoryBytes();
+
+	usage.add(category, "undo/redo steps", undoBytes, undoList.size() + redoList.size());
+}
+
 bool BscanMarkerBase::checkBScan(MarkerCommand* command)
 {
 	int bscan = command->getBScan();
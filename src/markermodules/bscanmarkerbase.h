@@ -22,6 +22,7 @@
 
 #include <QObject>
 #include <QIcon>
+#include <QRect>
 
 #include <boost/property_tree/ptree_fwd.hpp>
 
@@ -34,12 +35,14 @@ class QToolBar;
 class QContextMenuEvent;
 
 class QGraphicsScene;
+class QTimer;
 
 class OctMarkerManager;
 class SLOImageWidget;
 class WidgetOverlayLegend;
 
 class MarkerCommand;
+class MemoryUsage;
 
 
 namespace OctData
@@ -52,6 +55,8 @@ namespace OctData
 namespace cv
 {
 	class Mat;
+	template<typename T> class Rect_;
+	typedef Rect_<int> Rect;
 }
 
 
@@ -77,7 +82,8 @@ public:
 	                                                                {}
 	virtual void drawMarker(QPainter&, BScanMarkerWidget*, const QRect& /*drawrect*/) const    {}
 	virtual bool drawBScan() const                                  { return true;  }
-	virtual bool drawSLOOverlayImage(const cv::Mat& /*sloImage*/, cv::Mat& /*outSloImage*/, double /*alpha*/) const
+	// region: only this part of outSloImage is updated (outSloImage holds the last result)
+	virtual bool drawSLOOverlayImage(const cv::Mat& /*sloImage*/, cv::Mat& /*outSloImage*/, double /*alpha*/, const cv::Rect* /*region*/ = nullptr) const
 	                                                                { return false; }
 	
 	virtual RedrawRequest mouseMoveEvent   (QMouseEvent*, BScanMarkerWidget*) { return RedrawRequest(); }
@@ -90,6 +96,9 @@ public:
 	virtual bool leaveWidgetEvent (QEvent*     , BScanMarkerWidget*) { return false; }
 	virtual bool setMarkerActive  (bool        , BScanMarkerWidget*);
 
+	// called for every shown bscan during navigation, must be cheap
+	virtual void previewActBScan(std::size_t /*bscan*/)             {}
+	// called when the navigation has settled, expensive work (decoding, supporting points, slo maps) belongs here
 	virtual void setActBScan(std::size_t /*bscan*/)                 {}
 	virtual bool hasChangedSinceLastSave() const                    { return false; }
 	
@@ -114,6 +123,9 @@ public:
 	std::size_t numUndoSteps()                                const { return undoList.size(); }
 	std::size_t numRedoSteps()                                const { return redoList.size(); }
 
+	// bytes of the marker state, the base adds the undo and redo stacks, category is "marker <id>"
+	virtual void addMemoryUsage(MemoryUsage& usage) const;
+
 
 	std::size_t getActBScanNr() const;
 
@@ -124,6 +136,7 @@ signals:
 	void enabledToolbar(bool b);
 	void requestFullUpdate();
 	void requestSloOverlayUpdate();
+	void requestSloOverlayRegionUpdate(const QRect& region);      // only region (SLO pixel) of the overlay has changed
 	void sloViewHasChanged();
 	void undoRedoChanged();
 	void requestChangeBscan(int bscan);
@@ -141,10 +154,14 @@ protected:
 	const OctData::BScan * getActBScan() const;
 	const OctData::BScan * getBScan(std::size_t nr) const;
 
-	bool drawSLOOverlayImage(const cv::Mat& sloImage, cv::Mat& outSloImage, double alpha, const cv::Mat& sloOverlay) const;
+	bool drawSLOOverlayImage(const cv::Mat& sloImage, cv::Mat& outSloImage, double alpha, const cv::Mat& sloOverlay, const cv::Rect* region) const;
+	void reportSloOverlayChange(const cv::Mat& oldOverlay, const cv::Mat& newOverlay); // requests an update of the changed region
 
 	void addUndoCommand(MarkerCommand* command);
 	void clearUndoRedo();
+
+	void startIdleDecoding();                                        // calls decodeIdleStep while the event loop has nothing else to do
+	virtual bool decodeIdleStep()                                   { return false; } // decode a part of the lazy loaded state, false when nothing is left
 	
 	QString name;
 	QString id;
@@ -156,7 +173,12 @@ protected:
 	std::vector<MarkerCommand*> redoList;
 
 private:
+	QTimer* idleDecodingTimer = nullptr;
+
 	void clearRedo();
 	bool checkBScan(MarkerCommand* command);
+
+private slots:
+	void idleDecodingStep();
 };
 
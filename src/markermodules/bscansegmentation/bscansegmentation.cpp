@@ -24,6 +24,9 @@
 #include<QDialog>
 #include<QTextEdit>
 
+#include <algorithm>
+#include <thread>
+
 #include <manager/octmarkermanager.h>
 
 #include <widgets/bscanmarkerwidget.h>
@@ -49,6 +52,8 @@
 #include <data_structure/programoptions.h>
 #include "simplemarchingsquare.h"
 #include "freeformsegcommand.h"
+#include <helper/parallelfor.h>
+#include <helper/memoryusage.h>
 
 
 
@@ -57,7 +62,7 @@ BScanSegmentation::BScanSegmentation(OctMarkerManager* markerManager)
 , actMat(new cv::Mat)
 {
 	name = tr("Segmentation marker");
-	id   = "SegmentationMarker";
+	id   = BScanSegmentationPtree::markerId;
 	
 	icon = QIcon(":/icons/typicons_mod/manual_seg.svg");
 
@@ -253,6 +258,10 @@ void BScanSegmentation::drawMarker(QPainter& p, BScanMarkerWidget* widget, const
 	if(factor.getFactorX() <= 0 || factor.getFactorY() <= 0)
 		return;
 
+	// actMat is loaded when the navigation has settled
+	if(actMatNr != getActBScanNr())
+		return;
+
 	if(ProgramOptions::freeFormedSegmetationShowArea())
 		CVImageWidget::drawScaled(areaImage, p, &rect, factor);
 
@@ -607,6 +616,52 @@ void BScanSegmentation::clearSegments()
 		delete mat;
 
 	segments.clear();
+	segmentSaved.clear();
+	storedSegments.clear();
+	segmentUndecoded.clear();
+	segmentDecodeFailed.clear();
+	segmentStoredInTree.clear();
+}
+
+
+void BScanSegmentation::decodeSegment(std::size_t nr)
+{
+	if(nr >= segmentUndecoded.size() || !segmentUndecoded[nr])
+		return;
+
+	segmentDecoded(nr, BScanSegmentationPtree::decodeSegment(storedSegments[nr], *segments.at(nr), nr));
+}
+
+void BScanSegmentation::segmentDecoded(std::size_t nr, bool success)
+{
+	segmentUndecoded[nr] = false;
+	if(!success)
+		segmentDecodeFailed[nr] = true;
+	if(segmentStoredInTree[nr])
+		std::string().swap(storedSegments[nr]);
+}
+
+bool BScanSegmentation::decodeIdleStep()
+{
+	const std::size_t batchSize = std::max(1u, std::thread::hardware_concurrency());
+
+	std::vector<std::size_t> batch;
+	while(idleDecodePos < segmentUndecoded.size() && batch.size() < batchSize)
+	{
+		if(segmentUndecoded[idleDecodePos])
+			batch.push_back(idleDecodePos);
+		++idleDecodePos;
+	}
+
+	std::vector<char> success(batch.size()); // std::vector<bool> is not safe for concurrent writes
+	ParallelFor::run(batch.size(), [this, &batch, &success](std::size_t i)
+	{
+		success[i] = BScanSegmentationPtree::decodeSegment(storedSegments[batch[i]], *segments[batch[i]], batch[i]);
+	});
+	for(std::size_t i = 0; i < batch.size(); ++i)
+		segmentDecoded(batch[i], success[i] != 0);
+
+	return idleDecodePos < segmentUndecoded.size();
 }
 
 void BScanSegmentation::createSegments()
@@ -638,6 +693,11 @@ void BScanSegmentation::createSegments(const OctData::Series* series)
 			mat = new SimpleCvMatCompress;
 		segments.push_back(mat);
 	}
+	segmentSaved.resize(segments.size(), false);
+	storedSegments.resize(segments.size());
+	segmentUndecoded.resize(segments.size(), false);
+	segmentDecodeFailed.resize(segments.size(), false);
+	segmentStoredInTree.resize(segments.size(), false);
 }
 
 
@@ -651,12 +711,44 @@ void BScanSegmentation::newSeriesLoaded(const OctData::Series* series, boost::pr
 	loadState(markerTree);
 }
 
+void BScanSegmentation::addMemoryUsage(MemoryUsage& usage) const
+{
+	BscanMarkerBase::addMemoryUsage(usage);
+	const std::string category = "marker " + getMarkerId().toStdString();
+
+	std::size_t maskBytes = MemoryUsage::bytes(segments);
+	std::size_t numMasks  = 0;
+	for(const SimpleCvMatCompress* mat : segments)
+	{
+		if(!mat)
+			continue;
+		maskBytes += mat->getMemoryBytes();
+		++numMasks;
+	}
+	usage.add(category, "compressed masks", maskBytes, numMasks);
+
+	std::size_t storedBytes = MemoryUsage::bytes(storedSegments);
+	std::size_t numStored   = 0;
+	for(const std::string& archive : storedSegments)
+	{
+		storedBytes += MemoryUsage::bytes(archive);
+		if(!archive.empty())
+			++numStored;
+	}
+	usage.add(category, "stored masks", storedBytes, numStored);
+
+	if(actMat)
+		usage.add(category, "decoded mask", MemoryUsage::bytes(*actMat));
+	usage.add(category, "area image", MemoryUsage::bytes(areaImage));
+}
+
 void BScanSegmentation::saveState(boost::property_tree::ptree& markerTree)
 {
 	BscanMarkerBase::saveState(markerTree);
 
 	createUndoStep();
 	BScanSegmentationPtree::fillPTree(markerTree, this);
+	std::fill(segmentSaved.begin(), segmentSaved.end(), true);
 	stateChangedSinceLastSave = false;
 }
 
@@ -667,6 +759,9 @@ void BScanSegmentation::loadState(boost::property_tree::ptree& markerTree)
 	BScanSegmentationPtree::parsePTree(markerTree, this);
 	setActMat(getActBScanNr(), false);
 	stateChangedSinceLastSave = false;
+
+	idleDecodePos = 0;
+	startIdleDecoding();
 }
 
 
@@ -812,6 +907,7 @@ bool BScanSegmentation::setActMat(std::size_t nr, bool saveOldState)
 
 		if(segments.size() > nr)
 		{
+			decodeSegment(nr);
 			segments[nr]->writeToMat(*actMat); // load state from new bscan
 			actMatNr = nr;
 
@@ -894,6 +990,7 @@ void BScanSegmentation::createUndoStep()
 			addUndoCommand(command);
 
 			*(segments[actMatNr]) = newMat;
+			segmentSaved[actMatNr] = false;
 		}
 	}
 }
@@ -909,6 +1006,7 @@ bool BScanSegmentation::swapActMat(SimpleCvMatCompress& otherMat)
 	otherMat.writeToMat(*actMat);
 
 	*(segments[actMatNr]) = otherMat;
+	segmentSaved[actMatNr] = false;
 
 	std::swap(oldMat, otherMat);
 
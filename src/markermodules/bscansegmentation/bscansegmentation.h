@@ -24,6 +24,7 @@
 #include "configdata.h"
 
 #include <vector>
+#include <string>
 #include <boost/icl/interval_map.hpp>
 
 #include <QPoint>
@@ -83,6 +84,12 @@ class BScanSegmentation : public BscanMarkerBase
 	QWidget* widgetPtr2WGSegmentation = nullptr;
 	
 	SegMats segments;
+	std::vector<bool> segmentSaved; // segment is unchanged since the last fillPTree/parsePTree
+	std::vector<std::string> storedSegments; // archive moved out of the marker tree, written back by the next fillPTree
+	std::vector<bool> segmentUndecoded; // storedSegments is decoded on first access
+	std::vector<bool> segmentDecodeFailed; // the stored archive is kept unchanged on saving
+	std::vector<bool> segmentStoredInTree; // saved before decoding, the tree holds a copy of storedSegments
+	std::size_t idleDecodePos = 0;
 	mutable cv::Mat* actMat = nullptr;
 	mutable std::size_t actMatNr = 0;
 	QImage areaImage;
@@ -93,6 +100,8 @@ class BScanSegmentation : public BscanMarkerBase
 	void clearSegments();
 	void createSegments();
 	void createSegments(const OctData::Series* series);
+	void decodeSegment(std::size_t nr);
+	void segmentDecoded(std::size_t nr, bool success);
 
 	template<typename Painter, typename Transformer>
 	void drawSegmentLine(Painter& painter, Transformer& transform, const ScaleFactor& factor, const QRect& rect) const;
@@ -115,6 +124,9 @@ class BScanSegmentation : public BscanMarkerBase
 
 	QString generateTikzCode() const;
 
+protected:
+	virtual bool decodeIdleStep() override;
+
 public:
 
 	BScanSegmentation(OctMarkerManager* markerManager);
@@ -135,6 +147,8 @@ public:
 	virtual void saveState(boost::property_tree::ptree& markerTree)  override;
 	virtual void loadState(boost::property_tree::ptree& markerTree)  override;
 
+	virtual void addMemoryUsage(MemoryUsage& usage) const            override;
+
 	virtual void setActBScan(std::size_t bscan)  override           { setActMat(bscan, true); }
 	virtual bool hasChangedSinceLastSave() const override           { if(stateChangedSinceLastSave) return true; return hasActMatChanged(); }
 
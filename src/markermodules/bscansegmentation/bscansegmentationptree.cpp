@@ -21,45 +21,59 @@
 #include <iostream>
 
 #include <vector>
+#include <iterator>
+#include <map>
+#include <algorithm>
 
 #include <opencv/cv.h>
 
+#include <QtGlobal>
+
 #include <boost/property_tree/ptree.hpp>
 #include <boost/lexical_cast.hpp>
 namespace bpt = boost::property_tree;
 
-#include <sstream>
-
-#include <boost/archive/text_oarchive.hpp>
-#include <boost/archive/text_iarchive.hpp>
-
-#include <boost/serialization/vector.hpp>
-#include <boost/serialization/string.hpp>
-
-
 #include "bscansegmentation.h"
 
 #include <data_structure/simplecvmatcompress.h>
+#include <data_structure/programoptions.h>
+#include <helper/ptreehelper.h>
+
 
 
+const char* const BScanSegmentationPtree::markerId = "SegmentationMarker";
 
-bool BScanSegmentationPtree::parsePTree(const boost::property_tree::ptree& ptree, BScanSegmentation* markerManager)
+
+bool BScanSegmentationPtree::parsePTree(boost::property_tree::ptree& ptree, BScanSegmentation* markerManager)
 {
 	const char* bscansNodeStr = "ILM";
-	boost::optional<const bpt::ptree&> bscansNode = ptree.get_child_optional(bscansNodeStr);
+	boost::optional<bpt::ptree&> bscansNode = ptree.get_child_optional(bscansNodeStr);
 
 	if(!bscansNode)
 		return false;
 
 
-	for(const std::pair<const std::string, const bpt::ptree>& bscanPair : *bscansNode)
+	std::vector<bool>& segmentSaved = markerManager->segmentSaved;
+	std::fill(segmentSaved.begin(), segmentSaved.end(), false);
+
+	// the archives are moved out of the tree and decoded on first access or when idle (BScanSegmentation::decodeSegment),
+	// fillPTree puts them back
+	const std::size_t numSegments = markerManager->segments.size();
+	std::vector<std::string>& storedSegments = markerManager->storedSegments;
+	storedSegments.clear();
+	storedSegments.resize(numSegments);
+	markerManager->segmentUndecoded   .assign(numSegments, false);
+	markerManager->segmentDecodeFailed.assign(numSegments, false);
+	markerManager->segmentStoredInTree.assign(numSegments, false);
+
+	for(std::pair<const std::string, bpt::ptree>& bscanPair : *bscansNode)
 	{
 		if(bscanPair.first != "BScan")
 			continue;
 
 		try{
-			const bpt::ptree& bscanNode = bscanPair.second;
-			int bscanId                 = bscanNode.get_child("ID").get_value<int>(-1);
+			bpt::ptree& bscanNode = bscanPair.second;
+			int bscanId           = bscanNode.get_child("ID").get_value<int>(-1);
 			if(bscanId == -1)
 				continue;
 
@@ -68,40 +82,102 @@ bool BScanSegmentationPtree::parsePTree(const boost::property_tree::ptree& ptree
 			if(!compressedMat)
 				continue;
 
-			boost::optional<const bpt::ptree&> matCompressNode = bscanNode.get_child_optional("matCompress");
+			boost::optional<bpt::ptree&> matCompressNode = bscanNode.get_child_optional("matCompress");
 			if(matCompressNode)
 			{
-				std::string serializationString = matCompressNode->get_value<std::string>("");
+				std::string& serializationString = matCompressNode->data();
 
 				if(serializationString.size() < 2)
 					continue;
 
-				std::stringstream ioa(serializationString);
-				boost::archive::text_iarchive oa(ioa);
-				oa >> *compressedMat;
-
-// 				compressedMat.writeMat(*map);
+				storedSegments.at(bscanId).swap(serializationString);
+				markerManager->segmentUndecoded.at(bscanId) = true;
+				segmentSaved.at(bscanId) = true;
 			}
 
 
 		}
-		catch(...)
+		catch(const std::exception& e)
 		{
-			// TODO: Error message
+			qWarning("BScanSegmentation: invalid BScan node ignored: %s", e.what());
 		}
 	}
+
 	return true;
 }
 
 
-void BScanSegmentationPtree::fillPTree(boost::property_tree::ptree& markerTree, const BScanSegmentation* markerManager)
+bool BScanSegmentationPtree::decodeSegment(const std::string& serializationString, SimpleCvMatCompress& compressedMat, std::size_t bscan)
 {
-	markerTree.erase("ILM");
-	bpt::ptree& ilmTree = markerTree.put("ILM", std::string());
+	if(compressedMat.fromSerializationString(serializationString))
+		return true;
+
+	qWarning("BScanSegmentation: mask of BScan %u could not be decoded, the stored mask is kept unchanged", static_cast<unsigned>(bscan));
+	return false;
+}
+
+
+void BScanSegmentationPtree::fillPTree(boost::property_tree::ptree& markerTree, BScanSegmentation* markerManager)
+{
+	bpt::ptree& ilmTree = PTreeHelper::get_put(markerTree, "ILM");
+
+	// nodes of unchanged BScans are kept, only changed BScans are serialized again
+	std::map<int, bpt::ptree::iterator> bscanNodes;
+	for(bpt::ptree::iterator it = ilmTree.begin(); it != ilmTree.end(); ++it)
+		if(it->first == "BScan")
+			bscanNodes[it->second.get<int>("ID", -1)] = it;
+
+	const std::vector<bool>& segmentSaved        = markerManager->segmentSaved;
+	const std::vector<bool>& segmentDecodeFailed = markerManager->segmentDecodeFailed;
+
+	const bool compact = ProgramOptions::freeFormedSegmetationSaveCompact();
+	const SimpleMatCompress::SerializationFormat format = compact ? SimpleMatCompress::SerializationFormat::BinaryDeflate
+	                                                              : SimpleMatCompress::SerializationFormat::TextArchive;
 
 	std::size_t numBscans = markerManager->getNumBScans();
 	for(std::size_t bscan = 0; bscan < numBscans; ++bscan)
 	{
+		std::map<int, bpt::ptree::iterator>::iterator nodeIt = bscanNodes.find(static_cast<int>(bscan));
+
+		if(segmentSaved.at(bscan) || segmentDecodeFailed.at(bscan))
+		{
+			if(!segmentSaved.at(bscan))
+				qWarning("BScanSegmentation: changes of BScan %u are not saved, its stored mask could not be decoded", static_cast<unsigned>(bscan));
+
+			std::string& stored = markerManager->storedSegments.at(bscan);
+			if(nodeIt == bscanNodes.end())
+			{
+				if(stored.empty())
+					continue;
+				bpt::ptree& bscanNode = ilmTree.add("BScan", "");
+				bscanNode.add("ID", boost::lexical_cast<std::string>(bscan));
+				nodeIt = bscanNodes.emplace(static_cast<int>(bscan), std::prev(ilmTree.end())).first;
+			}
+
+			// kept node, the archive moved out by parsePTree is put back unchanged (reencodeStored adapts the format in the save thread)
+			if(!stored.empty() && !markerManager->segmentStoredInTree.at(bscan))
+			{
+				bpt::ptree& matCompressNode = PTreeHelper::get_put(nodeIt->second->second, "matCompress");
+				if(markerManager->segmentUndecoded.at(bscan))
+				{
+					// still needed for decoding, the copy of the module is dropped when the mask is decoded
+					matCompressNode.data() = stored;
+					markerManager->segmentStoredInTree.at(bscan) = true;
+				}
+				else
+				{
+					matCompressNode.data().swap(stored);
+					std::string().swap(stored);
+				}
+			}
+			continue;
+		}
+
+		if(nodeIt != bscanNodes.end())
+			ilmTree.erase(nodeIt->second);
+		std::string().swap(markerManager->storedSegments.at(bscan)); // a changed mask is written from the decoded segment
+		markerManager->segmentStoredInTree.at(bscan) = false;
+
 		// const cv::Mat* map = markerManager->segments.at(bscan);
 		const SimpleCvMatCompress* compressedMat = markerManager->segments.at(bscan);
 		if(compressedMat)
@@ -109,16 +185,37 @@ void BScanSegmentationPtree::fillPTree(boost::property_tree::ptree& markerTree,
 			if(compressedMat->isEmpty(BScanSegmentationMarker::paintArea0Value))
 				continue;
 
-			std::stringstream ofs;
-			boost::archive::text_oarchive oa(ofs);
-			// write class instance to archive
-			oa << *compressedMat;
-
 			std::string nodeName = "BScan";
 			bpt::ptree& bscanNode = ilmTree.add(nodeName, "");
 			bscanNode.add("ID", boost::lexical_cast<std::string>(bscan));
-			bscanNode.put("matCompress", ofs.str());
+			bscanNode.put("matCompress", compressedMat->toSerializationString(format));
 		}
 	}
 }
 
+
+void BScanSegmentationPtree::reencodeStored(boost::property_tree::ptree& markerTree)
+{
+	boost::optional<bpt::ptree&> ilmTree = markerTree.get_child_optional("ILM");
+	if(!ilmTree)
+		return;
+
+	const bool compact = ProgramOptions::freeFormedSegmetationSaveCompact();
+	const SimpleMatCompress::SerializationFormat format = compact ? SimpleMatCompress::SerializationFormat::BinaryDeflate
+	                                                              : SimpleMatCompress::SerializationFormat::TextArchive;
+
+	for(std::pair<const std::string, bpt::ptree>& bscanPair : *ilmTree)
+	{
+		if(bscanPair.first != "BScan")
+			continue;
+
+		boost::optional<bpt::ptree&> matCompressNode = bscanPair.second.get_child_optional("matCompress");
+		if(!matCompressNode || SimpleMatCompress::isBinarySerialization(matCompressNode->data()) == compact)
+			continue;
+
+		// masks which can't be decoded are kept unchanged
+		SimpleMatCompress transcoded;
+		if(transcoded.fromSerializationString(matCompressNode->data()))
+			matCompressNode->data() = transcoded.toSerializationString(format);
+	}
+}
@@ -20,15 +20,25 @@
 #define BSCANSEGMENTATIONPTREE_H
 
 
+#include <string>
+#include <cstddef>
 #include <boost/property_tree/ptree_fwd.hpp>
 
 class BScanSegmentation;
+class SimpleCvMatCompress;
 
 class BScanSegmentationPtree
 {
 public:
-	static bool parsePTree(const boost::property_tree::ptree& ptree,       BScanSegmentation* markerManager);
-	static void fillPTree (      boost::property_tree::ptree& ptree, const BScanSegmentation* markerManager);
+	static bool parsePTree(boost::property_tree::ptree& ptree, BScanSegmentation* markerManager);
+	static void fillPTree (boost::property_tree::ptree& ptree, BScanSegmentation* markerManager);
+
+	static bool decodeSegment(const std::string& serializationString, SimpleCvMatCompress& compressedMat, std::size_t bscan);
+
+	// kept nodes are in the format of their last save, called in the save thread on a copy of the marker tree
+	static void reencodeStored(boost::property_tree::ptree& ptree);
+
+	static const char* const markerId;
 };
 
 
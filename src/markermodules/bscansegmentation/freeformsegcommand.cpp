@@ -37,6 +37,11 @@ FreeFormSegCommand::~FreeFormSegCommand()
 	delete segmentationMat;
 }
 
+std::size_t FreeFormSegCommand::getMemoryBytes() const
+{
+	return sizeof(*this) + (segmentationMat ? segmentationMat->getMemoryBytes() : 0);
+}
+
 
 void FreeFormSegCommand::apply()
 {
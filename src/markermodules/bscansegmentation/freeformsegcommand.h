@@ -44,6 +44,7 @@ public:
 	virtual void apply();
 	virtual bool undo();
 	virtual bool redo();
+	virtual std::size_t getMemoryBytes() const;
 };
 
 #endif // FREEFORMSEGCOMMAND_H
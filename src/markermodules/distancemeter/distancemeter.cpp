@@ -192,7 +192,7 @@ void DistanceMeter::newSeriesLoaded(const OctData::Series* s, boost::property_tr
 	resetPositions();
 }
 
-void DistanceMeter::setActBScan(std::size_t bscan)
+void DistanceMeter::previewActBScan(std::size_t bscan)
 {
 	if(series)
 	{
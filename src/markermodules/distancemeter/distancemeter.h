@@ -73,7 +73,7 @@ public:
 	virtual void drawMarker(QPainter&, BScanMarkerWidget*, const QRect&) const override;
 	virtual void newSeriesLoaded(const OctData::Series*, boost::property_tree::ptree&) override;
 
-	virtual void setActBScan(std::size_t bscan) override;
+	virtual void previewActBScan(std::size_t bscan) override;
 
 	bool isSetNewStartPosition() const                              { return setStartPos; }
 
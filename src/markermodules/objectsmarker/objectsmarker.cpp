@@ -32,6 +32,7 @@
 #include <data_structure/scalefactor.h>
 
 #include"widgetobjectmarker.h"
+#include<helper/memoryusage.h>
 
 
 Objectsmarker::Objectsmarker(OctMarkerManager* markerManager)
@@ -93,6 +94,23 @@ void Objectsmarker::saveState(boost::property_tree::ptree& markerTree)
 }
 
 
+void Objectsmarker::addMemoryUsage(MemoryUsage& usage) const
+{
+	BscanMarkerBase::addMemoryUsage(usage);
+
+	// the items of the actual BScan are in the scene, the others in itemsList
+	std::size_t numItems = static_cast<std::size_t>(graphicsScene->items().size());
+	std::size_t bytes    = MemoryUsage::bytes(itemsList);
+	for(const std::vector<RectItem*>& items : itemsList)
+	{
+		bytes    += MemoryUsage::bytes(items);
+		numItems += items.size();
+	}
+	bytes += numItems*MemoryUsage::graphicsItemBytes;
+
+	usage.add("marker " + getMarkerId().toStdString(), "graphics items", bytes, numItems);
+}
+
 void Objectsmarker::removeItems(const QList<QGraphicsItem*>& items)
 {
 	for(QGraphicsItem* item : items)
@@ -147,7 +165,7 @@ void Objectsmarker::resetMarkerObjects(const OctData::Series* series)
 
 
 
-void Objectsmarker::setActBScan(std::size_t bscan)
+void Objectsmarker::previewActBScan(std::size_t bscan)
 {
 	if(bscan == actBScanSceneNr)
 		return;
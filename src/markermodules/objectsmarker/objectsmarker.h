@@ -57,6 +57,8 @@ public:
 	virtual void saveState(boost::property_tree::ptree& markerTree)  override;
 	virtual void loadState(boost::property_tree::ptree& markerTree)  override;
 
+	virtual void addMemoryUsage(MemoryUsage& usage) const            override;
+
 
 	virtual       QGraphicsScene* getGraphicsScene()       override;
 	virtual const QGraphicsScene* getGraphicsScene() const override;
@@ -72,7 +74,7 @@ public:
 // 	virtual void contextMenuEvent (QContextMenuEvent* /*event*/) {}
 
 
-	virtual void setActBScan(std::size_t bscan)  override;
+	virtual void previewActBScan(std::size_t bscan) override;
 	virtual void newSeriesLoaded(const OctData::Series* series, boost::property_tree::ptree& markerTree) override;
 
 private:
@@ -26,6 +26,7 @@
 
 
 class OctMarkerManager;
+class MemoryUsage;
 
 class QToolBar;
 class QGraphicsScene;
@@ -69,6 +70,8 @@ public:
 
 	virtual double getScaleFactor() const                           { return 1000;  }
 
+	virtual void addMemoryUsage(MemoryUsage&) const                 {} // category "marker <id>"
+
 
 	virtual void activate(bool);
 
@@ -23,6 +23,7 @@
 #include <QGraphicsScene>
 
 #include <markerobjects/rectitem.h>
+#include <helper/memoryusage.h>
 
 SloObjectMarker::SloObjectMarker(OctMarkerManager* markerManager)
 : SloMarkerBase(markerManager)
@@ -53,6 +54,14 @@ SloObjectMarker::~SloObjectMarker()
 	delete graphicsScene;
 }
 
+void SloObjectMarker::addMemoryUsage(MemoryUsage& usage) const
+{
+	std::size_t bytes = rectItems.size()*(MemoryUsage::graphicsItemBytes + sizeof(RectItems::value_type));
+	for(const RectItemsTypes& item : rectItems)
+		bytes += item.first.capacity();
+	usage.add("marker " + id.toStdString(), "graphics items", bytes, rectItems.size());
+}
+
 void SloObjectMarker::resetScene()
 {
 	const double scaleFactor = getScaleFactor();
@@ -48,6 +48,8 @@ public:
 	virtual void saveState(boost::property_tree::ptree& markerTree)  override;
 	virtual void loadState(boost::property_tree::ptree& markerTree)  override;
 
+	virtual void addMemoryUsage(MemoryUsage& usage) const            override;
+
 	      RectItem* getRectItem(const std::string& id);
 	const RectItem* getRectItem(const std::string& id) const;
 
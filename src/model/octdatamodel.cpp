@@ -136,6 +136,12 @@ void OctDataModel::setOctData(const OctData::OCT* octData)
 	
 	clearList();
 
+	if(!octData)
+	{
+		endResetModel();
+		return;
+	}
+
 	for(const OctData::OCT::SubstructurePair& patientPair : *octData)
 	{
 		const OctData::Patient* patient = patientPair.second;
@@ -21,9 +21,121 @@
 #include <manager/octdatamanager.h>
 
 #include <QMessageBox>
+#include <QFileInfo>
+#include <QDir>
+#include <QBrush>
+#include <QStandardPaths>
+#include <QCryptographicHash>
+#include <set>
 #include <boost/exception/diagnostic_information.hpp>
 
 
+namespace
+{
+	const QString markedFilter   = "marked";
+	const QString unmarkedFilter = "unmarked";
+	const QString modulePrefix   = "module:";
+	const QString valuePrefix    = "value:";
+
+	std::string getValueToken(const OctMarkerCatalog::ModuleSummary& module, const std::pair<std::string, std::string>& value)
+	{
+		return module.moduleId + '/' + value.first + '=' + value.second;
+	}
+
+	bool matchFilter(const QString& filter, const OctMarkerCatalog::FileEntry* entry)
+	{
+		if(filter.isEmpty())
+			return true;
+
+		const bool marked = entry && entry->hasMarkers();
+		if(filter == markedFilter)
+			return marked;
+		if(filter == unmarkedFilter)
+			return !marked;
+		if(!entry)
+			return false;
+
+		if(filter.startsWith(modulePrefix))
+			return entry->hasModule(filter.mid(modulePrefix.size()).toStdString());
+
+		if(filter.startsWith(valuePrefix))
+		{
+			const std::string token = filter.mid(valuePrefix.size()).toStdString();
+			for(const OctMarkerCatalog::SeriesSummary& series : entry->series)
+				for(const OctMarkerCatalog::ModuleSummary& module : series.modules)
+					for(const std::pair<std::string, std::string>& value : module.values)
+						if(getValueToken(module, value) == token)
+							return true;
+			return false;
+		}
+		return true;
+	}
+
+	QString getToolTip(const QString& filename, const OctMarkerCatalog::FileEntry* entry)
+	{
+		QString text = filename;
+		if(!entry)
+			return text + "\n" + OctFilesModel::tr("no markers");
+		if(entry->readError)
+			return text + "\n" + OctFilesModel::tr("marker file could not be read");
+
+		for(const OctMarkerCatalog::SeriesSummary& series : entry->series)
+		{
+			for(const OctMarkerCatalog::ModuleSummary& module : series.modules)
+			{
+				text += "\n" + QString::fromStdString(module.moduleId);
+				if(module.markedBScans > 0)
+					text += OctFilesModel::tr(": %1 BScans").arg(module.markedBScans);
+				for(const std::pair<std::string, std::string>& value : module.values)
+					text += QString("\n    %1 = %2").arg(QString::fromStdString(value.first)).arg(QString::fromStdString(value.second));
+			}
+		}
+		return text;
+	}
+
+	std::string getCatalogKey(const QString& filename)
+	{
+		return QDir::cleanPath(QFileInfo(filename).absoluteFilePath()).toStdString();
+	}
+
+	// exam directories are often read only or shared, the catalogs are kept in the cache of the user (one file per directory)
+	std::string getCatalogFile(const QString& directory)
+	{
+		const QString cacheDir = QStandardPaths::writableLocation(QStandardPaths::CacheLocation) + "/catalogs";
+		QDir().mkpath(cacheDir);
+
+		const QByteArray key = QCryptographicHash::hash(QString::fromStdString(getCatalogKey(directory)).toUtf8(), QCryptographicHash::Sha1).toHex();
+		return (cacheDir + '/' + QString::fromLatin1(key) + ".catalog").toStdString();
+	}
+}
+
+
+void OctMarkerCatalogThread::run()
+{
+	try
+	{
+		const std::string dir         = directory.toStdString();
+		const std::string catalogFile = getCatalogFile(directory);
+		catalog.load(dir, catalogFile);
+		catalog.update(dir);
+		if(!catalog.save(dir, catalogFile))
+			error = tr("could not write %1").arg(QString::fromStdString(catalogFile));
+	}
+	catch(boost::exception& e)
+	{
+		error = QString::fromStdString(boost::diagnostic_information(e));
+	}
+	catch(std::exception& e)
+	{
+		error = QString::fromStdString(e.what());
+	}
+	catch(...)
+	{
+		error = QString("Unknow error in file %1 line %2").arg(__FILE__).arg(__LINE__);
+	}
+}
+
+
 OctFilesModel::OctFilesModel()
 {
 }
@@ -31,6 +143,12 @@ OctFilesModel::OctFilesModel()
 
 OctFilesModel::~OctFilesModel()
 {
+	if(catalogThread)
+	{
+		catalogThread->wait();
+		delete catalogThread;
+	}
+
 	for(const OctFileUnloaded* file : filelist)
 		delete file;
 }
@@ -44,10 +162,23 @@ QVariant OctFilesModel::data(const QModelIndex& index, int role) const
 	if(static_cast<std::size_t>(index.row()) >= filelist.size())
 		return QVariant();
 
-	if(role == Qt::DisplayRole)
-		return filelist.at(static_cast<std::size_t>(index.row()))->getFilename();
-	else
-		return QVariant();
+	const std::size_t row = static_cast<std::size_t>(index.row());
+	switch(role)
+	{
+		case Qt::DisplayRole:
+			return filelist.at(row)->getFilename();
+		case Qt::ToolTipRole:
+			return getToolTip(filelist.at(row)->getFilename(), getCatalogEntry(row));
+		case Qt::ForegroundRole:
+		{
+			const OctMarkerCatalog::FileEntry* entry = getCatalogEntry(row);
+			if(!entry || !entry->hasMarkers())
+				return QBrush(Qt::gray);
+			return QVariant();
+		}
+		default:
+			return QVariant();
+	}
 }
 
 
@@ -83,17 +214,26 @@ int OctFilesModel::addFile(QString filename)
 	}
 
 	beginInsertRows(QModelIndex(), loadedFilePos, loadedFilePos);
-	filelist.push_back(new OctFileUnloaded(filename));
+	filelist.push_back(new OctFileUnloaded(filename, getCatalogKey(filename)));
 	endInsertRows();
 	
 	return count;
 }
 
+int OctFilesModel::nextVisibleFile(int pos, int step) const
+{
+	const int filesInList = rowCount();
+	for(pos += step; pos >= 0 && pos < filesInList; pos += step)
+		if(isFileVisible(pos))
+			return pos;
+	return -1;
+}
+
+
 void OctFilesModel::loadNextFile()
 {
-	std::size_t filesInList = filelist.size();
-	int requestFilePost = loadedFilePos + 1;
-	if(requestFilePost >= 0 && static_cast<std::size_t>(requestFilePost) < filesInList)
+	int requestFilePost = nextVisibleFile(loadedFilePos, 1);
+	if(requestFilePost >= 0)
 	{
 		openFile(filelist[requestFilePost]->getFilename());
 		loadedFilePos = requestFilePost;
@@ -104,15 +244,144 @@ void OctFilesModel::loadNextFile()
 
 void OctFilesModel::loadPreviousFile()
 {
-	if(loadedFilePos > 0)
+	int requestFilePost = nextVisibleFile(loadedFilePos, -1);
+	if(requestFilePost >= 0)
 	{
-		--loadedFilePos;
+		loadedFilePos = requestFilePost;
 		openFile(filelist[loadedFilePos]->getFilename());
 		fileIdLoaded(index(loadedFilePos));
 	}
 }
 
 
+const OctMarkerCatalog::FileEntry* OctFilesModel::getCatalogEntry(std::size_t row) const
+{
+	if(row >= filelist.size())
+		return nullptr;
+	return catalog.getEntry(filelist[row]->getCatalogKey());
+}
+
+
+bool OctFilesModel::isFileVisible(int row) const
+{
+	if(row < 0)
+		return false;
+	return matchFilter(filter, getCatalogEntry(static_cast<std::size_t>(row)));
+}
+
+
+void OctFilesModel::setFilter(const QString& filter)
+{
+	if(this->filter == filter)
+		return;
+	this->filter = filter;
+	emit(filterChanged());
+}
+
+
+QStringList OctFilesModel::getCatalogFilters() const
+{
+	std::set<QString> modules;
+	std::set<QString> values;
+	for(std::size_t row = 0; row < filelist.size(); ++row)
+	{
+		const OctMarkerCatalog::FileEntry* entry = getCatalogEntry(row);
+		if(!entry)
+			continue;
+
+		for(const OctMarkerCatalog::SeriesSummary& series : entry->series)
+		{
+			for(const OctMarkerCatalog::ModuleSummary& module : series.modules)
+			{
+				modules.insert(modulePrefix + QString::fromStdString(module.moduleId));
+				for(const std::pair<std::string, std::string>& value : module.values)
+					values.insert(valuePrefix + QString::fromStdString(getValueToken(module, value)));
+			}
+		}
+	}
+
+	QStringList result;
+	result << QString() << markedFilter << unmarkedFilter;
+	for(const QString& module : modules)
+		result << module;
+	for(const QString& value : values)
+		result << value;
+	return result;
+}
+
+
+QString OctFilesModel::getFilterDescription(const QString& filter)
+{
+	if(filter.isEmpty())
+		return tr("All files");
+	if(filter == markedFilter)
+		return tr("Files with markers");
+	if(filter == unmarkedFilter)
+		return tr("Files without markers");
+	if(filter.startsWith(modulePrefix))
+		return tr("With %1").arg(filter.mid(modulePrefix.size()));
+	if(filter.startsWith(valuePrefix))
+		return filter.mid(valuePrefix.size());
+	return filter;
+}
+
+
+void OctFilesModel::loadCatalog(const QString& directory)
+{
+	// show the stored state immediately, the update runs in background
+	OctMarkerCatalog storedCatalog;
+	if(storedCatalog.load(directory.toStdString(), getCatalogFile(directory)))
+	{
+		catalog.merge(storedCatalog, directory.toStdString());
+		catalogUpdated();
+	}
+
+	catalogQueue.append(directory);
+	if(!catalogThread)
+		startCatalogThread();
+}
+
+
+void OctFilesModel::startCatalogThread()
+{
+	if(catalogQueue.isEmpty())
+		return;
+
+	catalogThread = new OctMarkerCatalogThread(catalogQueue.takeFirst());
+	connect(catalogThread, &OctMarkerCatalogThread::finished, this, &OctFilesModel::catalogThreadFinished);
+	catalogThread->start();
+}
+
+
+void OctFilesModel::catalogThreadFinished()
+{
+	if(!catalogThread)
+		return;
+
+	if(!catalogThread->getError().isEmpty())
+	{
+		const QString message = tr("catalog of %1: %2").arg(catalogThread->getDirectory()).arg(catalogThread->getError());
+		qWarning("%s", message.toStdString().c_str());
+		emit(catalogError(message));
+	}
+
+	catalog.merge(catalogThread->getCatalog(), catalogThread->getDirectory().toStdString());
+	catalogThread->deleteLater();
+	catalogThread = nullptr;
+
+	catalogUpdated();
+	startCatalogThread();
+}
+
+
+void OctFilesModel::catalogUpdated()
+{
+	if(!filelist.empty())
+		emit(dataChanged(index(0), index(rowCount()-1)));
+	emit(catalogChanged());
+}
+
+
 
 
 
@@ -20,22 +20,48 @@
 
 #include <QVariant>
 #include <QModelIndex>
+#include <QThread>
+#include <QStringList>
 
 #include <QString>
 #include <vector>
 
+#include <manager/octmarkercatalog.h>
+
 
 class OctFileUnloaded
 {
 	QString filename;
+	std::string catalogKey;
 public:
-	OctFileUnloaded(const QString& filename) : filename(filename)   { }
+	OctFileUnloaded(const QString& filename, const std::string& catalogKey) : filename(filename), catalogKey(catalogKey) { }
 	
 	const QString& getFilename()       const                        { return filename; }
+	const std::string& getCatalogKey() const                        { return catalogKey; }
 	bool sameFile(const QString& file) const                        { return filename == file; }
 };
 
 
+class OctMarkerCatalogThread : public QThread
+{
+	Q_OBJECT
+
+	OctMarkerCatalog catalog;
+	const QString    directory;
+	QString          error;
+
+public:
+	explicit OctMarkerCatalogThread(const QString& directory) : directory(directory) {}
+
+	const OctMarkerCatalog& getCatalog()                     const  { return catalog; }
+	const QString& getDirectory()                            const  { return directory; }
+	const QString& getError()                                const  { return error; }
+
+protected:
+	void run();
+};
+
+
 class OctFilesModel : public QAbstractListModel
 {
 	Q_OBJECT
@@ -49,6 +75,16 @@ class OctFilesModel : public QAbstractListModel
 
 	int loadedFilePos = 0;
 
+	OctMarkerCatalog        catalog;
+	OctMarkerCatalogThread* catalogThread = nullptr;
+	QStringList             catalogQueue;
+	QString                 filter;
+
+	const OctMarkerCatalog::FileEntry* getCatalogEntry(std::size_t row) const;
+	void startCatalogThread();
+	void catalogUpdated();
+	int  nextVisibleFile(int pos, int step) const;
+
 public:
 	static OctFilesModel& getInstance()                             { static OctFilesModel instance; return instance;}
 	
@@ -57,9 +93,18 @@ public:
 	                                                                { return static_cast<int>(filelist.size()); }
 	QVariant data(const QModelIndex &index, int role) const override;
 	QVariant headerData(int section, Qt::Orientation orientation, int role = Qt::DisplayRole) const override;
+
+	// filter: empty (all files), "marked", "unmarked", "module:<id>" or "value:<id>/<path>=<value>"
+	bool isFileVisible(int row) const;
+	const QString& getFilter()                               const  { return filter; }
+	QStringList getCatalogFilters() const;                          // general filters and module and value filters of the files in the list
+	static QString getFilterDescription(const QString& filter);
+
+	void loadCatalog(const QString& directory);                     // shows the stored catalog and updates it in background
 	
 
 private slots:
+	void catalogThreadFinished();
 	
 public slots:
 	int  addFile (QString filename);
@@ -71,7 +116,12 @@ public slots:
 	void loadNextFile();
 	void loadPreviousFile();
 
+	void setFilter(const QString& filter);
+
 signals:
 	void fileIdLoaded(QModelIndex index);
+	void filterChanged();
+	void catalogChanged();
+	void catalogError(const QString& message);
 };
 
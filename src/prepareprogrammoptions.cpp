@@ -37,6 +37,9 @@ void PrepareProgrammOptions::prepareProgrammOptions()
 	QAction* autoSaveOctMarkers = ProgramOptions::autoSaveOctMarkers.getAction();
 	autoSaveOctMarkers->setText(tr("Autosave markers"));
 
+	QAction* compressOctMarkers = ProgramOptions::compressOctMarkers.getAction();
+	compressOctMarkers->setText(tr("Compress new marker files (gzip)"));
+
 
 	QAction* fillEpmtyPixelWhite = ProgramOptions::fillEmptyPixelWhite.getAction();
 	QAction* registerBScans      = ProgramOptions::registerBScans     .getAction();
@@ -94,6 +97,9 @@ void PrepareProgrammOptions::prepareProgrammOptions()
 	ProgramOptions::bscanSegmetationLineColor.getColorDialogAction()->setText(tr("change segmentation line color"));
 	ProgramOptions::bscanSegmetationLineColor.getColorDialogAction()->setIcon(QIcon(":/icons/color_wheel.png"));
 
+	ProgramOptions::bscanPrerenderNeighbors.setDescriptions(tr("Prerendered neighbor B-scans"), tr("Number of B-scans before and after the actual B-scan which are prepared in the background"));
+	ProgramOptions::bscanNavigationSettleTime.setDescriptions(tr("Navigation settle time (ms)"), tr("The marker modules are updated when no other B-scan is chosen within this time, 0 updates them immediately"));
+
 
 	ProgramOptions::layerSegFindPointMaxPoints.setDescriptions(tr("Max interpolation points"), tr("max points for spline interpolation"));
 	ProgramOptions::layerSegFindPointMaxAbsError.setDescriptions(tr("max spline interpolation error"), tr("maximal difference for spline interpolation and segmentation line"));
@@ -106,6 +112,7 @@ void PrepareProgrammOptions::prepareProgrammOptions()
 
 	ProgramOptions::layerSegSloMapsAutoUpdate .setDescriptions(tr("Slo maps auto update"), tr("Generate slo maps after bscan change"));
 	ProgramOptions::layerSegHighlightSegLine  .setDescriptions(tr("Highlight segmentation line"), tr("Highlight segmentation line from buttons"));
+	ProgramOptions::layerSegSaveLinesFloat32  .setDescriptions(tr("Save compact segmentation lines"), tr("Save segmentation lines as base64 coded float32 values (smaller files, float precision)"));
 
 	/*
 	 *  Free form segmentation spezific options
@@ -113,5 +120,6 @@ void PrepareProgrammOptions::prepareProgrammOptions()
 
 	ProgramOptions::freeFormedSegmetationShowArea.setDescriptions(tr("color segmentation area"), tr("Fill the area inside from the segmentation"));
 	ProgramOptions::freeFormedSegmetationShowArea.getAction()->setIcon(QIcon(":/icons/typicons/image.svgz"));
+	ProgramOptions::freeFormedSegmetationSaveCompact.setDescriptions(tr("Save compact segmentation"), tr("Save the segmentation as deflated binary runs (not readable by older OCT-Marker versions)"));
 
 }
@@ -36,6 +36,7 @@
 #include<manager/octmarkermanager.h>
 #include<manager/octdatamanager.h>
 #include<manager/paintmarker.h>
+#include<manager/bscanprerenderer.h>
 
 #include<markermodules/bscanmarkerbase.h>
 
@@ -44,6 +45,11 @@
 #include<data_structure/extraseriesdata.h>
 #include<data_structure/conturesegment.h>
 
+#include<imagefilter/filterimage.h>
+#include<helper/painttiming.h>
+#include<helper/tracelog.h>
+#include<helper/memoryusage.h>
+
 
 namespace
 {
@@ -92,6 +98,7 @@ BScanMarkerWidget::BScanMarkerWidget()
 	connect(&octdataManager, &OctDataManager::seriesChanged       , this, &BScanMarkerWidget::cscanLoaded         );
 	connect(&markerManger  , &OctMarkerManager::bscanChanged      , this, &BScanMarkerWidget::imageChanged        );
 	connect(&markerManger  , &OctMarkerManager::bscanMarkerChanged, this, &BScanMarkerWidget::markersMethodChanged);
+	connect(&markerManger  , &OctMarkerManager::bscanSettled      , this, static_cast<void (BScanMarkerWidget::*)(void)>(&BScanMarkerWidget::update));
 
 	connect(this, &BScanMarkerWidget::bscanChangeInkrement, &markerManger, &OctMarkerManager::inkrementBScan);
 
@@ -102,6 +109,10 @@ BScanMarkerWidget::BScanMarkerWidget()
 
 	connect(&ProgramOptions::bscanAspectRatioType            , &OptionInt  ::valueChanged, this, &BScanMarkerWidget::updateAspectRatio     );
 	connect(&ProgramOptions::bscanAutoFitImage               , &OptionBool ::trueSignal  , this, &BScanMarkerWidget::triggerAutoImageFit   );
+	connect(&ProgramOptions::bscanPrerenderNeighbors         , &OptionInt  ::valueChanged, this, &BScanMarkerWidget::requestPrerender      );
+
+	prerenderer = new BScanPrerenderer;
+	connect(prerenderer, &BScanPrerenderer::imagesRendered, this, &BScanMarkerWidget::prerenderedImagesReady);
 
 	setFocusPolicy(Qt::ClickFocus);
 	setMouseTracking(true);
@@ -160,6 +171,7 @@ BScanMarkerWidget::BScanMarkerWidget()
 
 BScanMarkerWidget::~BScanMarkerWidget()
 {
+	delete prerenderer;
 }
 
 
@@ -201,27 +213,12 @@ void BScanMarkerWidget::updateAspectRatio()
 }
 
 
-void BScanMarkerWidget::paintSegmentationLine(QPainter& segPainter, int bScanHeight, const std::vector<double>& segLine, const ScaleFactor& factor)
+void BScanMarkerWidget::paintSegmentationLine(QPainter& segPainter, int bScanHeight, const std::vector<double>& segLine, const ScaleFactor& factor) const
 {
-	double lastEnt = std::numeric_limits<OctData::Segmentationlines::SegmentlineDataType>::quiet_NaN();
-	int xCoord = 0;
-
-	const double factorX = factor.getFactorX();
-	const double factorY = factor.getFactorY();
-
-	for(OctData::Segmentationlines::SegmentlineDataType value : segLine)
-	{
-		// std::cout << value << '\n';
-		if(!std::isnan(lastEnt) && lastEnt < bScanHeight && lastEnt > 0 && value < bScanHeight && value > 0)
-		{
-			segPainter.drawLine(QLineF((xCoord-1)*factorX, lastEnt*factorY, xCoord*factorX, value*factorY));
-		}
-		lastEnt = value;
-		++xCoord;
-	}
+	for(const QPolygonF& polyline : segmentlinePolylines.getPolylines(segLine, bScanHeight, factor))
+		segPainter.drawPolyline(polyline);
 }
 
-
 void BScanMarkerWidget::paintSegmentations(QPainter& segPainter, const ScaleFactor& scaleFactor) const
 {
 	const OctData::BScan* actBScan = markerManger.getActBScan();
@@ -236,7 +233,7 @@ void BScanMarkerWidget::paintSegmentations(QPainter& segPainter, const ScaleFact
 	{
 
 		for(OctData::Segmentationlines::SegmentlineType type : OctData::Segmentationlines::getSegmentlineTypes())
-			BScanMarkerWidget::paintSegmentationLine(segPainter, bScanHeight, actBScan->getSegmentLine(type), scaleFactor);
+			paintSegmentationLine(segPainter, bScanHeight, actBScan->getSegmentLine(type), scaleFactor);
 		/*
 		paintSegmentationLine(segPainter, bScanHeight, actBscan->getSegmentLine(OctData::Segmentationlines::SegmentlineType::ILM  ), scaleFactor);
 		paintSegmentationLine(segPainter, bScanHeight, actBscan->getSegmentLine(OctData::Segmentationlines::SegmentlineType::BM   ), scaleFactor);
@@ -257,6 +254,9 @@ void BScanMarkerWidget::paintSegmentations(QPainter& segPainter, const ScaleFact
 
 void BScanMarkerWidget::paintEvent(QPaintEvent* event)
 {
+	ScopedPaintTimer timer("BScan paint");
+	ScopedTrace      trace("BScan paint");
+
 	CVImageWidget::paintEvent(event);
 
 	
@@ -268,10 +268,15 @@ void BScanMarkerWidget::paintEvent(QPaintEvent* event)
 		return;
 
 	QPainter segPainter(this);
-	paintSegmentations(segPainter, getImageScaleFactor());
+	{
+		ScopedPaintTimer segTimer("BScan segmentation lines");
+		paintSegmentations(segPainter, getImageScaleFactor());
+	}
 	
 	if(paintMarker)
 		paintMarker->paintMarker(event, this);
+
+	TraceLog::getInstance().markFramePainted();
 }
 
 void BScanMarkerWidget::paintConture(QPainter& painter, const std::vector<ContureSegment>& contours) const
@@ -358,9 +363,67 @@ void BScanMarkerWidget::imageChanged()
 
 		showImage(actBScan->getImage());
 		updateAspectRatio();
+		requestPrerender();
 	}
 	else
+	{
+		prerenderer->cancel();
 		update();
+	}
+}
+
+void BScanMarkerWidget::requestPrerender()
+{
+	const FilterImage*     filter    = getImageFilter();
+	const OctData::Series* series    = markerManger.getSeries();
+	const int              neighbors = ProgramOptions::bscanPrerenderNeighbors();
+	if(!filter || !series || neighbors <= 0)
+	{
+		prerenderer->cancel();
+		return;
+	}
+
+	const int actBScan  = markerManger.getActBScanNum();
+	const int numBScans = static_cast<int>(series->bscanCount());
+	if(actBScan != prerenderBScan)
+		prerenderDirection = actBScan > prerenderBScan ? 1 : -1;
+	prerenderBScan = actBScan;
+
+	FilteredImageCache& cache = getFilteredImageCache();
+	cache.setMaxEntries(static_cast<std::size_t>(2*neighbors + 4));
+
+	// the BScans are shown without copy (CVImageWidget::showImage), so the cache finds them by their image data
+	std::vector<std::pair<int, cv::Mat>> images;
+	for(int dist = 1; dist <= neighbors; ++dist)
+	{
+		for(int bscanNr : {actBScan + dist*prerenderDirection, actBScan - dist*prerenderDirection})
+		{
+			if(bscanNr < 0 || bscanNr >= numBScans)
+				continue;
+
+			const OctData::BScan* bscan = series->getBScan(static_cast<std::size_t>(bscanNr));
+			if(!bscan)
+				continue;
+
+			const cv::Mat& image = bscan->getImage();
+			if(image.type() == CV_8UC1 && image.isContinuous() && !cache.contains(*filter, image))
+				images.emplace_back(bscanNr, image);
+		}
+	}
+
+	prerenderer->request(images, *filter);
+}
+
+void BScanMarkerWidget::prerenderedImagesReady()
+{
+	const FilterImage* filter = getImageFilter();
+	if(!filter)
+		return;
+
+	FilteredImageCache& cache = getFilteredImageCache();
+	for(const BScanPrerenderer::Result& result : prerenderer->takeResults())
+		if(result.filterVersion == filter->getParameterVersion())
+			cache.put(*filter, result.source, result.filtered);
 }
 
 void BScanMarkerWidget::leaveEvent(QEvent* event)
@@ -379,6 +442,7 @@ void BScanMarkerWidget::leaveEvent(QEvent* event)
 
 void BScanMarkerWidget::cscanLoaded()
 {
+	ScopedTrace trace("BScanMarkerWidget::cscanLoaded");
 	imageChanged();
 }
 
@@ -426,6 +490,7 @@ void BScanMarkerWidget::wheelEvent(QWheelEvent* wheelE)
 void BScanMarkerWidget::contextMenuEvent(QContextMenuEvent* event)
 {
 	event->ignore();
+	markerManger.settleBScan();
 	BscanMarkerBase* actMarker = markerManger.getActBscanMarker();
 	if(actMarker)
 		actMarker->contextMenuEvent(event);
@@ -447,9 +512,14 @@ void BScanMarkerWidget::mouseMoveEvent(QMouseEvent* event)
 // 	if(checkControlUsed(event))
 // 		return;
 
+	// hover only needs no module update, editing does
+	if(event->buttons() != Qt::NoButton)
+		markerManger.settleBScan();
+
 	BscanMarkerBase* actMarker = markerManger.getActBscanMarker();
 	if(actMarker)
 	{
+		ScopedPaintTimer timer("mouseMoveEvent", actMarker->getMarkerId());
 		BscanMarkerBase::RedrawRequest result = actMarker->mouseMoveEvent(event, this);
 		if(result.redraw)
 		{
@@ -472,10 +542,11 @@ void BScanMarkerWidget::mousePressEvent(QMouseEvent* event)
 	if(checkControlUsed(event))
 		return;
 
-	
+	markerManger.settleBScan();
 	BscanMarkerBase* actMarker = markerManger.getActBscanMarker();
 	if(actMarker)
 	{
+		ScopedPaintTimer timer("mousePressEvent", actMarker->getMarkerId());
 		BscanMarkerBase::RedrawRequest result = actMarker->mousePressEvent(event, this);
 		if(result.redraw)
 		{
@@ -495,10 +566,12 @@ void BScanMarkerWidget::mouseReleaseEvent(QMouseEvent* event)
 
 	if(checkControlUsed(event))
 		return;
-	
+
+	markerManger.settleBScan();
 	BscanMarkerBase* actMarker = markerManger.getActBscanMarker();
 	if(actMarker)
 	{
+		ScopedPaintTimer timer("mouseReleaseEvent", actMarker->getMarkerId());
 		BscanMarkerBase::RedrawRequest result = actMarker->mouseReleaseEvent(event, this);
 		if(result.redraw)
 		{
@@ -528,10 +601,14 @@ void BScanMarkerWidget::keyPressEvent(QKeyEvent* e)
 			e->accept();
 			break;
 		default:
+			markerManger.settleBScan();
 			BscanMarkerBase* actMarker = markerManger.getActBscanMarker();
 			if(actMarker)
+			{
+				ScopedPaintTimer timer("keyPressEvent", actMarker->getMarkerId());
 				if(actMarker->keyPressEvent(e, this))
 					update();
+			}
 			break;
 	}
 }
@@ -718,6 +795,12 @@ void BScanMarkerWidget::setPaintMarker(const PaintMarker* pm)
 		connect(paintMarker, &PaintMarker::viewChanged, this, &BScanMarkerWidget::viewOptionsChangedSlot);
 }
 
+void BScanMarkerWidget::addMemoryUsage(MemoryUsage& usage, const std::string& category) const
+{
+	CVImageWidget::addMemoryUsage(usage, category);
+	usage.add(category, "segmentline polylines", segmentlinePolylines.getMemoryBytes(), segmentlinePolylines.size());
+}
+
 void BScanMarkerWidget::triggerAutoImageFit()
 {
 	if(ProgramOptions::bscanAutoFitImage())
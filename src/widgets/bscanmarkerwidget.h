@@ -20,6 +20,7 @@
 #define BSCANMARKERWIDGET_H
 
 #include "cvimagewidget.h"
+#include "segmentlinepolylinecache.h"
 
 #include <QPoint>
 
@@ -36,6 +37,7 @@ class BscanMarkerBase;
 class ContureSegment;
 
 class PaintMarker;
+class BScanPrerenderer;
 
 class BScanMarkerWidget : public CVImageWidget
 {
@@ -53,6 +55,12 @@ class BScanMarkerWidget : public CVImageWidget
 // 	const OctData::BScan*                   actBscan           = nullptr;
 	const PaintMarker*                      paintMarker        = nullptr;
 
+	BScanPrerenderer*                       prerenderer        = nullptr;
+	int                                     prerenderBScan     = 0;
+	int                                     prerenderDirection = 1;     // direction of the last BScan change, rendered first
+
+	mutable SegmentlinePolylineCache        segmentlinePolylines;
+
 	bool controlUsed = false;
 	double bscanAspectRatio = 1.;
 	void fitAspectRatio();
@@ -82,10 +90,12 @@ public:
 
 	virtual ~BScanMarkerWidget();
 
-	static void paintSegmentationLine(QPainter& segPainter, int bScanHeight, const std::vector<double>& segLine, const ScaleFactor& factor);
+	void paintSegmentationLine(QPainter& segPainter, int bScanHeight, const std::vector<double>& segLine, const ScaleFactor& factor) const;
 
 	void setPaintMarker(const PaintMarker* pm);
 
+	virtual void addMemoryUsage(MemoryUsage& usage, const std::string& category) const override;
+
 protected:
 	virtual void paintEvent(QPaintEvent* event) override;
 	virtual void contextMenuEvent(QContextMenuEvent* event) override;
@@ -118,6 +128,9 @@ private slots:
 
 	void updateAspectRatio();
 
+	void requestPrerender();
+	void prerenderedImagesReady();
+
 public slots:
 	virtual void saveRawImage();
 	virtual void saveRawMat  ();
@@ -22,12 +22,15 @@
 #include <QImageWriter>
 #include <QFileDialog>
 #include <QPainter>
+#include <QTimer>
 
 #include <iostream>
 
 #include <imagefilter/filterimage.h>
+#include <helper/painttiming.h>
 #include <helper/actionclasses.h>
 #include <helper/actionclasses.h>
+#include <helper/memoryusage.h>
 
 CVImageWidget::CVImageWidget(QWidget* parent): QWidget(parent), contextMenu(new QMenu)
 {
@@ -47,6 +50,10 @@ CVImageWidget::CVImageWidget(QWidget* parent): QWidget(parent), contextMenu(new
 
 	contextMenu->addSeparator();
 
+	filterFullImageTimer = new QTimer(this);
+	filterFullImageTimer->setSingleShot(true);
+	filterFullImageTimer->setInterval(150);
+	connect(filterFullImageTimer, &QTimer::timeout, this, static_cast<void(CVImageWidget::*)()>(&CVImageWidget::cvImage2qtImage));
 }
 
 CVImageWidget::~CVImageWidget()
@@ -88,26 +95,38 @@ void CVImageWidget::contextMenuEvent(QContextMenuEvent* event)
 
 void CVImageWidget::showImage(const cv::Mat& image)
 {
+	ScopedPaintTimer timer("image conversion");
+
+	cvImageShared = false;
 	if(image.empty())
 		cvImage = cv::Mat();
 	else
 	{
-		// Convert the image to the RGB888 format
+		// gray images are kept as 8 bit gray (QImage::Format_Grayscale8), color images are converted to RGB888
 		switch(image.type())
 		{
 			case CV_8UC1:
-				// cvtColor(image, cvImage, CV_GRAY2RGB);
-				cvImage = image.clone();
+				if(image.isContinuous())
+				{
+					cvImage       = image;                              // shared, no copy
+					cvImageShared = true;
+				}
+				else
+				{
+					cvImage = conversionBuffers.get(image.rows, image.cols, image.type());
+					image.copyTo(cvImage);
+				}
 				grayCvImage = true;
 				break;
 			case CV_8UC3:
+				cvImage = conversionBuffers.get(image.rows, image.cols, image.type());
 				cvtColor(image, cvImage, CV_BGR2RGB);
 				grayCvImage = false;
 				break;
 			case CV_32FC1:
 			case CV_64FC1:
 			{
-				std::cout << "1 Channels: " << image.channels() << "\tgr: " << image.rows << " x " << image.cols << std::endl;
+				cvImage = conversionBuffers.get(image.rows, image.cols, cv::DataType<uint8_t>::type);
 
 				switch(floatGrayTransform)
 				{
@@ -127,16 +146,7 @@ void CVImageWidget::showImage(const cv::Mat& image)
 						image.convertTo(cvImage, cv::DataType<uint8_t>::type, 255.0, 0);
 						break;
 				}
-
-
-				std::cout << "2 Channels: " << cvImage.channels() << "\tgr: " << cvImage.rows << " x " << cvImage.cols << std::endl;
-
-				if(cvImage.channels() == 1)
-					cv::cvtColor(cvImage, cvImage, CV_GRAY2BGR);
-
-
-				std::cout << "3 Channels: " << cvImage.channels() << "\tgr: " << cvImage.rows << " x " << cvImage.cols << std::endl;
-
+				grayCvImage = true;
 				break;
 			}
 			default:
@@ -150,6 +160,50 @@ void CVImageWidget::showImage(const cv::Mat& image)
 	cvImage2qtImage();
 }
 
+bool CVImageWidget::updateImageRegion(const cv::Mat& image, const cv::Rect& region)
+{
+	// only color images are converted into an own buffer, which can be changed in place
+	if(image.type() != CV_8UC3 || cvImage.type() != CV_8UC3 || image.size() != cvImage.size())
+		return false;
+
+	const cv::Rect imageRegion = region & cv::Rect(0, 0, cvImage.cols, cvImage.rows);
+	if(imageRegion.area() == 0)
+		return true;
+
+	cv::Mat cvImageRegion = cvImage(imageRegion);
+	cv::cvtColor(image(imageRegion), cvImageRegion, CV_BGR2RGB);
+
+	if(imageFilter)
+	{
+		if(outputImage.data == cvImage.data || outputImage.size() != cvImage.size() || outputImage.type() != cvImage.type())
+		{
+			cvImage2qtImage();
+			return true;
+		}
+		imageFilter->applyFilterRegion(cvImage, outputImage, imageRegion);
+	}
+
+	// widget area of the region, qtImage shares the data of outputImage
+	const double factorX = scaleFactor.getFactorX();
+	const double factorY = scaleFactor.getFactorY();
+	const int x1 = static_cast<int>( imageRegion.x                     *factorX) - 1;
+	const int y1 = static_cast<int>( imageRegion.y                     *factorY) - 1;
+	const int x2 = static_cast<int>((imageRegion.x + imageRegion.width )*factorX) + 2;
+	const int y2 = static_cast<int>((imageRegion.y + imageRegion.height)*factorY) + 2;
+	const QRect widgetRect(QPoint(x1, y1), QPoint(x2, y2));
+
+	if(!scaledImageCache.isNull())
+	{
+		QPainter cachePainter(&scaledImageCache);
+		cachePainter.translate(-scaledImageCacheRect.topLeft());
+		cachePainter.setClipRect(widgetRect & scaledImageCacheRect);
+		drawScaled(qtImage, cachePainter, nullptr, scaleFactor);
+	}
+
+	update(widgetRect);
+	return true;
+}
+
 void CVImageWidget::updateScaleFactor()
 {
 	if(imageScale.width() > 0 && imageScale.height() > 0)
@@ -233,6 +287,17 @@ void CVImageWidget::fitImage2ParentWidth()
 }
 
 
+void CVImageWidget::addMemoryUsage(MemoryUsage& usage, const std::string& category) const
+{
+	std::size_t bufferBytes = 0;
+	for(const cv::Mat& buffer : conversionBuffers.getBuffers())
+		bufferBytes += MemoryUsage::bytes(buffer);
+	usage.add(category, "conversion buffers", bufferBytes, conversionBuffers.getBuffers().size());
+	usage.add(category, "filtered images"   , filteredImages.getFilteredBytes(), filteredImages.size());
+	usage.add(category, "scaled image cache", MemoryUsage::bytes(scaledImageCache));
+}
+
+
 void CVImageWidget::cvImage2qtImage(const cv::Mat& cvImage, QImage& qimage)
 {
 	if(cvImage.empty())
@@ -255,6 +320,10 @@ void CVImageWidget::cvImage2qtImage(const cv::Mat& cvImage, QImage& qimage)
 
 void CVImageWidget::cvImage2qtImage()
 {
+	scaledImageCache = QImage();
+	if(filterFullImageTimer)
+		filterFullImageTimer->stop();
+
 	if(cvImage.empty())
 	{
 		qtImage = QImage();
@@ -262,7 +331,23 @@ void CVImageWidget::cvImage2qtImage()
 	}
 
 	if(imageFilter)
-		imageFilter->applyFilter(cvImage, outputImage);
+	{
+		// the filter writes in place if outputImage has the right size and must not write into cvImage
+		if(!cvImageShared)
+		{
+			// converted images are new with every showImage and never found in the cache, a cache entry would only hold the pool buffers
+			ScopedPaintTimer timer("image filter");
+			outputImage = conversionBuffers.get(cvImage.rows, cvImage.cols, cvImage.type());
+			imageFilter->applyFilter(cvImage, outputImage);
+		}
+		else if(!filteredImages.get(*imageFilter, cvImage, outputImage))
+		{
+			ScopedPaintTimer timer("image filter");
+			outputImage = filteredImages.takeBuffer(cvImage.rows, cvImage.cols, cvImage.type());
+			imageFilter->applyFilter(cvImage, outputImage);
+			filteredImages.put(*imageFilter, cvImage, outputImage);
+		}
+	}
 	else
 		outputImage = cvImage;
 
@@ -333,14 +418,67 @@ void CVImageWidget::drawScaled(const QImage& image, QPainter& painter, const QRe
 }
 
 
+QRect CVImageWidget::getCacheRect(const QRect& exposedRect) const
+{
+	const QRect imageRect(0, 0, static_cast<int>(qtImage.width ()*scaleFactor.getFactorX())
+	                          , static_cast<int>(qtImage.height()*scaleFactor.getFactorY()));
+
+	// the visible area with a margin of half its size, so that panning does not need a new cache
+	QRect cacheRect = visibleRegion().boundingRect().united(exposedRect);
+	cacheRect.adjust(-cacheRect.width()/2, -cacheRect.height()/2, cacheRect.width()/2, cacheRect.height()/2);
+	cacheRect &= imageRect;
+
+	const qint64 maxCachePixels = 4096*4096;
+	if(cacheRect.isEmpty() || static_cast<qint64>(cacheRect.width())*cacheRect.height() > maxCachePixels)
+		return QRect();
+	return cacheRect;
+}
+
+bool CVImageWidget::updateScaledImageCache(const QRect& exposedRect)
+{
+	if(!scaledImageCache.isNull() && scaledImageCacheRect.contains(exposedRect))
+		return true;
+
+	ScopedPaintTimer timer("image scaling");
+
+	const QRect cacheRect = getCacheRect(exposedRect);
+	if(cacheRect.isEmpty())
+	{
+		scaledImageCache = QImage();
+		return false;
+	}
+
+	// same scaling as drawScaled, only shifted to the cache origin
+	scaledImageCache = QImage(cacheRect.size(), QImage::Format_RGB32);
+	scaledImageCache.fill(Qt::black);
+	QPainter cachePainter(&scaledImageCache);
+	cachePainter.translate(-cacheRect.topLeft());
+	drawScaled(qtImage, cachePainter, nullptr, scaleFactor);
+	cachePainter.end();
+
+	scaledImageCacheRect = cacheRect;
+	return true;
+}
+
 void CVImageWidget::paintEvent(QPaintEvent* event)
 {
+	ScopedPaintTimer timer("image paint");
+
 	// Display the image
 	QPainter painter(this);
-	if(event)
-		drawScaled(qtImage, painter, &event->rect(), scaleFactor);
-	else
+	if(!event)
 		drawScaled(qtImage, painter, nullptr, scaleFactor);
+	else if(!qtImage.isNull())
+	{
+		const QRect& exposedRect = event->rect();
+		if(updateScaledImageCache(exposedRect))
+		{
+			const QRect blitRect = exposedRect & scaledImageCacheRect;
+			painter.drawImage(blitRect.topLeft(), scaledImageCache, blitRect.translated(-scaledImageCacheRect.topLeft()));
+		}
+		else
+			drawScaled(qtImage, painter, &exposedRect, scaleFactor);
+	}
 
 	painter.end();
 }
@@ -451,7 +589,36 @@ void CVImageWidget::setImageFilter(const FilterImage* imageFilter)
 
 void CVImageWidget::imageParameterChanged()
 {
-	cvImage2qtImage();
+	// while the parameters change (e.g. slider drag) only the visible part is filtered, the full image after a short pause
+	const bool ownOutputImage = !outputImage.empty()
+	                         && outputImage.data   != cvImage.data
+	                         && outputImage.size() == cvImage.size()
+	                         && outputImage.type() == cvImage.type();
+	if(imageFilter && ownOutputImage)
+	{
+		imageFilter->applyFilterRegion(cvImage, outputImage, getVisibleImageRect());
+		scaledImageCache = QImage();
+		update();
+		filterFullImageTimer->start();
+	}
+	else
+		cvImage2qtImage();
+}
+
+cv::Rect CVImageWidget::getVisibleImageRect() const
+{
+	const QRect visibleRect = visibleRegion().boundingRect();
+	const double factorX = scaleFactor.getFactorX();
+	const double factorY = scaleFactor.getFactorY();
+	if(visibleRect.isEmpty() || factorX <= 0 || factorY <= 0)
+		return cv::Rect(0, 0, cvImage.cols, cvImage.rows);
+
+	const int x1 = static_cast<int>(visibleRect.left  ()/factorX) - 1;
+	const int y1 = static_cast<int>(visibleRect.top   ()/factorY) - 1;
+	const int x2 = static_cast<int>((visibleRect.right ()+1)/factorX) + 2;
+	const int y2 = static_cast<int>((visibleRect.bottom()+1)/factorY) + 2;
+
+	return cv::Rect(x1, y1, x2 - x1, y2 - y1) & cv::Rect(0, 0, cvImage.cols, cvImage.rows);
 }
 
 
@@ -26,14 +26,18 @@
 #include <opencv2/opencv.hpp>
 
 #include<data_structure/scalefactor.h>
+#include<helper/matbufferpool.h>
+#include<imagefilter/filteredimagecache.h>
 
 
 // http://develnoter.blogspot.de/2012/05/integrating-opencv-in-qt-gui.html
 
 class QMenu;
+class QTimer;
 class QContextMenuEvent;
 
 class FilterImage;
+class MemoryUsage;
 
 class CVImageWidget : public QWidget
 {
@@ -47,12 +51,22 @@ class CVImageWidget : public QWidget
 	ScaleFactor scaleFactor;
 
 	bool grayCvImage;
+	bool cvImageShared = false;                                     // cvImage is the shown image (no copy), only then the filter cache can find it
 	ScaleMethod scaleMethod = ScaleMethod::Factor;
 	QSize scaledSize;
 
 	const FilterImage* imageFilter = nullptr;
+	FilteredImageCache filteredImages;
+	QTimer*            filterFullImageTimer = nullptr;          // filters the full image after parameter changes of the filter
+
+	// scaled image of the visible area (with margin), paint events only blit from it
+	// invalidated by cvImage2qtImage (new image, filter or zoom)
+	QImage scaledImageCache;
+	QRect  scaledImageCacheRect;
 	
 	void addZoomAction(int zoom);
+	bool updateScaledImageCache(const QRect& exposedRect);
+	cv::Rect getVisibleImageRect() const;
 
 	void updateScaleFactorXY();
 
@@ -86,8 +100,12 @@ public:
 	void setGrayTransformValueB(double val)                     { grayTransformB = val; }
 
 	void setImageFilter(const FilterImage* imageFilter);
+	const FilterImage* getImageFilter() const                   { return imageFilter; }
 
 	static void drawScaled(const QImage& image, QPainter& painter, const QRect* rect, const ScaleFactor& sf);
+
+	// render caches and conversion buffers, the shown image shares its data with them or with the OCT data
+	virtual void addMemoryUsage(MemoryUsage& usage, const std::string& category) const;
 protected:
 	virtual void paintEvent(QPaintEvent* event) override;
 	virtual void wheelEvent(QWheelEvent* event) override;
@@ -97,6 +115,10 @@ protected:
 	cv::Mat  cvImage;
 	cv::Mat  outputImage;
 
+	MatBufferPool conversionBuffers;                                // 8 bit buffers for converted images and their filter results (not cached)
+
+	FilteredImageCache& getFilteredImageCache()                     { return filteredImages; }
+
 	QMenu*   contextMenu;
 	QAction* saveAction;
 	QSize    imageScale;
@@ -107,6 +129,8 @@ protected:
 
 	void cvImage2qtImage();
 	void updateScaleFactor();
+	bool updateImageRegion(const cv::Mat& image, const cv::Rect& region); // image has the size of the shown image, false if a full showImage is needed
+	QRect getCacheRect(const QRect& exposedRect) const;             // area for retained images, empty if too large
 	static void cvImage2qtImage(const cv::Mat& cvImage, QImage& qimage);
 
 	void setZoomInternal(double factor)                          { if(scaleFactorConfig != factor && factor <= 25 && factor > 0) { scaleFactorConfig = factor; updateScaleFactorXY(); zoomChanged(factor); cvImage2qtImage(); } }
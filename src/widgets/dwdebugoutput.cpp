@@ -25,11 +25,13 @@
 #include<QThread>
 #include<QVBoxLayout>
 #include<QDialogButtonBox>
+#include<QPushButton>
 
 #include <QAbstractButton>
 #include <QFileDialog>
 
 #include<helper/qdebugstream.h>
+#include<helper/painttiming.h>
 #include <qcoreapplication.h>
 
 DWDebugOutput::DWDebugOutput(QWidget* parent)
@@ -48,6 +50,14 @@ DWDebugOutput::DWDebugOutput(QWidget* parent)
 	buttonBox = new QDialogButtonBox(this);
 	buttonBox->setStandardButtons(QDialogButtonBox::Reset | QDialogButtonBox::Save);
 
+	// paint timing: measure, print the statistics (p50, p95, max) and save them
+	paintTimingButton       = buttonBox->addButton(tr("measure paint timing"), QDialogButtonBox::ActionRole);
+	paintTimingReportButton = buttonBox->addButton(tr("paint timing")        , QDialogButtonBox::ActionRole);
+	paintTimingSaveButton   = buttonBox->addButton(tr("save paint timing")   , QDialogButtonBox::ActionRole);
+	paintTimingButton->setCheckable(true);
+	paintTimingButton->setChecked(PaintTiming::isEnabled());
+	connect(paintTimingButton, &QPushButton::toggled, this, &DWDebugOutput::enablePaintTiming);
+
 	QVBoxLayout* boxlayout = new QVBoxLayout;
 	boxlayout->addWidget(debugMessages);
 	boxlayout->addWidget(buttonBox);
@@ -126,6 +136,17 @@ void DWDebugOutput::printMessageLocalThread(QString msg)
 
 void DWDebugOutput::clickButtonSlot(QAbstractButton* button)
 {
+	if(button == paintTimingReportButton)
+	{
+		printMessage(tr("paint timing") + '\n' + QString::fromStdString(PaintTiming::getInstance().getReport()));
+		return;
+	}
+	if(button == paintTimingSaveButton)
+	{
+		savePaintTimingAs();
+		return;
+	}
+
 	QDialogButtonBox::StandardButton stdButton = buttonBox->standardButton(button);
 
 	switch(stdButton)
@@ -161,3 +182,19 @@ void DWDebugOutput::saveFileAs()
 	saveFile(filePath);
 }
 
+
+void DWDebugOutput::savePaintTimingAs()
+{
+	QString filePath = QFileDialog::getSaveFileName(this,tr("save paint timing"),QString(),"text files (*.txt)");
+	if(filePath.isEmpty())
+		return;
+	if(!PaintTiming::getInstance().writeReport(filePath.toStdString()))
+		printMessage(tr("can't write paint timing to %1").arg(filePath));
+}
+
+void DWDebugOutput::enablePaintTiming(bool enable)
+{
+	if(enable)
+		PaintTiming::getInstance().reset();
+	PaintTiming::setEnabled(enable);
+}
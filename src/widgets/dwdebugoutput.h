@@ -23,6 +23,7 @@
 
 class QTextEdit;
 class QAbstractButton;
+class QPushButton;
 class QDialogButtonBox;
 
 class Q_DebugStream;
@@ -35,6 +36,9 @@ class DWDebugOutput : public QDockWidget
 	Q_DebugStream* debugStreamCout;
 	Q_DebugStream* debugStreamCerr;
 	QDialogButtonBox* buttonBox;
+	QPushButton*   paintTimingButton;
+	QPushButton*   paintTimingReportButton;
+	QPushButton*   paintTimingSaveButton;
 public:
 	explicit DWDebugOutput(QWidget* parent = nullptr);
 	virtual ~DWDebugOutput();
@@ -43,6 +47,7 @@ public:
 protected:
 	void saveFile(const QString& filename);
 	void saveFileAs();
+	void savePaintTimingAs();
 
 signals:
 	void messageFromOtherThread(QString msg);
@@ -55,6 +60,7 @@ private slots:
 	void printMessageLocalThread(QString msg);
 
 	void clickButtonSlot(QAbstractButton* button);
+	void enablePaintTiming(bool enable);
 
 };
 
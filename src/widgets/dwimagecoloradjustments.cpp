@@ -21,12 +21,16 @@
 #include <QSlider>
 
 #include <imagefilter/filtergammacontrastbrightness.h>
+#include <imagefilter/filterpipeline.h>
 #include <QFormLayout>
 
 DWImageColorAdjustments::DWImageColorAdjustments(QWidget* parent)
 : QDockWidget(parent)
-, imageFilter(new FilterGammaContrastBrightness)
+, imageFilter(new FilterPipeline)
+, gammaContrastBrightnessFilter(new FilterGammaContrastBrightness)
 {
+	imageFilter->addFilter(gammaContrastBrightnessFilter);
+
 	setWindowTitle(tr("image color adjustments"));
 
 	QWidget* widget  = new QWidget(this);
@@ -68,6 +72,7 @@ DWImageColorAdjustments::DWImageColorAdjustments(QWidget* parent)
 DWImageColorAdjustments::~DWImageColorAdjustments()
 {
 	delete imageFilter;
+	delete gammaContrastBrightnessFilter;
 }
 
 
@@ -85,5 +90,5 @@ void DWImageColorAdjustments::parameterChanged()
 	para.contrast   =  static_cast<double>(contrastSlider  ->value())/100.;
 	para.brightness =  static_cast<double>(brightnessSlider->value())/100.;
 
-	imageFilter->setParameter(para);
+	gammaContrastBrightnessFilter->setParameter(para);
 }
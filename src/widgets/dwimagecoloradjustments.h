@@ -24,12 +24,14 @@
 class QSlider;
 class FilterImage;
 class FilterGammaContrastBrightness;
+class FilterPipeline;
 
 class DWImageColorAdjustments : public QDockWidget
 {
 	Q_OBJECT
 
-	FilterGammaContrastBrightness* imageFilter;
+	FilterPipeline*                imageFilter;
+	FilterGammaContrastBrightness* gammaContrastBrightnessFilter;
 
 	QSlider* gammaSlider      = nullptr;
 	QSlider* contrastSlider   = nullptr;
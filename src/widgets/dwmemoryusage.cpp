@@ -0,0 +1,126 @@
+/*
+ * Copyright (c) 2018 Kay Gawlik <kaydev@amarunet.de> <kay.gawlik@beuth-hochschule.de> <kay.gawlik@charite.de>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+#include "dwmemoryusage.h"
+
+#include<QTextEdit>
+#include<QTimer>
+#include<QVBoxLayout>
+#include<QDialogButtonBox>
+#include<QPushButton>
+#include<QAbstractButton>
+#include<QFileDialog>
+#include<QFontDatabase>
+
+#include<helper/memoryusage.h>
+#include<manager/octdatamanager.h>
+#include<manager/octmarkermanager.h>
+#include<markermodules/bscanmarkerbase.h>
+#include<markermodules/slomarkerbase.h>
+#include<widgets/cvimagewidget.h>
+
+DWMemoryUsage::DWMemoryUsage(QWidget* parent)
+: QDockWidget(parent)
+, reportText(new QTextEdit(this))
+, refreshTimer(new QTimer(this))
+{
+	setWindowTitle(tr("Memory usage"));
+
+	reportText->setReadOnly(true);
+	reportText->setUndoRedoEnabled(false);
+	reportText->setAcceptRichText(false);
+	reportText->setLineWrapMode(QTextEdit::NoWrap);
+	reportText->setFont(QFontDatabase::systemFont(QFontDatabase::FixedFont));
+
+	buttonBox = new QDialogButtonBox(this);
+	buttonBox->setStandardButtons(QDialogButtonBox::Save);
+	refreshButton = buttonBox->addButton(tr("refresh"), QDialogButtonBox::ActionRole);
+
+	QVBoxLayout* boxlayout = new QVBoxLayout;
+	boxlayout->addWidget(reportText);
+	boxlayout->addWidget(buttonBox);
+
+	QWidget* newWidget = new QWidget(this);
+	newWidget->setLayout(boxlayout);
+	setWidget(newWidget);
+
+	refreshTimer->setInterval(2000);
+	connect(refreshTimer, &QTimer::timeout                 , this, &DWMemoryUsage::refresh);
+	connect(buttonBox   , &QDialogButtonBox::clicked       , this, &DWMemoryUsage::clickButtonSlot);
+	connect(this        , &QDockWidget::visibilityChanged  , this, &DWMemoryUsage::visibilityChangedSlot);
+}
+
+
+void DWMemoryUsage::collect(MemoryUsage& usage) const
+{
+	OctDataManager::getInstance().addMemoryUsage(usage);
+
+	const OctMarkerManager& markerManager = OctMarkerManager::getInstance();
+	for(const BscanMarkerBase* marker : markerManager.getBscanMarker())
+		marker->addMemoryUsage(usage);
+	for(const SloMarkerBase* marker : markerManager.getSloMarker())
+		marker->addMemoryUsage(usage);
+
+	for(const std::pair<const CVImageWidget*, std::string>& widget : imageWidgets)
+		widget.first->addMemoryUsage(usage, widget.second);
+}
+
+bool DWMemoryUsage::writeReport(const std::string& filename) const
+{
+	MemoryUsage usage;
+	collect(usage);
+	return usage.writeReport(filename);
+}
+
+
+void DWMemoryUsage::refresh()
+{
+	MemoryUsage usage;
+	collect(usage);
+	reportText->setPlainText(QString::fromStdString(usage.getReport()));
+}
+
+void DWMemoryUsage::visibilityChangedSlot(bool visible)
+{
+	if(visible)
+	{
+		refresh();
+		refreshTimer->start();
+	}
+	else
+		refreshTimer->stop();
+}
+
+void DWMemoryUsage::clickButtonSlot(QAbstractButton* button)
+{
+	if(button == refreshButton)
+	{
+		refresh();
+		return;
+	}
+
+	if(buttonBox->standardButton(button) == QDialogButtonBox::Save)
+		saveReportAs();
+}
+
+void DWMemoryUsage::saveReportAs()
+{
+	QString filePath = QFileDialog::getSaveFileName(this,tr("save memory usage"),QString(),"text files (*.txt)");
+	if(filePath.isEmpty())
+		return;
+	writeReport(filePath.toStdString());
+}
@@ -0,0 +1,68 @@
+/*
+ * Copyright (c) 2018 Kay Gawlik <kaydev@amarunet.de> <kay.gawlik@beuth-hochschule.de> <kay.gawlik@charite.de>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+#ifndef DWMEMORYUSAGE_H
+#define DWMEMORYUSAGE_H
+
+#include<QDockWidget>
+
+#include<string>
+#include<vector>
+#include<utility>
+
+class QTextEdit;
+class QTimer;
+class QAbstractButton;
+class QPushButton;
+class QDialogButtonBox;
+
+class CVImageWidget;
+class MemoryUsage;
+
+// bytes held by the OCT data, the marker modules and the render caches of the image widgets
+// refreshed periodically while the dock is visible
+class DWMemoryUsage : public QDockWidget
+{
+	Q_OBJECT
+
+	QTextEdit*        reportText;
+	QDialogButtonBox* buttonBox;
+	QPushButton*      refreshButton;
+	QTimer*           refreshTimer;
+
+	std::vector<std::pair<const CVImageWidget*, std::string>> imageWidgets;
+public:
+	explicit DWMemoryUsage(QWidget* parent = nullptr);
+
+	void addImageWidget(const CVImageWidget* widget, const std::string& name)
+	                                                                { imageWidgets.emplace_back(widget, name); }
+
+	void collect(MemoryUsage& usage) const;
+	bool writeReport(const std::string& filename) const;
+
+public slots:
+	void refresh();
+
+private slots:
+	void clickButtonSlot(QAbstractButton* button);
+	void visibilityChangedSlot(bool visible);
+
+protected:
+	void saveReportAs();
+};
+
+#endif // DWMEMORYUSAGE_H
@@ -0,0 +1,51 @@
+/*
+ * Copyright (c) 2018 Kay Gawlik <kaydev@amarunet.de> <kay.gawlik@beuth-hochschule.de> <kay.gawlik@charite.de>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+#include "paintlayer.h"
+
+#include <QPainter>
+
+
+void PaintLayer::paint(QPainter& painter, const QRect& exposedRect, const QRect& cacheRect, const PaintFunction& paintFunction)
+{
+	if(!valid || !imageRect.contains(exposedRect))
+	{
+		if(!cacheRect.contains(exposedRect))
+		{
+			clear();
+			painter.save();
+			paintFunction(painter);
+			painter.restore();
+			return;
+		}
+
+		if(image.size() != cacheRect.size())
+			image = QImage(cacheRect.size(), QImage::Format_ARGB32_Premultiplied);
+		image.fill(Qt::transparent);
+
+		QPainter layerPainter(&image);
+		layerPainter.translate(-cacheRect.topLeft());
+		paintFunction(layerPainter);
+		layerPainter.end();
+
+		imageRect = cacheRect;
+		valid     = true;
+	}
+
+	const QRect blitRect = exposedRect & imageRect;
+	painter.drawImage(blitRect.topLeft(), image, blitRect.translated(-imageRect.topLeft()));
+}
@@ -0,0 +1,45 @@
+/*
+ * Copyright (c) 2018 Kay Gawlik <kaydev@amarunet.de> <kay.gawlik@beuth-hochschule.de> <kay.gawlik@charite.de>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+#pragma once
+
+#include <functional>
+
+#include <QImage>
+#include <QRect>
+
+class QPainter;
+
+// retained drawing of one layer of a widget on a transparent image
+// the paint function is only called after invalidate() or if the exposed area is outside of the cached area
+class PaintLayer
+{
+	QImage image;
+	QRect  imageRect;
+	bool   valid = false;
+
+public:
+	typedef std::function<void(QPainter&)> PaintFunction;
+
+	void invalidate()                                               { valid = false; }
+	void clear()                                                    { image = QImage(); valid = false; }
+	bool isValid() const                                            { return valid; }
+	const QImage& getImage() const                                  { return image; }
+
+	// cacheRect: widget area for a new image (empty: draw directly without caching)
+	void paint(QPainter& painter, const QRect& exposedRect, const QRect& cacheRect, const PaintFunction& paintFunction);
+};
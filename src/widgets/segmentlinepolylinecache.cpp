@@ -0,0 +1,177 @@
+/*
+ * Copyright (c) 2018 Kay Gawlik <kaydev@amarunet.de> <kay.gawlik@beuth-hochschule.de> <kay.gawlik@charite.de>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+#include "segmentlinepolylinecache.h"
+
+#include <cmath>
+#include <algorithm>
+
+#include <data_structure/scalefactor.h>
+
+
+namespace
+{
+	// collects the points of one A-scan bucket (pixel column) and appends the first, min, max and last point in x order
+	class BucketDecimator
+	{
+		QPolygonF& polyline;
+		int    bucket = -1;
+		int    firstX = 0, minX = 0, maxX = 0, lastX = 0;
+		double firstY = 0, minY = 0, maxY = 0, lastY = 0;
+
+		void appendPoint(int x, double y, int& lastAppendedX)
+		{
+			if(x == lastAppendedX)
+				return;
+			polyline.append(QPointF(x, y));
+			lastAppendedX = x;
+		}
+
+	public:
+		explicit BucketDecimator(QPolygonF& polyline) : polyline(polyline) {}
+
+		void add(int x, double y, int bucketNr)
+		{
+			if(bucketNr != bucket)
+			{
+				flush();
+				bucket = bucketNr;
+				firstX = minX = maxX = lastX = x;
+				firstY = minY = maxY = lastY = y;
+				return;
+			}
+			if(y < minY) { minY = y; minX = x; }
+			if(y > maxY) { maxY = y; maxX = x; }
+			lastX = x;
+			lastY = y;
+		}
+
+		void flush()
+		{
+			if(bucket < 0)
+				return;
+
+			int lastAppendedX = -1;
+			appendPoint(firstX, firstY, lastAppendedX);
+			if(minX < maxX)
+			{
+				appendPoint(minX, minY, lastAppendedX);
+				appendPoint(maxX, maxY, lastAppendedX);
+			}
+			else
+			{
+				appendPoint(maxX, maxY, lastAppendedX);
+				appendPoint(minX, minY, lastAppendedX);
+			}
+			appendPoint(lastX, lastY, lastAppendedX);
+			bucket = -1;
+		}
+	};
+
+	bool validValue(double value, int bScanHeight)
+	{
+		return !std::isnan(value) && value < bScanHeight && value > 0;
+	}
+}
+
+
+std::size_t SegmentlinePolylineCache::getMemoryBytes() const
+{
+	std::size_t bytes = 0;
+	for(const Entry& entry : entries)
+	{
+		bytes += sizeof(Entry) + entry.values.capacity()*sizeof(double) + entry.polylines.capacity()*sizeof(QPolygonF);
+		for(const QPolygonF& polyline : entry.polylines)
+			bytes += static_cast<std::size_t>(polyline.capacity())*sizeof(QPointF);
+	}
+	return bytes;
+}
+
+
+void SegmentlinePolylineCache::createPolylines(const std::vector<double>& segLine, int bScanHeight, double factorX, double factorY, Polylines& polylines)
+{
+	polylines.clear();
+
+	// A-scans per pixel column
+	const double bucketFactor = std::min(factorX, 1.);
+
+	const std::size_t length = segLine.size();
+	std::size_t pos = 0;
+	while(pos < length)
+	{
+		// next run of valid values, a single valid value is not drawn
+		while(pos < length && !validValue(segLine[pos], bScanHeight))
+			++pos;
+		const std::size_t runStart = pos;
+		while(pos < length && validValue(segLine[pos], bScanHeight))
+			++pos;
+		if(pos - runStart < 2)
+			continue;
+
+		polylines.push_back(QPolygonF());
+		QPolygonF& polyline = polylines.back();
+
+		BucketDecimator decimator(polyline);
+		for(std::size_t x = runStart; x < pos; ++x)
+			decimator.add(static_cast<int>(x), segLine[x], static_cast<int>(static_cast<double>(x)*bucketFactor));
+		decimator.flush();
+
+		for(QPointF& p : polyline)
+		{
+			p.setX(p.x()*factorX);
+			p.setY(p.y()*factorY);
+		}
+	}
+}
+
+
+const SegmentlinePolylineCache::Polylines& SegmentlinePolylineCache::getPolylines(const std::vector<double>& segLine, int bScanHeight, const ScaleFactor& factor)
+{
+	const double factorX = factor.getFactorX();
+	const double factorY = factor.getFactorY();
+
+	for(std::list<Entry>::iterator it = entries.begin(); it != entries.end(); ++it)
+	{
+		if(it->source != segLine.data())
+			continue;
+
+		if(it->bScanHeight != bScanHeight || it->factorX != factorX || it->factorY != factorY || it->values != segLine)
+		{
+			it->values      = segLine;
+			it->bScanHeight = bScanHeight;
+			it->factorX     = factorX;
+			it->factorY     = factorY;
+			createPolylines(segLine, bScanHeight, factorX, factorY, it->polylines);
+		}
+		entries.splice(entries.begin(), entries, it);
+		return entries.front().polylines;
+	}
+
+	entries.push_front(Entry());
+	Entry& entry = entries.front();
+	entry.source      = segLine.data();
+	entry.values      = segLine;
+	entry.bScanHeight = bScanHeight;
+	entry.factorX     = factorX;
+	entry.factorY     = factorY;
+	createPolylines(segLine, bScanHeight, factorX, factorY, entry.polylines);
+
+	while(entries.size() > maxEntries && entries.size() > 1)
+		entries.pop_back();
+
+	return entry.polylines;
+}
@@ -0,0 +1,60 @@
+/*
+ * Copyright (c) 2018 Kay Gawlik <kaydev@amarunet.de> <kay.gawlik@beuth-hochschule.de> <kay.gawlik@charite.de>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+#pragma once
+
+#include <list>
+#include <vector>
+#include <cstddef>
+
+#include <QPolygonF>
+
+class ScaleFactor;
+
+// widget coordinates of segmentation lines as polylines for drawPolyline
+// invalid values (NaN, outside of the BScan) split the line, for zoom factors < 1 every pixel column
+// keeps only the first, the extreme and the last points
+// an entry is reused as long as the values, the BScan height and the scale factor are unchanged
+class SegmentlinePolylineCache
+{
+public:
+	typedef std::vector<QPolygonF> Polylines;
+
+	explicit SegmentlinePolylineCache(std::size_t maxEntries = 64) : maxEntries(maxEntries) {}
+
+	const Polylines& getPolylines(const std::vector<double>& segLine, int bScanHeight, const ScaleFactor& factor);
+	void clear()                                                    { entries.clear(); }
+
+	std::size_t size() const                                        { return entries.size(); }
+	std::size_t getMemoryBytes() const;
+
+	static void createPolylines(const std::vector<double>& segLine, int bScanHeight, double factorX, double factorY, Polylines& polylines);
+
+private:
+	struct Entry
+	{
+		const double*       source = nullptr;                       // identifies the line (e.g. of one BScan)
+		std::vector<double> values;
+		int                 bScanHeight = 0;
+		double              factorX     = 0;
+		double              factorY     = 0;
+		Polylines           polylines;
+	};
+
+	std::list<Entry> entries;                                       // most recently used first
+	std::size_t      maxEntries;
+};
@@ -41,6 +41,9 @@
 #include<data_structure/rect2d.h>
 
 #include<helper/slocoordtranslator.h>
+#include<helper/painttiming.h>
+#include<helper/tracelog.h>
+#include<helper/memoryusage.h>
 
 #include <QGraphicsView>
 #include <QGraphicsTextItem>
@@ -86,7 +89,9 @@ SLOImageWidget::SLOImageWidget(QWidget* parent)
 	connect(&markerManger  , &OctMarkerManager::sloViewChanged    , this, &SLOImageWidget::sloViewChanged          );
 	connect(&markerManger  , &OctMarkerManager::sloMarkerChanged  , this, &SLOImageWidget::sloMarkerChanged        );
 	connect(&markerManger  , &OctMarkerManager::sloOverlayChanged , this, &SLOImageWidget::updateMarkerOverlayImage);
+	connect(&markerManger  , &OctMarkerManager::sloOverlayRegionChanged, this, &SLOImageWidget::updateMarkerOverlayRegion);
 	connect(&markerManger  , &OctMarkerManager::bscanMarkerChanged, this, &SLOImageWidget::updateMarkerOverlayImage);
+	connect(&markerManger  , &OctMarkerManager::bscanMarkerChanged, this, &SLOImageWidget::bscanMarkerChanged      );
 
 	connect(&ProgramOptions::sloShowsBScansPos, &OptionInt   ::valueChanged, this, &SLOImageWidget::setBScanVisibility);
 	connect(&ProgramOptions::sloShowGrid      , &OptionBool  ::valueChanged, this, static_cast<void (SLOImageWidget::*)(void)>(&SLOImageWidget::update));
@@ -128,22 +133,63 @@ SLOImageWidget::~SLOImageWidget()
 
 void SLOImageWidget::paintEvent(QPaintEvent* event)
 {
+	ScopedPaintTimer timer("SLO paint");
+	ScopedTrace      trace("SLO paint");
+
 	CVImageWidget::paintEvent(event);
 
 	const OctData::Series* series = OctDataManager::getInstance().getSeries();
 	if(!series)
 		return;
 
+	// the layers are drawn in widget coordinates, a new scale or clip invalidates all of them
+	LayerGeometry actGeometry;
+	actGeometry.factorX = getImageScaleFactor().getFactorX();
+	actGeometry.factorY = getImageScaleFactor().getFactorY();
+	actGeometry.clipX   = clipX1;
+	actGeometry.clipY   = clipY1;
+	if(!(actGeometry == layerGeometry))
+	{
+		layerGeometry = actGeometry;
+		invalidateLayers();
+	}
+
 	QPainter painter(this);
-	if(drawConvexHull)
-		paintConvexHull(painter, series);
+	const QRect exposedRect = event ? event->rect() : rect();
+	const QRect cacheRect   = getCacheRect(exposedRect);
+
+	if(drawConvexHull || drawBScans)
+		bscanGeometryLayer.paint(painter, exposedRect, cacheRect, [this, series](QPainter& p)
+		{
+			ScopedPaintTimer layerTimer("SLO BScan geometry layer");
+			if(drawConvexHull)
+				paintConvexHull(p, series);
+			if(drawBScans)
+				paintBScans(p, series, BScanPaintPart::Geometry);
+		});
 
 	if(drawBScans)
-		paintBScans(painter, series);
+	{
+		BscanMarkerBase* actMarker = markerManger.getActBscanMarker();
+		if(actMarker && actMarker->drawingBScanOnSLO())
+			bscanMarkerLayer.paint(painter, exposedRect, cacheRect, [this, series, actMarker](QPainter& p)
+			{
+				ScopedPaintTimer layerTimer("SLO marker layer", actMarker->getMarkerId());
+				paintBScans(p, series, BScanPaintPart::Marker);
+			});
+
+		// not cached, the act BScan is drawn over the decorations of the other BScans
+		paintActBScan(painter, series);
+	}
 
 	if(ProgramOptions::sloShowGrid())
-		paintAnalyseGrid(painter, series);
+		gridLayer.paint(painter, exposedRect, cacheRect, [this, series](QPainter& p)
+		{
+			ScopedPaintTimer layerTimer("SLO grid layer");
+			paintAnalyseGrid(p, series);
+		});
 
+	// cursor layer, changes with every mouse move and is therefore drawn directly
 	if(markPos.show)
 	{
 		QPen pen(QColor(128, 0, 0));
@@ -157,6 +203,13 @@ void SLOImageWidget::paintEvent(QPaintEvent* event)
 
 }
 
+void SLOImageWidget::invalidateLayers()
+{
+	bscanGeometryLayer.invalidate();
+	bscanMarkerLayer  .invalidate();
+	gridLayer         .invalidate();
+}
+
 
 void SLOImageWidget::paintConvexHull(QPainter& painter, const OctData::Series* series)
 {
@@ -185,90 +238,79 @@ void SLOImageWidget::paintConvexHull(QPainter& painter, const OctData::Series* s
 }
 
 
-void SLOImageWidget::paintBScans(QPainter& painter, const OctData::Series* series)
+void SLOImageWidget::paintBScans(QPainter& painter, const OctData::Series* series, BScanPaintPart part)
 {
 	if(!series)
 		return;
 
-	QPen normalBscanPen;
-	QPen activBscanPen;
+	// the act BScan is not part of the layers (paintActBScan)
+	if(singelBScanScan || drawOnylActBScan)
+		return;
 
+	QPen normalBscanPen;
 	normalBscanPen.setWidth(2);
 	normalBscanPen.setColor(QColor(0,0,0));
+	painter.setPen(normalBscanPen);
 
+	const OctData::Series::BScanList bscans = series->getBScans();
+	std::size_t activBScan                  = static_cast<std::size_t>(markerManger.getActBScanNum());
 
-	activBscanPen.setWidth(2);
-	activBscanPen.setColor(QColor(255,0,0));
+	SloCoordTranslator coordTranslator(*series, getImageScaleFactor());
+	coordTranslator.setClipShift(OctData::CoordSLOpx(clipX1, clipY1));
 
+	// std::cout << cscan.getSloImage()->getShift() << " * " << (getImageScaleFactor()) << " = " << shift << std::endl;
+
+	std::size_t bscanCounter = 0;
+	for(const OctData::BScan* bscan : bscans)
+	{
+		if(bscan && bscanCounter != activBScan)
+			paintBScan(painter, *bscan, coordTranslator, bscanCounter, part);
+		++bscanCounter;
+	}
+}
+
+void SLOImageWidget::paintActBScan(QPainter& painter, const OctData::Series* series)
+{
+	if(!series)
+		return;
 
-	
 	const OctData::Series::BScanList bscans = series->getBScans();
 	std::size_t activBScan                  = static_cast<std::size_t>(markerManger.getActBScanNum());
+	if(bscans.size() <= activBScan || !bscans.at(activBScan))
+		return;
+	const OctData::BScan& actBScan = *bscans.at(activBScan);
 
 	SloCoordTranslator coordTranslator(*series, getImageScaleFactor());
 	coordTranslator.setClipShift(OctData::CoordSLOpx(clipX1, clipY1));
 
-	// std::cout << cscan.getSloImage()->getShift() << " * " << (getImageScaleFactor()) << " = " << shift << std::endl;
-
 	bool paintMarker = false;
 	BscanMarkerBase* actMarker = markerManger.getActBscanMarker();
 	if(actMarker)
 		paintMarker = actMarker->drawingBScanOnSLO();
 
-	if(singelBScanScan || drawOnylActBScan)
-	{
-		if(bscans.size() > activBScan)
-		{
-			const OctData::BScan* actBScan = bscans.at(static_cast<std::size_t>(activBScan));
-			if(actBScan)
-			{
-				if(paintMarker)
-					painter.setPen(normalBscanPen);
-				else
-					painter.setPen(activBscanPen);
+	QPen activBscanPen;
+	activBscanPen.setWidth(2);
+	activBscanPen.setColor(QColor(255,0,0));
 
-				paintBScan(painter, *actBScan, coordTranslator, activBScan, paintMarker);
-			}
-		}
-	}
-	else
-	{
-		std::size_t bscanCounter = 0;
-		const OctData::BScan* actBScan = nullptr;
-		for(const OctData::BScan* bscan : bscans)
-		{
-			if(bscan)
-			{
-				if(bscanCounter == activBScan)
-				{
-					actBScan = bscan;
-				}
-				else
-				{
-					painter.setPen(normalBscanPen);
-					paintBScan(painter, *bscan, coordTranslator, bscanCounter, paintMarker);
-				}
-			}
-			++bscanCounter;
-		}
+	// a single shown BScan is marked by the decoration of the marker
+	if(paintMarker && (singelBScanScan || drawOnylActBScan))
+		activBscanPen.setColor(QColor(0,0,0));
 
-		if(actBScan)
-		{
-			painter.setPen(activBscanPen);
-			paintBScan(painter, *actBScan, coordTranslator, activBScan, paintMarker);
-		}
-	}
+	painter.setPen(activBscanPen);
+	paintBScan(painter, actBScan, coordTranslator, activBScan, BScanPaintPart::Geometry);
+	if(paintMarker)
+		paintBScan(painter, actBScan, coordTranslator, activBScan, BScanPaintPart::Marker);
 }
 
-void SLOImageWidget::paintBScan(QPainter& painter, const OctData::BScan& bscan, const SloCoordTranslator& coordTranslator, std::size_t bscanNr, bool paintMarker)
+void SLOImageWidget::paintBScan(QPainter& painter, const OctData::BScan& bscan, const SloCoordTranslator& coordTranslator, std::size_t bscanNr, BScanPaintPart part)
 {
 	switch(bscan.getBScanType())
 	{
 		case OctData::BScan::BScanType::Line:
-			paintBScanLine(painter, bscan, coordTranslator, bscanNr, paintMarker);
+			paintBScanLine(painter, bscan, coordTranslator, bscanNr, part);
 			break;
 		case OctData::BScan::BScanType::Circle:
-			paintBScanCircle(painter, bscan, coordTranslator, bscanNr, paintMarker);
+			paintBScanCircle(painter, bscan, coordTranslator, bscanNr, part);
 			break;
 		case OctData::BScan::BScanType::Unknown:
 			break;
@@ -276,35 +318,46 @@ void SLOImageWidget::paintBScan(QPainter& painter, const OctData::BScan& bscan,
 }
 
 
-void SLOImageWidget::paintBScanLine(QPainter& painter, const OctData::BScan& bscan, const SloCoordTranslator& coordTranslator, std::size_t bscanNr, bool paintMarker)
+void SLOImageWidget::paintBScanLine(QPainter& painter, const OctData::BScan& bscan, const SloCoordTranslator& coordTranslator, std::size_t bscanNr, BScanPaintPart part)
 {
 	const OctData::CoordSLOpx start_px = coordTranslator(bscan.getStart());
 	const OctData::CoordSLOpx   end_px = coordTranslator(bscan.getEnd()  );
 
-	painter.drawLine(start_px.getX(), start_px.getY(), end_px.getX(), end_px.getY());
-
-	if(paintMarker)
+	switch(part)
 	{
-		BscanMarkerBase* actMarker = markerManger.getActBscanMarker();
-		if(actMarker)
-			actMarker->drawBScanSLOLine(painter, bscanNr, start_px, end_px, this);
+		case BScanPaintPart::Geometry:
+			painter.drawLine(start_px.getX(), start_px.getY(), end_px.getX(), end_px.getY());
+			break;
+		case BScanPaintPart::Marker:
+		{
+			BscanMarkerBase* actMarker = markerManger.getActBscanMarker();
+			if(actMarker)
+				actMarker->drawBScanSLOLine(painter, bscanNr, start_px, end_px, this);
+			break;
+		}
 	}
 }
 
-void SLOImageWidget::paintBScanCircle(QPainter& painter, const OctData::BScan& bscan, const SloCoordTranslator& coordTranslator, std::size_t bscanNr, bool paintMarker)
+void SLOImageWidget::paintBScanCircle(QPainter& painter, const OctData::BScan& bscan, const SloCoordTranslator& coordTranslator, std::size_t bscanNr, BScanPaintPart part)
 {
 	const OctData::CoordSLOpx  start_px = coordTranslator(bscan.getStart() );
 	const OctData::CoordSLOpx center_px = coordTranslator(bscan.getCenter());
 
-	double radius = center_px.abs(start_px);
-
-	painter.drawEllipse(QPointF(center_px.getXf(), center_px.getYf()), radius, radius);
-
-	if(paintMarker)
+	switch(part)
 	{
-		BscanMarkerBase* actMarker = markerManger.getActBscanMarker();
-		if(actMarker)
-			actMarker->drawBScanSLOCircle(painter, bscanNr, start_px, center_px, bscan.getClockwiseRot(), this);
+		case BScanPaintPart::Geometry:
+		{
+			double radius = center_px.abs(start_px);
+			painter.drawEllipse(QPointF(center_px.getXf(), center_px.getYf()), radius, radius);
+			break;
+		}
+		case BScanPaintPart::Marker:
+		{
+			BscanMarkerBase* actMarker = markerManger.getActBscanMarker();
+			if(actMarker)
+				actMarker->drawBScanSLOCircle(painter, bscanNr, start_px, center_px, bscan.getClockwiseRot(), this);
+			break;
+		}
 	}
 }
 
@@ -435,25 +488,60 @@ void SLOImageWidget::updateMarkerOverlayImage()
 		BscanMarkerBase* actMarker = markerManger.getActBscanMarker();
 		if(actMarker)
 		{
-			cv::Mat outImage;
-			bool overlayCreated = actMarker->drawSLOOverlayImage(sloPixture, outImage, ProgramOptions::sloOverlayAlpha());
-			if(overlayCreated && !outImage.empty())
+			ScopedPaintTimer timer("SLO overlay blend", actMarker->getMarkerId());
+			bool overlayCreated = actMarker->drawSLOOverlayImage(sloPixture, overlayBlendImage, ProgramOptions::sloOverlayAlpha());
+			if(overlayCreated && !overlayBlendImage.empty())
 			{
 				showPureSloImage = false;
-				clipAndShowImage(outImage);
+				clipAndShowImage(overlayBlendImage);
 			}
 		}
 	}
 
 	if(showPureSloImage)
+	{
+		overlayBlendImage = cv::Mat();
 		clipAndShowImage(sloPixture);
+	}
 
 	singelBScanScan = (series->bscanCount() == 1);
 }
 
 
+void SLOImageWidget::updateMarkerOverlayRegion(const QRect& region)
+{
+	const OctData::Series* series = OctDataManager::getInstance().getSeries();
+	if(!series)
+		return;
+
+	const cv::Mat& sloPixture = series->getSloImage().getImage();
+	BscanMarkerBase* actMarker = markerManger.getActBscanMarker();
+	if(!actMarker || !ProgramOptions::sloShowOverlay() || overlayBlendImage.size() != sloPixture.size())
+	{
+		updateMarkerOverlayImage();
+		return;
+	}
+
+	ScopedPaintTimer timer("SLO overlay region update", actMarker->getMarkerId());
+	const cv::Rect blendRegion(region.x(), region.y(), region.width(), region.height());
+	if(!actMarker->drawSLOOverlayImage(sloPixture, overlayBlendImage, ProgramOptions::sloOverlayAlpha(), &blendRegion))
+	{
+		updateMarkerOverlayImage();
+		return;
+	}
+
+	// the shown image is the clipped part of overlayBlendImage
+	const cv::Rect shownRect(clipX1, clipY1, cvImage.cols, cvImage.rows);
+	const bool regionUpdated = (shownRect & cv::Rect(0, 0, overlayBlendImage.cols, overlayBlendImage.rows)) == shownRect
+	                        && updateImageRegion(overlayBlendImage(shownRect), blendRegion - shownRect.tl());
+	if(!regionUpdated)
+		clipAndShowImage(overlayBlendImage);
+}
+
 void SLOImageWidget::reladSLOImage()
 {
+	ScopedTrace trace("SLOImageWidget::reladSLOImage");
+	invalidateLayers();
 	updateMarkerOverlayImage();
 
 
@@ -463,18 +551,29 @@ void SLOImageWidget::reladSLOImage()
 
 void SLOImageWidget::bscanChanged(int /*bscan*/)
 {
+	bscanGeometryLayer.invalidate();
+	bscanMarkerLayer  .invalidate();
+	update();
+}
+
+void SLOImageWidget::bscanMarkerChanged()
+{
+	bscanMarkerLayer.invalidate();
 	update();
 }
 
 void SLOImageWidget::showBScans(bool show)
 {
 	drawBScans = show;
+	bscanGeometryLayer.invalidate();
 	update();
 }
 
 void SLOImageWidget::showOnylActBScan(bool show)
 {
 	drawOnylActBScan = show;
+	bscanGeometryLayer.invalidate();
+	bscanMarkerLayer  .invalidate();
 	update();
 }
 
@@ -485,6 +584,15 @@ void SLOImageWidget::setImageSize(QSize size)
 	updateGraphicsViewSize();
 }
 
+void SLOImageWidget::addMemoryUsage(MemoryUsage& usage, const std::string& category) const
+{
+	CVImageWidget::addMemoryUsage(usage, category);
+	usage.add(category, "overlay blend image", MemoryUsage::bytes(overlayBlendImage));
+	usage.add(category, "paint layers", MemoryUsage::bytes(bscanGeometryLayer.getImage())
+	                                  + MemoryUsage::bytes(bscanMarkerLayer  .getImage())
+	                                  + MemoryUsage::bytes(gridLayer         .getImage()), 3);
+}
+
 void SLOImageWidget::updateGraphicsViewSize()
 {
 	gv->setGeometry(0, 0, scaledImageWidth(), scaledImageHeight());
@@ -516,6 +624,7 @@ void SLOImageWidget::sloMarkerChanged(SloMarkerBase* marker)
 
 void SLOImageWidget::sloViewChanged()
 {
+	bscanMarkerLayer.invalidate();
 	if(singelBScanScan || drawOnylActBScan)
 		update();
 }
@@ -639,6 +748,8 @@ void SLOImageWidget::setBScanVisibility(int opt)
 			drawConvexHull   = false;
 			break;
 	}
+	bscanGeometryLayer.invalidate();
+	bscanMarkerLayer  .invalidate();
 	update();
 }
 
@@ -20,6 +20,7 @@
 #define SLOIMAGEWIDGET_H
 
 #include "cvimagewidget.h"
+#include "paintlayer.h"
 // #include <vector>
 #include<data_structure/point2d.h>
 
@@ -50,6 +51,15 @@ class SLOImageWidget : public CVImageWidget
 	Q_OBJECT
 
 	struct Point {bool show = false; Point2DInt p; };
+	struct LayerGeometry
+	{
+		double factorX = 0;
+		double factorY = 0;
+		int    clipX   = 0;
+		int    clipY   = 0;
+		bool operator==(const LayerGeometry& o) const           { return factorX == o.factorX && factorY == o.factorY && clipX == o.clipX && clipY == o.clipY; }
+	};
+	enum class BScanPaintPart { Geometry, Marker };
 
 	Point markPos;
 
@@ -59,6 +69,16 @@ class SLOImageWidget : public CVImageWidget
 
 	int clipX1 = 0;
 	int clipY1 = 0;
+
+	cv::Mat overlayBlendImage;                                      // SLO with the overlay of the act marker, region updates change only a part
+
+	// retained layers over the image, the mouse position (markPos) is drawn directly
+	PaintLayer    bscanGeometryLayer;                               // convex hull and BScan lines/circles, without the act BScan
+	PaintLayer    bscanMarkerLayer;                                 // BScan decorations of the act marker, without the act BScan
+	PaintLayer    gridLayer;
+	LayerGeometry layerGeometry;
+
+	void invalidateLayers();
 	
 	// std::vector<QColor*> intervallColors;
 	bool drawBScans       = true;
@@ -83,6 +103,8 @@ public:
 
 	virtual void setImageSize(QSize size) override;
 
+	virtual void addMemoryUsage(MemoryUsage& usage, const std::string& category) const override;
+
 protected:
 	virtual void wheelEvent       (QWheelEvent*) override;
 
@@ -96,12 +118,13 @@ protected:
 	void paintEvent(QPaintEvent* event) override;
 	virtual void mousePressEvent(QMouseEvent*) override;
 
-	void paintBScan      (QPainter& painter, const OctData::BScan& bscan, const SloCoordTranslator& transform, std::size_t bscanNr, bool paintMarker);
-	void paintBScanLine  (QPainter& painter, const OctData::BScan& bscan, const SloCoordTranslator& transform, std::size_t bscanNr, bool paintMarker);
-	void paintBScanCircle(QPainter& painter, const OctData::BScan& bscan, const SloCoordTranslator& transform, std::size_t bscanNr, bool paintMarker);
+	void paintBScan      (QPainter& painter, const OctData::BScan& bscan, const SloCoordTranslator& transform, std::size_t bscanNr, BScanPaintPart part);
+	void paintBScanLine  (QPainter& painter, const OctData::BScan& bscan, const SloCoordTranslator& transform, std::size_t bscanNr, BScanPaintPart part);
+	void paintBScanCircle(QPainter& painter, const OctData::BScan& bscan, const SloCoordTranslator& transform, std::size_t bscanNr, BScanPaintPart part);
 
 	void paintAnalyseGrid(QPainter& painter, const OctData::Series* series);
-	void paintBScans     (QPainter& painter, const OctData::Series* series);
+	void paintBScans     (QPainter& painter, const OctData::Series* series, BScanPaintPart part);
+	void paintActBScan   (QPainter& painter, const OctData::Series* series);
 	void paintConvexHull (QPainter& painter, const OctData::Series* series);
 
 
@@ -112,11 +135,13 @@ protected:
 private slots:
 	void reladSLOImage();
 	void bscanChanged(int);
+	void bscanMarkerChanged();
 	void sloMarkerChanged(SloMarkerBase* marker);
 	void sloViewChanged  ();
 
 	void setBScanVisibility(int opt);
 	void updateMarkerOverlayImage();
+	void updateMarkerOverlayRegion(const QRect& region);
 
 	void saveLatexImageSlot();
 };
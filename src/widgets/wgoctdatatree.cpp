@@ -24,6 +24,7 @@
 #include <QVBoxLayout>
 #include <QListView>
 #include <QHeaderView>
+#include <QComboBox>
 
 #include <QTableView>
 
@@ -31,6 +32,7 @@
 WGOctDataTree::WGOctDataTree()
 : listviewFiles(new QListView(this))
 , modelFiles(&OctFilesModel::getInstance())
+, filterFiles(new QComboBox(this))
 , listviewOctData(new QTableView(this))
 , modelOctData(&OctDataModel::getInstance())
 {
@@ -47,11 +49,19 @@ WGOctDataTree::WGOctDataTree()
 	QSplitter* splitter = new QSplitter(this);
 	splitter->setOrientation(Qt::Vertical);
 	
-	splitter->addWidget(listviewFiles);
+	QWidget* filesWidget = new QWidget(this);
+	QVBoxLayout* filesLayout = new QVBoxLayout(filesWidget);
+	filesLayout->setContentsMargins(0, 0, 0, 0);
+	filesLayout->addWidget(filterFiles);
+	filesLayout->addWidget(listviewFiles);
+
+	splitter->addWidget(filesWidget);
 	splitter->addWidget(listviewOctData);
 
 	layout->addWidget(splitter);
 
+	updateFilterList();
+
 	connect(listviewFiles  , &QListView::clicked         , modelFiles  , &OctFilesModel::slotClicked      );
 	connect(listviewFiles  , &QListView::doubleClicked   , modelFiles  , &OctFilesModel::slotDoubleClicked);
 	connect(listviewFiles  , &QListView::activated       , modelFiles  , &OctFilesModel::slotClicked      );
@@ -61,6 +71,11 @@ WGOctDataTree::WGOctDataTree()
 	connect(listviewOctData, &QTableView::activated      , modelOctData, &OctDataModel ::slotClicked      );
 
 	connect(modelFiles     , &OctFilesModel::fileIdLoaded, this        , &WGOctDataTree::setSelectFileNum );
+
+	connect(modelFiles     , &OctFilesModel::catalogChanged, this      , &WGOctDataTree::updateFilterList );
+	connect(modelFiles     , &OctFilesModel::filterChanged , this      , &WGOctDataTree::updateHiddenFiles);
+	connect(modelFiles     , &OctFilesModel::rowsInserted  , this      , &WGOctDataTree::updateHiddenFiles);
+	connect(filterFiles    , static_cast<void(QComboBox::*)(int)>(&QComboBox::currentIndexChanged), this, &WGOctDataTree::filterSelected);
 }
 
 
@@ -69,3 +84,41 @@ void WGOctDataTree::setSelectFileNum(QModelIndex index)
 	listviewFiles->selectionModel()->select(index, QItemSelectionModel::ClearAndSelect | QItemSelectionModel::Rows);
 	listviewFiles->scrollTo(index);
 }
+
+
+void WGOctDataTree::updateFilterList()
+{
+	const QStringList filters = modelFiles->getCatalogFilters();
+
+	const QString actFilter = modelFiles->getFilter();
+
+	filterFiles->blockSignals(true);
+	filterFiles->clear();
+	for(const QString& filter : filters)
+		filterFiles->addItem(OctFilesModel::getFilterDescription(filter), filter);
+
+	int actIndex = filterFiles->findData(actFilter);
+	if(actIndex < 0)
+	{
+		filterFiles->addItem(OctFilesModel::getFilterDescription(actFilter), actFilter);
+		actIndex = filterFiles->count() - 1;
+	}
+	filterFiles->setCurrentIndex(actIndex);
+	filterFiles->blockSignals(false);
+
+	updateHiddenFiles();
+}
+
+
+void WGOctDataTree::updateHiddenFiles()
+{
+	const int rows = modelFiles->rowCount();
+	for(int row = 0; row < rows; ++row)
+		listviewFiles->setRowHidden(row, !modelFiles->isFileVisible(row));
+}
+
+
+void WGOctDataTree::filterSelected(int index)
+{
+	modelFiles->setFilter(filterFiles->itemData(index).toString());
+}
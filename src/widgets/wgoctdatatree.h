@@ -23,6 +23,7 @@
 
 class QListView;
 class QTableView;
+class QComboBox;
 class OctDataModel;
 class OctFilesModel;
 
@@ -32,6 +33,7 @@ class WGOctDataTree : public QWidget
 
 	QListView*  listviewFiles = nullptr;
 	OctFilesModel* modelFiles = nullptr;
+	QComboBox*  filterFiles   = nullptr;
 	
 	QTableView* listviewOctData = nullptr;
 	OctDataModel* modelOctData  = nullptr;
@@ -42,6 +44,10 @@ public:
 private slots:
 	void setSelectFileNum(QModelIndex index);
 
+	void updateFilterList();
+	void updateHiddenFiles();
+	void filterSelected(int index);
+
 };
 
 #endif // WGOCTDATATREE_H
@@ -40,6 +40,7 @@
 #include <widgets/scrollareapan.h>
 #include <widgets/mousecoordstatus.h>
 #include <widgets/dwdebugoutput.h>
+#include <widgets/dwmemoryusage.h>
 #include <widgets/sloimagewidget.h>
 #include <widgets/bscanchooserspinbox.h>
 
@@ -151,6 +152,13 @@ OCTMarkerMainWindow::OCTMarkerMainWindow(bool loadLastFile)
 
 	bscanMarkerWidget->setPaintMarker(pmm);
 
+	DWMemoryUsage* dwMemoryUsage = new DWMemoryUsage(this);
+	dwMemoryUsage->setObjectName("DWMemoryUsage");
+	dwMemoryUsage->addImageWidget(bscanMarkerWidget             , "BScan view");
+	dwMemoryUsage->addImageWidget(wgSloImage->getImageWidget()  , "SLO view"  );
+	addDockWidget(Qt::RightDockWidgetArea, dwMemoryUsage);
+	dwMemoryUsage->hide();
+
 
 
 	// General Config
@@ -285,6 +293,8 @@ void OCTMarkerMainWindow::setupMenu()
 	layerSegmentMenu->addSeparator();
 	layerSegmentMenu->addAction(ProgramOptions::layerSegThicknessmapBlend.getAction());
 	layerSegmentMenu->addAction(ProgramOptions::layerSegSloMapsAutoUpdate.getAction());
+	layerSegmentMenu->addSeparator();
+	layerSegmentMenu->addAction(ProgramOptions::layerSegSaveLinesFloat32 .getAction());
 
 
 	QMenu* viewMenu = new QMenu(this);
@@ -294,9 +304,12 @@ void OCTMarkerMainWindow::setupMenu()
 	viewMenu->addAction(ProgramOptions::bscanSegmetationLineColor.getColorDialogAction());
 	viewMenu->addSeparator();
 	viewMenu->addAction(ProgramOptions::freeFormedSegmetationShowArea  .getAction());
+	viewMenu->addAction(ProgramOptions::freeFormedSegmetationSaveCompact.getAction());
 	viewMenu->addMenu(layerSegmentMenu);
 	viewMenu->addSeparator();
 	viewMenu->addAction(ProgramOptions::bscanShowExtraSegmentationslines.getAction());
+	viewMenu->addAction(ProgramOptions::bscanPrerenderNeighbors.getInputDialogAction());
+	viewMenu->addAction(ProgramOptions::bscanNavigationSettleTime.getInputDialogAction());
 
 
 	// ----------
@@ -397,6 +410,10 @@ void OCTMarkerMainWindow::setupMenu()
 	addMenuProgramOptionGroup(tr("JSON"), ProgramOptions::defaultFileformatOctMarkers, optionsMenuMarkersFileFormat, markerFFjson  , markersFileFormatGroup, this);
 	static SendInt markerFFinfo(OctMarkerIO::fileformat2Int(OctMarkerFileformat::INFO));
 	addMenuProgramOptionGroup(tr("INFO"), ProgramOptions::defaultFileformatOctMarkers, optionsMenuMarkersFileFormat, markerFFinfo  , markersFileFormatGroup, this);
+	static SendInt markerFFbinary(OctMarkerIO::fileformat2Int(OctMarkerFileformat::Binary));
+	addMenuProgramOptionGroup(tr("Binary"), ProgramOptions::defaultFileformatOctMarkers, optionsMenuMarkersFileFormat, markerFFbinary, markersFileFormatGroup, this);
+	optionsMenuMarkersFileFormat->addSeparator();
+	optionsMenuMarkersFileFormat->addAction(ProgramOptions::compressOctMarkers.getAction());
 
 	optionsMenu->addSeparator();
 	optionsMenu->addAction(ProgramOptions::getResetAction());
@@ -497,6 +514,8 @@ void OCTMarkerMainWindow::setupStatusBar()
 	OctDataManager& octDataManager = OctDataManager::getInstance();
 	connect(&octDataManager, &OctDataManager::loadFileSignal  , this, &OCTMarkerMainWindow::loadFileStatusSlot);
 	connect(&octDataManager, &OctDataManager::loadFileProgress, this, &OCTMarkerMainWindow::loadFileProgress  );
+	connect(&octDataManager, &OctDataManager::markerSaveFinished, this, &OCTMarkerMainWindow::markerSaveFinishedSlot);
+	connect(&OctFilesModel::getInstance(), &OctFilesModel::catalogError, this, &OCTMarkerMainWindow::catalogErrorSlot);
 
 	loadProgressBar = new QProgressBar;
 	loadProgressBar->setFixedWidth(200);
@@ -571,6 +590,7 @@ void OCTMarkerMainWindow::showImportFromFolderDialog()
 	{
 		QStringList foldernames = fd.selectedFiles();
 		loadFolder(foldernames[0]);
+		OctFilesModel::getInstance().loadCatalog(foldernames[0]);
 	}
 }
 
@@ -639,6 +659,7 @@ void OCTMarkerMainWindow::handleOpenUrl(const QUrl& url, bool singleInput)
 	if(fileInfo.isDir())
 	{
 		loadFolder(filePath);
+		OctFilesModel::getInstance().loadCatalog(filePath);
 	}
 	if(OctData::OctFileRead::isLoadable(filePath.toStdString()))
 	{
@@ -757,11 +778,13 @@ void OCTMarkerMainWindow::setMarkersStringList(QStringList& filters)
 	const char* josnExt = OctMarkerIO::getFileExtension(OctMarkerFileformat::Json);
 	const char*  xmlExt = OctMarkerIO::getFileExtension(OctMarkerFileformat::XML);
 	const char* infoExt = OctMarkerIO::getFileExtension(OctMarkerFileformat::INFO);
+	const char*  binExt = OctMarkerIO::getFileExtension(OctMarkerFileformat::Binary);
 	
-	filters << tr("OCT Markers")+QString(" (*.%1 *.%2 *.%3)").arg(josnExt).arg(xmlExt).arg(infoExt);
-	filters << tr("OCT Markers Json file")+QString(" (*.%1)").arg(josnExt);
-	filters << tr("OCT Markers XML file" )+QString(" (*.%1)").arg(xmlExt);
-	filters << tr("OCT Markers INFO file")+QString(" (*.%1)").arg(infoExt);
+	filters << tr("OCT Markers")+QString(" (*.%1 *.%2 *.%3 *.%4 *.%1.gz *.%2.gz *.%3.gz *.%4.gz)").arg(josnExt).arg(xmlExt).arg(infoExt).arg(binExt);
+	filters << tr("OCT Markers Json file")+QString(" (*.%1 *.%1.gz)").arg(josnExt);
+	filters << tr("OCT Markers XML file" )+QString(" (*.%1 *.%1.gz)").arg(xmlExt);
+	filters << tr("OCT Markers INFO file")+QString(" (*.%1 *.%1.gz)").arg(infoExt);
+	filters << tr("OCT Markers binary file")+QString(" (*.%1 *.%1.gz)").arg(binExt);
 }
 
 namespace
@@ -772,7 +795,7 @@ namespace
 		OCTMarkerMainWindow::setMarkersStringList(filters);
 		int index = filters.indexOf(filter);
 		
-		static const OctMarkerFileformat formats[] = {OctMarkerFileformat::Json, OctMarkerFileformat::XML, OctMarkerFileformat::INFO};
+		static const OctMarkerFileformat formats[] = {OctMarkerFileformat::Json, OctMarkerFileformat::XML, OctMarkerFileformat::INFO, OctMarkerFileformat::Binary};
 		
 		if(index == 0)
 		   return OctMarkerFileformat::Auto;
@@ -975,6 +998,21 @@ void OCTMarkerMainWindow::loadFileStatusSlot(bool loading)
 }
 
 
+void OCTMarkerMainWindow::markerSaveFinishedSlot(bool success, const QString& message)
+{
+	if(success)
+		statusBar()->showMessage(message, 5000);
+	else
+		QMessageBox::critical(this, tr("Error on autosave"), message);
+}
+
+
+void OCTMarkerMainWindow::catalogErrorSlot(const QString& message)
+{
+	statusBar()->showMessage(message, 10000);
+}
+
+
 void OCTMarkerMainWindow::loadFileProgress(double frac)
 {
 	loadProgressBar->setValue(static_cast<int>(frac*100));
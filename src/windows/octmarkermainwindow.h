@@ -101,6 +101,8 @@ private slots:
 
 	void loadFileStatusSlot(bool loading);
 	void loadFileProgress(double frac);
+	void markerSaveFinishedSlot(bool success, const QString& message);
+	void catalogErrorSlot(const QString& message);
 
 	void triggerSaveMarkersDefaultCatchErrors();
 
@@ -5,6 +5,7 @@
 #include "mex.h"
 
 #include <vector>
+#include <string>
 
 #include <tuple>
 
@@ -199,3 +200,49 @@ inline T getConfigFromStruct(const mxArray* const mxConfig, const char* name, co
 	return defaultValue;
 }
 
+
+template<typename T>
+std::vector<T> getVectorConvert(const mxArray* const matlabMat)
+{
+	std::vector<T> result;
+	if(!matlabMat)
+		return result;
+
+	const std::size_t numElements = mxGetNumberOfElements(matlabMat);
+	const std::size_t elementSize = mxGetElementSize(matlabMat);
+	const char* dataPtr = reinterpret_cast<const char*>(mxGetData(matlabMat));
+
+	result.reserve(numElements);
+	for(std::size_t i = 0; i < numElements; ++i)
+		result.push_back(getValueConvert<T>(matlabMat, reinterpret_cast<const double*>(dataPtr + i*elementSize)));
+
+	return result;
+}
+
+inline std::string getString(const mxArray* const matlabMat)
+{
+	if(!matlabMat || !mxIsChar(matlabMat))
+		return std::string();
+
+	const mxChar* strPtr = reinterpret_cast<const mxChar*>(mxGetData(matlabMat));
+	return std::string(strPtr, strPtr + mxGetNumberOfElements(matlabMat));
+}
+
+// char array or cell array of char arrays
+inline std::vector<std::string> getStringList(const mxArray* const matlabMat)
+{
+	std::vector<std::string> result;
+	if(!matlabMat)
+		return result;
+
+	if(mxIsChar(matlabMat))
+		result.push_back(getString(matlabMat));
+	else if(mxIsCell(matlabMat))
+	{
+		const std::size_t numElements = mxGetNumberOfElements(matlabMat);
+		for(std::size_t i = 0; i < numElements; ++i)
+			result.push_back(getString(mxGetCell(matlabMat, i)));
+	}
+
+	return result;
+}
@@ -0,0 +1,238 @@
+#include "segmentationreader.h"
+
+#include <map>
+#include <limits>
+#include <cstring>
+#include <algorithm>
+
+#include <boost/property_tree/ptree.hpp>
+#include <boost/filesystem.hpp>
+
+#include <manager/octmarkerio.h>
+#include <manager/octmarkerbinaryio.h>
+#include <helper/segmentlinecodec.h>
+#include <helper/parallelfor.h>
+
+namespace bpt = boost::property_tree;
+namespace bfs = boost::filesystem;
+
+
+namespace
+{
+	typedef std::map<int, const bpt::ptree*> BScanNodeMap;
+
+	BScanNodeMap collectBScanNodes(const bpt::ptree& moduleNode)
+	{
+		BScanNodeMap bscanNodes;
+		for(const std::pair<const std::string, bpt::ptree>& nodeBscanPair : moduleNode)
+		{
+			if(nodeBscanPair.first != "BScan")
+				continue;
+
+			boost::optional<const bpt::ptree&> idNode = nodeBscanPair.second.get_child_optional("ID");
+			if(!idNode)
+				continue;
+
+			int bscanId = idNode->get_value<int>(-1);
+			if(bscanId >= 0)
+				bscanNodes.emplace(bscanId, &nodeBscanPair.second);
+		}
+		return bscanNodes;
+	}
+
+	std::vector<int> selectBScans(const BScanNodeMap& bscanNodes, const std::vector<int>& bscanSelection)
+	{
+		if(!bscanSelection.empty())
+			return bscanSelection;
+
+		std::vector<int> bscanIds;
+		bscanIds.reserve(bscanNodes.size());
+		for(const BScanNodeMap::value_type& bscanPair : bscanNodes)
+			bscanIds.push_back(bscanPair.first);
+		return bscanIds;
+	}
+
+	const bpt::ptree* findBScanNode(const BScanNodeMap& bscanNodes, int bscanId)
+	{
+		BScanNodeMap::const_iterator it = bscanNodes.find(bscanId);
+		if(it == bscanNodes.end())
+			return nullptr;
+		return it->second;
+	}
+}
+
+
+const char* const SegmentationReader::masksModuleId = "SegmentationMarker";
+const char* const SegmentationReader::linesModuleId = "LayerSegmentation";
+
+
+const bpt::ptree* SegmentationReader::loadSeries(const std::string& octFilename, const std::string& moduleId, bpt::ptree& markerTree)
+{
+	bfs::path markersFile;
+	if(OctMarkerIO::findDefaultMarkerFile(octFilename, markersFile) == OctMarkerFileformat::Binary && !OctMarkerIO::isCompressedFile(markersFile))
+	{
+		// the returned tree has only the module node
+		markerTree.clear();
+		bpt::ptree& moduleNode = markerTree.push_back(bpt::ptree::value_type(moduleId, bpt::ptree()))->second;
+		try
+		{
+			OctMarkerBinaryIO::readSeriesModule(markersFile, moduleId, moduleNode);
+		}
+		catch(const std::exception&)
+		{
+			return nullptr;
+		}
+		return &markerTree;
+	}
+
+	OctMarkerIO markerIO(&markerTree);
+	if(!markerIO.loadDefaultMarker(octFilename))
+		return nullptr;
+
+	boost::optional<bpt::ptree&> seriesNode = markerTree.get_child_optional("Patient.Study.Series");
+	if(!seriesNode)
+		return nullptr;
+	return &seriesNode.get();
+}
+
+
+void SegmentationReader::Masks::collect(const bpt::ptree& seriesNode, const std::vector<int>& bscanSelection)
+{
+	BScanNodeMap bscanNodes;
+	boost::optional<const bpt::ptree&> nodeILM = seriesNode.get_child_optional(std::string(masksModuleId) + ".ILM");
+	if(nodeILM)
+		bscanNodes = collectBScanNodes(*nodeILM);
+
+	bscanIds = selectBScans(bscanNodes, bscanSelection);
+	masks.assign(bscanIds.size(), SimpleMatCompress());
+	std::vector<char> decoded(bscanIds.size(), false);
+
+	ParallelFor::run(bscanIds.size(), [&](std::size_t i)
+	{
+		const bpt::ptree* nodeBscan = findBScanNode(bscanNodes, bscanIds[i]);
+		if(!nodeBscan)
+			return;
+
+		boost::optional<const bpt::ptree&> matCompressNode = nodeBscan->get_child_optional("matCompress");
+		if(matCompressNode && matCompressNode->data().size() >= 2)
+			decoded[i] = masks[i].fromSerializationString(matCompressNode->data());
+	});
+
+	// the size of the first mask defines the output size, like in read_seg
+	rows = 0;
+	cols = 0;
+	for(std::size_t i = 0; i < bscanIds.size(); ++i)
+	{
+		if(decoded[i])
+		{
+			rows = masks[i].getRows();
+			cols = masks[i].getCols();
+			break;
+		}
+	}
+
+	valid.resize(bscanIds.size());
+	for(std::size_t i = 0; i < bscanIds.size(); ++i)
+		valid[i] = decoded[i] && masks[i].getRows() == rows && masks[i].getCols() == cols;
+
+	// without selection only the readable masks are returned
+	if(bscanSelection.empty())
+	{
+		std::size_t dest = 0;
+		for(std::size_t i = 0; i < bscanIds.size(); ++i)
+		{
+			if(!valid[i])
+				continue;
+			bscanIds[dest] = bscanIds[i];
+			std::swap(masks[dest], masks[i]);
+			valid[dest] = true;
+			++dest;
+		}
+		bscanIds.resize(dest);
+		masks   .resize(dest);
+		valid   .resize(dest);
+	}
+}
+
+void SegmentationReader::Masks::write(uint8_t* dest) const
+{
+	const std::size_t sliceSize = static_cast<std::size_t>(rows)*static_cast<std::size_t>(cols);
+	ParallelFor::run(bscanIds.size(), [&](std::size_t i)
+	{
+		uint8_t* slice = dest + i*sliceSize;
+		if(!valid[i] || !masks[i].writeToMat(slice, rows, cols))
+			std::memset(slice, 0, sliceSize);
+	});
+}
+
+
+void SegmentationReader::Lines::collect(const bpt::ptree& seriesNode, const std::vector<int>& bscanSelection, const std::vector<std::string>& lineSelection)
+{
+	BScanNodeMap bscanNodes;
+	boost::optional<const bpt::ptree&> moduleNode = seriesNode.get_child_optional(linesModuleId);
+	if(moduleNode)
+		bscanNodes = collectBScanNodes(*moduleNode);
+
+	bscanIds = selectBScans(bscanNodes, bscanSelection);
+
+	// line names in order of appearance
+	lineNames = lineSelection;
+	if(lineNames.empty())
+	{
+		for(int bscanId : bscanIds)
+		{
+			const bpt::ptree* nodeBscan = findBScanNode(bscanNodes, bscanId);
+			if(!nodeBscan)
+				continue;
+
+			boost::optional<const bpt::ptree&> linesNode = nodeBscan->get_child_optional("Lines");
+			if(!linesNode)
+				continue;
+
+			for(const std::pair<const std::string, bpt::ptree>& lineNodePair : *linesNode)
+				if(std::find(lineNames.begin(), lineNames.end(), lineNodePair.first) == lineNames.end())
+					lineNames.push_back(lineNodePair.first);
+		}
+	}
+
+	lines.assign(bscanIds.size(), std::vector<std::vector<double>>(lineNames.size()));
+
+	ParallelFor::run(bscanIds.size(), [&](std::size_t i)
+	{
+		const bpt::ptree* nodeBscan = findBScanNode(bscanNodes, bscanIds[i]);
+		if(!nodeBscan)
+			return;
+
+		boost::optional<const bpt::ptree&> linesNode = nodeBscan->get_child_optional("Lines");
+		if(!linesNode)
+			return;
+
+		for(const std::pair<const std::string, bpt::ptree>& lineNodePair : *linesNode)
+		{
+			std::vector<std::string>::const_iterator nameIt = std::find(lineNames.begin(), lineNames.end(), lineNodePair.first);
+			if(nameIt != lineNames.end())
+				lines[i][static_cast<std::size_t>(nameIt - lineNames.begin())] = SegmentlineCodec::decode(lineNodePair.second.data());
+		}
+	});
+
+	numPoints = 0;
+	for(const std::vector<std::vector<double>>& bscanLines : lines)
+		for(const std::vector<double>& line : bscanLines)
+			numPoints = std::max(numPoints, line.size());
+}
+
+void SegmentationReader::Lines::write(double* dest) const
+{
+	const std::size_t numBScans = bscanIds.size();
+	ParallelFor::run(numBScans, [&](std::size_t bscan)
+	{
+		for(std::size_t line = 0; line < lineNames.size(); ++line)
+		{
+			double* destLine = dest + (line*numBScans + bscan)*numPoints;
+			const std::vector<double>& values = lines[bscan][line];
+
+			std::copy(values.begin(), values.end(), destLine);
+			std::fill(destLine + values.size(), destLine + numPoints, std::numeric_limits<double>::quiet_NaN());
+		}
+	});
+}
@@ -0,0 +1,63 @@
+#pragma once
+
+#include <vector>
+#include <string>
+#include <cstdint>
+
+#include <boost/property_tree/ptree_fwd.hpp>
+
+#include <data_structure/simplematcompress.h>
+
+
+// reads the segmentations of a marker file for the mex functions
+// the BScan nodes are collected in one pass over the module node, every BScan is decoded exactly once
+// and written directly into the (preallocated) output array
+namespace SegmentationReader
+{
+	// loads the default marker file of octFilename, returns the series node or nullptr
+	// from binary files only the node of moduleId is read, the other formats are parsed completely
+	const boost::property_tree::ptree* loadSeries(const std::string& octFilename, const std::string& moduleId, boost::property_tree::ptree& markerTree);
+
+	extern const char* const masksModuleId;
+	extern const char* const linesModuleId;
+
+	// free formed segmentation (module "SegmentationMarker", node "ILM")
+	class Masks
+	{
+		std::vector<int>               bscanIds;
+		std::vector<SimpleMatCompress> masks;
+		std::vector<bool>              valid;
+		int rows = 0;
+		int cols = 0;
+
+	public:
+		// bscanSelection empty: all marked BScans sorted by ID, else one mask for every selected ID (empty mask if not marked)
+		void collect(const boost::property_tree::ptree& seriesNode, const std::vector<int>& bscanSelection);
+
+		const std::vector<int>& getBScanIds() const                 { return bscanIds; }
+		int getRows() const                                         { return rows; }
+		int getCols() const                                         { return cols; }
+		std::size_t getNumBScans() const                            { return bscanIds.size(); }
+
+		void write(uint8_t* dest) const;                            // cols x rows x bscans
+	};
+
+	// layer segmentation lines (module "LayerSegmentation")
+	class Lines
+	{
+		std::vector<int>                              bscanIds;
+		std::vector<std::string>                      lineNames;
+		std::vector<std::vector<std::vector<double>>> lines;        // [bscan][line]
+		std::size_t numPoints = 0;
+
+	public:
+		// empty selections: all marked BScans sorted by ID / all lines in order of appearance
+		void collect(const boost::property_tree::ptree& seriesNode, const std::vector<int>& bscanSelection, const std::vector<std::string>& lineSelection);
+
+		const std::vector<int>        & getBScanIds () const        { return bscanIds; }
+		const std::vector<std::string>& getLineNames() const        { return lineNames; }
+		std::size_t getNumPoints() const                            { return numPoints; }
+
+		void write(double* dest) const;                             // points x bscans x lines, NaN for missing values
+	};
+}
@@ -10,8 +10,6 @@
 #include <boost/property_tree/xml_parser.hpp>
 #include <boost/property_tree/json_parser.hpp>
 
-#include <boost/archive/text_iarchive.hpp>
-
 #include <iostream>
 #include <sstream>
 
@@ -26,15 +24,12 @@ bool extractMatCompress(const bpt::ptree& nodeBscan, SimpleMatCompress& compress
 	if(!matCompressNodeOptional)
 		return false;
 
-	std::string matCompressStr = matCompressNodeOptional->get_value<std::string>(std::string());
+	const std::string& matCompressStr = matCompressNodeOptional->data();
 
 	if(matCompressStr.size() < 2)
 		return false;
 
-	std::stringstream ioa(matCompressStr);
-	boost::archive::text_iarchive oa(ioa);
-	oa >> compressedMat;
-	return true;
+	return compressedMat.fromSerializationString(matCompressStr);
 }
 
 void mexFunction(int            nlhs  ,
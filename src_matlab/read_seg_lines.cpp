@@ -0,0 +1,94 @@
+#include "mex.h"
+
+#include "helper/matlab_helper.h"
+#include "helper/matlab_types.h"
+#include "helper/segmentationreader.h"
+
+#include <boost/property_tree/ptree.hpp>
+
+#include <string>
+#include <vector>
+
+namespace bpt = boost::property_tree;
+
+
+// [lines, bscanIds, lineNames] = read_seg_lines(filename [, bscanIds [, lineNames]])
+// lines: double points x bscans x lines (NaN for missing values), bscanIds: IDs of the BScans in the marker file (starting with 0)
+// lineNames: cell array with the names of the segmentation lines (e.g. 'ILM', 'BM')
+void mexFunction(int            nlhs  ,
+                 mxArray*       plhs[],
+                 int            nrhs  ,
+                 const mxArray* prhs[]
+                 )
+{
+	if(nrhs < 1 || nrhs > 3)
+	{
+		mexErrMsgIdAndTxt("MATLAB:mexcpp:nargin", "read_seg_lines requires 1 to 3 input arguments (filename [, bscanIds [, lineNames]])");
+		return;
+	}
+	if(nlhs > 3)
+	{
+		mexErrMsgIdAndTxt("MATLAB:mexcpp:nargout", "read_seg_lines has at most 3 output arguments");
+		return;
+	}
+	if(!mxIsChar(prhs[0]))
+	{
+		mexErrMsgIdAndTxt("MATLAB:mexcpp:nargin", "requires filename");
+		return;
+	}
+
+	const std::string filename = getString(prhs[0]);
+	std::vector<int> bscanSelection;
+	std::vector<std::string> lineSelection;
+	if(nrhs > 1)
+		bscanSelection = getVectorConvert<int>(prhs[1]);
+	if(nrhs > 2)
+		lineSelection = getStringList(prhs[2]);
+
+	bpt::ptree octmarkerTree;
+	const bpt::ptree* seriesNode = SegmentationReader::loadSeries(filename, SegmentationReader::linesModuleId, octmarkerTree);
+	if(!seriesNode)
+	{
+		mexErrMsgIdAndTxt("MATLAB:mexcpp:nargin", "can't open marker file for %s", filename.c_str());
+		return;
+	}
+
+	mxArray* resultMat = nullptr;
+	std::vector<double> bscanIds;
+	std::vector<std::string> lineNames;
+
+	try
+	{
+		SegmentationReader::Lines lines;
+		lines.collect(*seriesNode, bscanSelection, lineSelection);
+		octmarkerTree.clear();
+
+		const mwSize dims[] = {lines.getNumPoints(), lines.getBScanIds().size(), lines.getLineNames().size()};
+		const mwSize dimNum = sizeof(dims)/sizeof(dims[0]);
+		resultMat = mxCreateNumericArray(dimNum, dims, MatlabType<double>::classID, mxREAL);
+		lines.write(reinterpret_cast<double*>(mxGetData(resultMat)));
+
+		bscanIds.assign(lines.getBScanIds().begin(), lines.getBScanIds().end());
+		lineNames = lines.getLineNames();
+	}
+	catch(...)
+	{
+		if(resultMat)
+			mxDestroyArray(resultMat);
+		mexErrMsgIdAndTxt("MATLAB:mexcpp:nargin", "Error while reading file");
+		return;
+	}
+
+	plhs[0] = resultMat;
+	if(nlhs > 1)
+	{
+		plhs[1] = nullptr;
+		createMatlabVector(bscanIds, plhs[1]);
+	}
+	if(nlhs > 2)
+	{
+		plhs[2] = mxCreateCellMatrix(1, lineNames.size());
+		for(std::size_t i = 0; i < lineNames.size(); ++i)
+			mxSetCell(plhs[2], i, mxCreateString(lineNames[i].c_str()));
+	}
+}
@@ -0,0 +1,82 @@
+#include "mex.h"
+
+#include "helper/matlab_helper.h"
+#include "helper/matlab_types.h"
+#include "helper/segmentationreader.h"
+
+#include <boost/property_tree/ptree.hpp>
+
+#include <string>
+#include <vector>
+
+namespace bpt = boost::property_tree;
+
+
+// [masks, bscanIds] = read_seg_masks(filename [, bscanIds])
+// masks: uint8 cols x rows x bscans, bscanIds: IDs of the BScans in the marker file (starting with 0)
+void mexFunction(int            nlhs  ,
+                 mxArray*       plhs[],
+                 int            nrhs  ,
+                 const mxArray* prhs[]
+                 )
+{
+	if(nrhs < 1 || nrhs > 2)
+	{
+		mexErrMsgIdAndTxt("MATLAB:mexcpp:nargin", "read_seg_masks requires 1 or 2 input arguments (filename [, bscanIds])");
+		return;
+	}
+	if(nlhs > 2)
+	{
+		mexErrMsgIdAndTxt("MATLAB:mexcpp:nargout", "read_seg_masks has at most 2 output arguments");
+		return;
+	}
+	if(!mxIsChar(prhs[0]))
+	{
+		mexErrMsgIdAndTxt("MATLAB:mexcpp:nargin", "requires filename");
+		return;
+	}
+
+	const std::string filename = getString(prhs[0]);
+	std::vector<int> bscanSelection;
+	if(nrhs > 1)
+		bscanSelection = getVectorConvert<int>(prhs[1]);
+
+	bpt::ptree octmarkerTree;
+	const bpt::ptree* seriesNode = SegmentationReader::loadSeries(filename, SegmentationReader::masksModuleId, octmarkerTree);
+	if(!seriesNode)
+	{
+		mexErrMsgIdAndTxt("MATLAB:mexcpp:nargin", "can't open marker file for %s", filename.c_str());
+		return;
+	}
+
+	mxArray* resultMat = nullptr;
+	std::vector<double> bscanIds;
+
+	try
+	{
+		SegmentationReader::Masks masks;
+		masks.collect(*seriesNode, bscanSelection);
+		octmarkerTree.clear();
+
+		const mwSize dims[] = {static_cast<mwSize>(masks.getCols()), static_cast<mwSize>(masks.getRows()), masks.getNumBScans()};
+		const mwSize dimNum = sizeof(dims)/sizeof(dims[0]);
+		resultMat = mxCreateNumericArray(dimNum, dims, MatlabType<uint8_t>::classID, mxREAL);
+		masks.write(reinterpret_cast<uint8_t*>(mxGetData(resultMat)));
+
+		bscanIds.assign(masks.getBScanIds().begin(), masks.getBScanIds().end());
+	}
+	catch(...)
+	{
+		if(resultMat)
+			mxDestroyArray(resultMat);
+		mexErrMsgIdAndTxt("MATLAB:mexcpp:nargin", "Error while reading file");
+		return;
+	}
+
+	plhs[0] = resultMat;
+	if(nlhs > 1)
+	{
+		plhs[1] = nullptr;
+		createMatlabVector(bscanIds, plhs[1]);
+	}
+}
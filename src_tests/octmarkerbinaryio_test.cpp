@@ -0,0 +1,176 @@
+#include <iostream>
+#include <sstream>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <cstdlib>
+#include <cstdint>
+#include <chrono>
+#include <stdexcept>
+
+#include <boost/property_tree/ptree.hpp>
+#include <boost/filesystem.hpp>
+
+#include <manager/octmarkerbinaryio.h>
+
+namespace bpt = boost::property_tree;
+namespace bfs = boost::filesystem;
+
+
+namespace
+{
+	int failures = 0;
+
+	void check(bool condition, const char* message)
+	{
+		if(!condition)
+		{
+			std::cerr << "FAILED: " << message << '\n';
+			++failures;
+		}
+	}
+
+	void putVarint(std::string& buffer, uint64_t value)
+	{
+		while(value >= 0x80)
+		{
+			buffer.push_back(static_cast<char>((value & 0x7f) | 0x80));
+			value >>= 7;
+		}
+		buffer.push_back(static_cast<char>(value));
+	}
+
+	template<typename T>
+	void putFixed(std::string& buffer, T value)
+	{
+		for(std::size_t i = 0; i < sizeof(T); ++i)
+		{
+			buffer.push_back(static_cast<char>(value & 0xff));
+			value = static_cast<T>(value >> 8);
+		}
+	}
+
+	// chunk i references chunk i+1 twice, chunk 0 is the root: a DAG which expands to 2^(numChunks-1) leafs
+	std::string createChainedReferenceFile(std::size_t numChunks, bool selfReference)
+	{
+		std::string file("OCTMRKB\n");
+		putFixed<uint32_t>(file, 1);
+
+		std::vector<uint64_t> offsets;
+		std::vector<uint64_t> sizes;
+		for(std::size_t i = 0; i < numChunks; ++i)
+		{
+			offsets.push_back(file.size());
+
+			putVarint(file, 0);                                     // key
+			putVarint(file, 0);                                     // value
+			const bool last = i + 1 == numChunks;
+			putVarint(file, last ? 0 : 2);
+			if(!last)
+			{
+				const std::size_t child = selfReference ? i : i + 1;
+				for(int ref = 0; ref < 2; ++ref)
+				{
+					file.push_back(1);                                  // ChildKind::Chunk
+					putVarint(file, child);
+				}
+			}
+			sizes.push_back(file.size() - offsets.back());
+		}
+
+		const uint64_t tocOffset = file.size();
+		putVarint(file, numChunks);
+		for(std::size_t i = 0; i < numChunks; ++i)
+		{
+			putVarint(file, i == 0 ? 0 : i);                        // parent + 1
+			putVarint(file, 0);                                     // key
+			putVarint(file, 0);                                     // id + 1
+			putVarint(file, offsets[i]);
+			putVarint(file, sizes[i]);
+		}
+		putFixed<uint64_t>(file, tocOffset);
+		putFixed<uint32_t>(file, 0);                                // root chunk
+		putFixed<uint32_t>(file, 0x434f544d);
+		return file;
+	}
+
+	bool isRejected(const std::string& file)
+	{
+		bpt::ptree tree;
+		try
+		{
+			OctMarkerBinaryIO::read(file.data(), file.size(), tree);
+		}
+		catch(const std::runtime_error&)
+		{
+			return true;
+		}
+		return false;
+	}
+
+	bpt::ptree createMarkerTree()
+	{
+		bpt::ptree tree;
+		bpt::ptree& series = tree.add_child("Patient.Study.Series", bpt::ptree());
+		series.put("ID", 3);
+		series.put("SegmentationMarker.ILM.BScan.ID", 0);
+		for(int i = 0; i < 4; ++i)
+		{
+			bpt::ptree& bscan = series.add_child("LayerSegmentation.BScan", bpt::ptree());
+			bscan.put("ID", i);
+			bscan.put("Lines.ILM", "1 2 3");
+		}
+		return tree;
+	}
+
+	void testRoundTrip()
+	{
+		const bpt::ptree tree = createMarkerTree();
+
+		std::ostringstream stream;
+		OctMarkerBinaryIO::write(stream, tree);
+		const std::string file = stream.str();
+
+		bpt::ptree readTree;
+		OctMarkerBinaryIO::read(file.data(), file.size(), readTree);
+		check(readTree == tree, "round trip changes the tree");
+	}
+
+	void testReadSeriesModule()
+	{
+		const bpt::ptree tree = createMarkerTree();
+		const bfs::path file = bfs::temp_directory_path() / bfs::unique_path("octmarker-%%%%-%%%%.boctmarker");
+		{
+			std::ofstream stream(file.string(), std::ios::binary);
+			OctMarkerBinaryIO::write(stream, tree);
+		}
+
+		bpt::ptree moduleNode;
+		check(OctMarkerBinaryIO::readSeriesModule(file, "LayerSegmentation", moduleNode), "module chunk not found");
+		check(moduleNode == tree.get_child("Patient.Study.Series.LayerSegmentation"), "module chunk differs from the module node");
+		check(!OctMarkerBinaryIO::readSeriesModule(file, "Objectsmarker", moduleNode), "missing module is found");
+
+		bfs::remove(file);
+	}
+
+	void testChainedReferences()
+	{
+		const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+		check(isRejected(createChainedReferenceFile(40, false)), "chunk referenced twice is accepted");
+		check(isRejected(createChainedReferenceFile( 2, true )), "chunk referencing itself is accepted");
+		check(std::chrono::steady_clock::now() - start < std::chrono::seconds(1), "chained references are expanded");
+	}
+}
+
+
+int main()
+{
+	testRoundTrip();
+	testReadSeriesModule();
+	testChainedReferences();
+
+	if(failures > 0)
+		return EXIT_FAILURE;
+	std::cout << "ok\n";
+	return EXIT_SUCCESS;
+}
@@ -0,0 +1,522 @@
+#include "syntheticoct.h"
+
+#include <cmath>
+#include <random>
+#include <algorithm>
+
+#include <opencv2/opencv.hpp>
+
+#include <octdata/datastruct/oct.h>
+#include <octdata/datastruct/patient.h>
+#include <octdata/datastruct/study.h>
+#include <octdata/datastruct/series.h>
+#include <octdata/datastruct/bscan.h>
+#include <octdata/datastruct/sloimage.h>
+#include <octdata/datastruct/coordslo.h>
+#include <octdata/datastruct/segmentationlines.h>
+#include <octdata/octfileread.h>
+#include <octdata/filewriteoptions.h>
+
+#include <boost/property_tree/ptree.hpp>
+
+#include <manager/octmarkerio.h>
+#include <helper/ptreehelper.h>
+#include <helper/segmentlinecodec.h>
+#include <helper/parallelfor.h>
+#include <data_structure/simplematcompress.h>
+
+namespace bpt = boost::property_tree;
+
+
+namespace
+{
+	typedef OctData::Segmentationlines::SegmentlineType SegmentlineType;
+
+	// from the inner to the outer retina
+	const SegmentlineType boundaryTypes[] = { SegmentlineType::ILM
+	                                        , SegmentlineType::RNFL
+	                                        , SegmentlineType::GCL
+	                                        , SegmentlineType::IPL
+	                                        , SegmentlineType::INL
+	                                        , SegmentlineType::OPL
+	                                        , SegmentlineType::ELM
+	                                        , SegmentlineType::PR1
+	                                        , SegmentlineType::RPE
+	                                        , SegmentlineType::BM  };
+	const std::size_t numBoundaries = sizeof(boundaryTypes)/sizeof(boundaryTypes[0]);
+
+	// gray values of the layers above, between and below the boundaries
+	const double layerIntensity[numBoundaries + 1] = { 8, 170, 95, 135, 60, 120, 45, 150, 110, 230, 140 };
+
+	const double scanDepth = 1.9;                                   // mm, depth of a BScan
+	const double pi        = 3.14159265358979323846;
+
+	struct Point
+	{
+		double x = 0;
+		double y = 0;
+		Point() = default;
+		Point(double x, double y) : x(x), y(y) {}
+	};
+
+	// position of the BScan in mm relative to the SLO image
+	struct BScanGeometry
+	{
+		OctData::BScan::BScanType type = OctData::BScan::BScanType::Line;
+		Point start;
+		Point end;
+		Point center;
+		double radius = 0;
+
+		Point getAScanPos(int ascan, int width) const
+		{
+			const double v = width > 1 ? static_cast<double>(ascan)/static_cast<double>(width - 1) : 0.5;
+			if(type == OctData::BScan::BScanType::Circle)
+			{
+				const double angle = -v*2.*pi;                        // counterclockwise, starts right of the center
+				return Point(center.x + std::cos(angle)*radius, center.y + std::sin(angle)*radius);
+			}
+			return Point(start.x*(1-v) + end.x*v, start.y*(1-v) + end.y*v);
+		}
+
+		double getLength() const
+		{
+			if(type == OctData::BScan::BScanType::Circle)
+				return 2.*pi*radius;
+			return std::hypot(end.x - start.x, end.y - start.y);
+		}
+	};
+
+	double getSloScale(const SyntheticOct::Config& config)      { return config.sloFieldSize/std::max(config.sloWidth, 1); }
+	Point  getSloCenter(const SyntheticOct::Config& config)     { const double s = getSloScale(config); return Point(config.sloWidth*s/2, config.sloHeight*s/2); }
+	Point  getOnhCenter(const SyntheticOct::Config& config)     { const Point c = getSloCenter(config); return Point(c.x + 3.8, c.y + 0.3); }
+	double getZScale   (const SyntheticOct::Config& config)     { return scanDepth/std::max(config.bscanHeight, 1); }
+
+	BScanGeometry createGeometry(const SyntheticOct::Config& config, std::size_t bscan)
+	{
+		const Point  c = getSloCenter(config);
+		const double s = config.scanSize;
+		const double n = static_cast<double>(config.numBScans);
+		const double i = static_cast<double>(bscan);
+
+		BScanGeometry geometry;
+		geometry.center = c;
+		switch(config.pattern)
+		{
+			case SyntheticOct::ScanPattern::Line:
+			{
+				const double y = config.numBScans > 1 ? s*(i/(n - 1) - 0.5) : 0;
+				geometry.start = Point(c.x - s/2, c.y + y);
+				geometry.end   = Point(c.x + s/2, c.y + y);
+				break;
+			}
+			case SyntheticOct::ScanPattern::Radial:
+			{
+				const double angle = pi*i/n;
+				geometry.start = Point(c.x - std::cos(angle)*s/2, c.y - std::sin(angle)*s/2);
+				geometry.end   = Point(c.x + std::cos(angle)*s/2, c.y + std::sin(angle)*s/2);
+				break;
+			}
+			case SyntheticOct::ScanPattern::Circle:
+				geometry.type   = OctData::BScan::BScanType::Circle;
+				geometry.radius = s/2*(i + 1)/n;
+				geometry.start  = Point(c.x + geometry.radius, c.y);
+				geometry.end    = geometry.start;
+				break;
+		}
+		return geometry;
+	}
+
+	// depth of the boundaries in mm at a position of the fundus (mm), without noise
+	void layerModel(const SyntheticOct::Config& config, const Point& pos, double depth[numBoundaries])
+	{
+		const Point fovea = getSloCenter(config);
+		const Point onh   = getOnhCenter(config);
+
+		const double r2    = (pos.x - fovea.x)*(pos.x - fovea.x) + (pos.y - fovea.y)*(pos.y - fovea.y);
+		const double onh2  = (pos.x - onh  .x)*(pos.x - onh  .x) + (pos.y - onh  .y)*(pos.y - onh  .y);
+		const double pit   = 1. - std::exp(-r2/(2*0.35*0.35));       // 0 in the fovea, 1 outside
+		const double nerve = std::exp(-onh2/(2*0.8*0.8));
+
+		// thickness of the layers in µm, from BM to ILM
+		const double thickness[numBoundaries - 1] = { 20                                      // RPE  - BM
+		                                            , 40                                      // PR1  - RPE
+		                                            , 20                                      // ELM  - PR1
+		                                            , 70 + 30*(1 - pit)                       // OPL  - ELM (ONL)
+		                                            , 5 + 25*pit                              // INL  - OPL
+		                                            , 35*pit                                  // IPL  - INL
+		                                            , 38*pit                                  // GCL  - IPL
+		                                            , 45*pit                                  // RNFL - GCL
+		                                            , 5 + 30*pit*(0.5 + std::sqrt(r2)/6) + 80*nerve };
+
+		depth[numBoundaries - 1] = scanDepth*0.65 - 0.012*r2;
+		for(std::size_t b = numBoundaries - 1; b > 0; --b)
+			depth[b - 1] = depth[b] - thickness[numBoundaries - 1 - b]/1000.;
+	}
+
+	std::mt19937 createRng(const SyntheticOct::Config& config, std::size_t bscan, unsigned stream)
+	{
+		std::seed_seq seq{ config.seed, static_cast<unsigned>(bscan), stream };
+		return std::mt19937(seq);
+	}
+
+	cv::Mat createBScanImage(const SyntheticOct::Config& config, const std::vector<std::vector<double>>& boundaries, std::size_t bscan)
+	{
+		const int    width  = config.bscanWidth;
+		const int    height = config.bscanHeight;
+		const double zScale = getZScale(config);
+
+		std::mt19937 rng = createRng(config, bscan, 2);
+		std::normal_distribution<double> speckle(0, config.imageNoise);
+
+		cv::Mat image(height, width, CV_8UC1);
+		for(int x = 0; x < width; ++x)
+		{
+			std::size_t layer = 0;
+			for(int z = 0; z < height; ++z)
+			{
+				while(layer < numBoundaries && z >= boundaries[layer][static_cast<std::size_t>(x)])
+					++layer;
+
+				double value = layerIntensity[layer];
+				if(layer == numBoundaries)                          // choroid, fading with the depth
+					value = 15 + value*std::exp(-(z - boundaries[numBoundaries - 1][static_cast<std::size_t>(x)])*zScale/0.25);
+
+				value += speckle(rng);
+				image.at<uint8_t>(z, x) = cv::saturate_cast<uint8_t>(value);
+			}
+		}
+		return image;
+	}
+
+	cv::Mat createSloImage(const SyntheticOct::Config& config)
+	{
+		const double scale = getSloScale(config);
+		const Point  fovea = getSloCenter(config);
+		const Point  onh   = getOnhCenter(config);
+
+		std::mt19937 rng = createRng(config, 0, 1);
+		std::normal_distribution<double> noise(0, config.imageNoise/2);
+
+		cv::Mat image(config.sloHeight, config.sloWidth, CV_8UC1);
+		for(int y = 0; y < config.sloHeight; ++y)
+		{
+			for(int x = 0; x < config.sloWidth; ++x)
+			{
+				const double px = x*scale;
+				const double py = y*scale;
+				const double r2   = (px - fovea.x)*(px - fovea.x) + (py - fovea.y)*(py - fovea.y);
+				const double onh2 = (px - onh  .x)*(px - onh  .x) + (py - onh  .y)*(py - onh  .y);
+
+				double value = 40 + 80*std::exp(-r2/(2*9.))             // vignetting
+				             - 30*std::exp(-r2/(2*0.4*0.4))             // fovea
+				             + 110*std::exp(-onh2/(2*0.75*0.75));       // optic nerve head
+				image.at<uint8_t>(y, x) = cv::saturate_cast<uint8_t>(value + noise(rng));
+			}
+		}
+		return image;
+	}
+
+	std::vector<uint8_t> createMask(const SyntheticOct::Config& config, const std::vector<std::vector<double>>& boundaries)
+	{
+		const std::size_t width  = static_cast<std::size_t>(config.bscanWidth);
+		const std::size_t height = static_cast<std::size_t>(config.bscanHeight);
+		const std::vector<double>& ilm = boundaries.front();
+		const std::vector<double>& bm  = boundaries.back();
+
+		std::vector<uint8_t> mask(width*height, 0);
+		for(std::size_t z = 0; z < height; ++z)
+		{
+			const double depth = static_cast<double>(z);
+			for(std::size_t x = 0; x < width; ++x)
+				if(depth >= ilm[x] && depth < bm[x])
+					mask[z*width + x] = 1;
+		}
+		return mask;
+	}
+
+
+	void fillLayerSegmentation(const SyntheticOct::Config& config, bpt::ptree& moduleNode)
+	{
+		const std::vector<std::string>& names = SyntheticOct::getBoundaryNames();
+		for(std::size_t bscan = 0; bscan < config.numBScans; ++bscan)
+		{
+			const std::vector<std::vector<double>> boundaries = SyntheticOct::createBoundaries(config, bscan);
+
+			PTreeHelper::NodeCreator bscanNode("BScan", moduleNode);
+			bscanNode.setId(bscan);
+			PTreeHelper::NodeCreator linesNode("Lines", bscanNode);
+			for(std::size_t b = 0; b < boundaries.size(); ++b)
+				linesNode.getNode().put(names[b], SegmentlineCodec::encode(boundaries[b], SegmentlineCodec::Encoding::Float32Base64));
+		}
+	}
+
+	void fillSegmentation(const SyntheticOct::Config& config, bpt::ptree& moduleNode)
+	{
+		// free formed segmentation: area between ILM and BM
+		std::vector<std::string> serialized(config.numBScans);
+		ParallelFor::run(config.numBScans, [&](std::size_t bscan)
+		{
+			const std::vector<uint8_t> mask = createMask(config, SyntheticOct::createBoundaries(config, bscan));
+			SimpleMatCompress compressed;
+			compressed.readFromMat(mask.data(), config.bscanHeight, config.bscanWidth);
+			serialized[bscan] = compressed.toSerializationString(SimpleMatCompress::SerializationFormat::BinaryDeflate);
+		});
+
+		bpt::ptree& ilmNode = PTreeHelper::get_put(moduleNode, "ILM");
+		for(std::size_t bscan = 0; bscan < config.numBScans; ++bscan)
+		{
+			bpt::ptree& bscanNode = ilmNode.add("BScan", "");
+			bscanNode.add("ID", bscan);
+			bscanNode.put("matCompress", serialized[bscan]);
+		}
+	}
+
+	void fillIntervalMarker(const SyntheticOct::Config& config, bpt::ptree& moduleNode, std::mt19937& rng)
+	{
+		// collection and classes of DefinedIntervalMarker
+		const char* classes[] = { "signalmissing", "ILM_upper", "ILM_lower", "BM_upper", "BM_lower" };
+		std::uniform_int_distribution<int> classDist(0, 4);
+		std::uniform_int_distribution<int> posDist(0, std::max(config.bscanWidth - 1, 0));
+
+		bpt::ptree& collectionNode = PTreeHelper::get_put(moduleNode, "qualityFailures");
+		for(std::size_t bscan = 0; bscan < config.numBScans; ++bscan)
+		{
+			bpt::ptree& bscanNode = collectionNode.add("BScan", "");
+			bscanNode.add("ID", bscan);
+
+			int a = posDist(rng);
+			int b = posDist(rng);
+			if(a == b)
+				continue;
+
+			bpt::ptree& intervallNode = bscanNode.add("Intervall", "");
+			intervallNode.add("Start", std::min(a, b));
+			intervallNode.add("End"  , std::max(a, b));
+			intervallNode.add("Class", classes[classDist(rng)]);
+		}
+	}
+
+	void fillObjectsMarker(const SyntheticOct::Config& config, bpt::ptree& moduleNode, std::mt19937& rng)
+	{
+		std::uniform_real_distribution<double> xDist(0, config.bscanWidth *0.8);
+		std::uniform_real_distribution<double> yDist(0, config.bscanHeight*0.8);
+
+		for(std::size_t bscan = 0; bscan < config.numBScans; bscan += 4)
+		{
+			bpt::ptree& bscanNode   = PTreeHelper::getNodeWithId(moduleNode, "BScan", static_cast<int>(bscan));
+			bpt::ptree& objectsNode = bscanNode.add("Objects", "");
+
+			bpt::ptree itemNode;
+			itemNode.put("ItemType", "Rect");
+			itemNode.put("PosX"    , xDist(rng));
+			itemNode.put("PosY"    , yDist(rng));
+			itemNode.put("Height"  , config.bscanHeight*0.1);
+			itemNode.put("Width"   , config.bscanWidth *0.1);
+			objectsNode.push_back(std::make_pair("", itemNode));
+		}
+	}
+
+	void fillScanClassifier(const SyntheticOct::Config& config, bpt::ptree& moduleNode)
+	{
+		// classifiers of DefinedClassifierMarker
+		bpt::ptree& scanNode = PTreeHelper::get_put(moduleNode, "Scan");
+		scanNode.put("scanArea"  , config.pattern == SyntheticOct::ScanPattern::Circle ? "onh" : "macular");
+		scanNode.put("scanUsable", "usable");
+
+		bpt::ptree& bscansNode = PTreeHelper::get_put(moduleNode, "BScans");
+		for(std::size_t bscan = 0; bscan < config.numBScans; ++bscan)
+		{
+			bpt::ptree& bscanNode = PTreeHelper::getNodeWithId(bscansNode, "BScan", static_cast<int>(bscan));
+			bscanNode.put("bscanAttributes", bscan%2 == 0 ? "attr1;attr3" : "attr2");
+		}
+	}
+
+	void fillSloObjects(const SyntheticOct::Config& config, bpt::ptree& moduleNode)
+	{
+		const Point onh = getOnhCenter(config);
+
+		bpt::ptree& onhNode = PTreeHelper::get_put(moduleNode, "Objects.ONH");
+		onhNode.put("ItemType"  , "Rect");
+		onhNode.put("CenterPosX", onh.x);
+		onhNode.put("CenterPosY", onh.y);
+		onhNode.put("Height"    , 1.5);
+		onhNode.put("Width"     , 1.5);
+	}
+}
+
+
+bool SyntheticOct::parseScanPattern(const std::string& name, ScanPattern& pattern)
+{
+	for(ScanPattern p : { ScanPattern::Line, ScanPattern::Circle, ScanPattern::Radial })
+	{
+		if(name == getScanPatternName(p))
+		{
+			pattern = p;
+			return true;
+		}
+	}
+	return false;
+}
+
+const char* SyntheticOct::getScanPatternName(ScanPattern pattern)
+{
+	switch(pattern)
+	{
+		case ScanPattern::Line  : return "line";
+		case ScanPattern::Circle: return "circle";
+		case ScanPattern::Radial: return "radial";
+	}
+	return "";
+}
+
+
+const std::vector<std::string>& SyntheticOct::getBoundaryNames()
+{
+	static std::vector<std::string> names;
+	if(names.empty())
+		for(SegmentlineType type : boundaryTypes)
+			names.push_back(OctData::Segmentationlines::getSegmentlineName(type));
+	return names;
+}
+
+std::vector<std::vector<double>> SyntheticOct::createBoundaries(const Config& config, std::size_t bscan)
+{
+	const BScanGeometry geometry = createGeometry(config, bscan);
+	const std::size_t   width    = static_cast<std::size_t>(std::max(config.bscanWidth, 0));
+	const double        zScale   = getZScale(config);
+	const double        maxDepth = config.bscanHeight - 1;
+
+	std::vector<std::vector<double>> boundaries(numBoundaries, std::vector<double>(width));
+
+	std::mt19937 rng = createRng(config, bscan, 0);
+	// smooth noise (AR(1) process with the standard deviation boundaryNoise) plus a small uncorrelated part
+	const double smoothFactor = 0.9;
+	std::normal_distribution<double> smoothNoise(0, config.boundaryNoise*std::sqrt(1 - smoothFactor*smoothFactor));
+	std::normal_distribution<double> pointNoise (0, config.boundaryNoise*0.2);
+	std::vector<double> noiseState(numBoundaries, 0);
+
+	double depth[numBoundaries];
+	for(std::size_t x = 0; x < width; ++x)
+	{
+		layerModel(config, geometry.getAScanPos(static_cast<int>(x), config.bscanWidth), depth);
+
+		double lastValue = 0;
+		for(std::size_t b = 0; b < numBoundaries; ++b)
+		{
+			noiseState[b] = noiseState[b]*smoothFactor + smoothNoise(rng);
+
+			double value = depth[b]/zScale + noiseState[b] + pointNoise(rng);
+			value = std::min(std::max(value, lastValue), maxDepth);  // the boundaries don't cross
+			boundaries[b][x] = value;
+			lastValue = value;
+		}
+	}
+	return boundaries;
+}
+
+
+std::unique_ptr<OctData::OCT> SyntheticOct::createOct(const Config& config)
+{
+	std::unique_ptr<OctData::OCT> oct(new OctData::OCT);
+
+	OctData::Patient& patient = oct->getPatient(1);
+	OctData::Study  & study   = patient.getStudy(1);
+	OctData::Series & series  = study.getSeries(1);
+
+	switch(config.pattern)
+	{
+		case ScanPattern::Line  : series.setScanPattern(config.numBScans > 1 ? OctData::Series::ScanPattern::Volume : OctData::Series::ScanPattern::SingleLine); break;
+		case ScanPattern::Circle: series.setScanPattern(OctData::Series::ScanPattern::Circular); break;
+		case ScanPattern::Radial: series.setScanPattern(OctData::Series::ScanPattern::Radial  ); break;
+	}
+	series.setLaterality(OctData::Series::Laterality::OD);
+
+	const double sloScale = getSloScale(config);
+	OctData::SloImage* slo = new OctData::SloImage;
+	slo->setImage(createSloImage(config));
+	slo->setScaleFactor(OctData::ScaleFactor(sloScale, sloScale, 0));
+	series.takeSloImage(slo);
+
+	// the BScans are independent, only the insertion into the series is sequential
+	std::vector<OctData::BScan*> bscans(config.numBScans, nullptr);
+	ParallelFor::run(config.numBScans, [&](std::size_t bscan)
+	{
+		const BScanGeometry geometry = createGeometry(config, bscan);
+		const std::vector<std::vector<double>> boundaries = createBoundaries(config, bscan);
+
+		OctData::BScan::Data data;
+		data.bscanType    = geometry.type;
+		data.start        = OctData::CoordSLOmm(geometry.start .x, geometry.start .y);
+		data.end          = OctData::CoordSLOmm(geometry.end   .x, geometry.end   .y);
+		data.center       = OctData::CoordSLOmm(geometry.center.x, geometry.center.y);
+		data.clockwiseRot = false;
+
+		const double spacing = config.numBScans > 1 && config.pattern == ScanPattern::Line ? config.scanSize/static_cast<double>(config.numBScans - 1) : 0;
+		data.scaleFactor = OctData::ScaleFactor(geometry.getLength()/std::max(config.bscanWidth - 1, 1), spacing, getZScale(config));
+
+		for(std::size_t b = 0; b < numBoundaries; ++b)
+			data.getSegmentLine(boundaryTypes[b]) = boundaries[b];
+
+		cv::Mat image;
+		if(config.withImages)
+			image = createBScanImage(config, boundaries, bscan);
+
+		bscans[bscan] = new OctData::BScan(image, data);
+	});
+
+	for(OctData::BScan* bscan : bscans)
+		series.takeBScan(bscan);
+
+	return oct;
+}
+
+const OctData::Series* SyntheticOct::getSeries(const OctData::OCT& oct)
+{
+	for(const OctData::OCT::SubstructurePair& patientPair : oct)
+		for(const OctData::Patient::SubstructurePair& studyPair : *patientPair.second)
+			for(const OctData::Study::SubstructurePair& seriesPair : *studyPair.second)
+				return seriesPair.second;
+	return nullptr;
+}
+
+
+void SyntheticOct::fillMarkers(const Config& config, const OctData::OCT& oct, bpt::ptree& markerTree)
+{
+	for(const OctData::OCT::SubstructurePair& patientPair : oct)
+	{
+		const OctData::Patient* patient = patientPair.second;
+		bpt::ptree& patNode = PTreeHelper::getNodeWithId(markerTree, "Patient", patient->getInternalId());
+		for(const OctData::Patient::SubstructurePair& studyPair : *patient)
+		{
+			const OctData::Study* study = studyPair.second;
+			bpt::ptree& studyNode = PTreeHelper::getNodeWithId(patNode, "Study", study->getInternalId());
+			for(const OctData::Study::SubstructurePair& seriesPair : *study)
+			{
+				bpt::ptree& seriesNode = PTreeHelper::getNodeWithId(studyNode, "Series", seriesPair.second->getInternalId());
+
+				// module ids of the marker modules (BscanMarkerBase::getMarkerId)
+				std::mt19937 rng = createRng(config, 0, 3);
+				fillSegmentation     (config, PTreeHelper::get_put(seriesNode, "SegmentationMarker"));
+				fillLayerSegmentation(config, PTreeHelper::get_put(seriesNode, "LayerSegmentation" ));
+				fillIntervalMarker   (config, PTreeHelper::get_put(seriesNode, "IntervalMarker"    ), rng);
+				fillObjectsMarker    (config, PTreeHelper::get_put(seriesNode, "ObjectsMarker"     ), rng);
+				fillScanClassifier   (config, PTreeHelper::get_put(seriesNode, "ScanClassifier"    ));
+				fillSloObjects       (config, PTreeHelper::get_put(seriesNode, "SloObjects"        ));
+			}
+		}
+	}
+}
+
+
+bool SyntheticOct::writeOct(const std::string& octFilename, const OctData::OCT& oct)
+{
+	OctData::FileWriteOptions fwo;
+	return OctData::OctFileRead::writeFile(octFilename, oct, fwo);
+}
+
+bool SyntheticOct::writeMarkers(const std::string& octFilename, bpt::ptree& markerTree, OctMarkerFileformat format)
+{
+	OctMarkerIO markerIO(&markerTree);
+	return markerIO.saveMarkers(OctMarkerIO::addMarkerExtension(octFilename, format), format);
+}
@@ -0,0 +1,60 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <memory>
+#include <cstdint>
+
+#include <boost/property_tree/ptree_fwd.hpp>
+
+#include <globaldefinitions.h>
+
+namespace OctData
+{
+	class OCT;
+	class Series;
+}
+
+
+// synthetic OCT data for tests and benchmarks, without proprietary files
+// the data is fully defined by the configuration (including the seed of the noise)
+namespace SyntheticOct
+{
+	enum class ScanPattern { Line, Circle, Radial };              // Line: volume of parallel lines, Circle: concentric circles
+
+	struct Config
+	{
+		ScanPattern pattern     = ScanPattern::Line;
+		std::size_t numBScans   = 49;
+		int         bscanWidth  = 512;
+		int         bscanHeight = 496;
+		int         sloWidth    = 768;
+		int         sloHeight   = 768;
+
+		double      sloFieldSize = 9.0;                             // mm, width of the SLO image
+		double      scanSize     = 6.0;                             // mm, length of the line scans, diameter of the first circle
+		double      boundaryNoise = 1.5;                            // pixel, standard deviation of the layer boundaries
+		double      imageNoise    = 12.0;                           // gray values, standard deviation of the speckle
+		unsigned    seed          = 1;
+
+		bool        withImages    = true;                           // false: BScans without image data (only geometry and lines)
+	};
+
+	bool parseScanPattern(const std::string& name, ScanPattern& pattern);
+	const char* getScanPatternName(ScanPattern pattern);
+
+	// one patient, study and series, the series is the first one of the returned OCT
+	std::unique_ptr<OctData::OCT> createOct(const Config& config);
+	const OctData::Series* getSeries(const OctData::OCT& oct);
+
+	// layer boundaries of one BScan in pixel, in the order of getBoundaryNames()
+	std::vector<std::vector<double>> createBoundaries(const Config& config, std::size_t bscan);
+	const std::vector<std::string>& getBoundaryNames();
+
+	// marker tree (Patient/Study/Series) with markers of every module, ids as in createOct
+	void fillMarkers(const Config& config, const OctData::OCT& oct, boost::property_tree::ptree& markerTree);
+
+	// writes the OCT data with the OCT writer of LibOctData and the markers as <octFilename>.<marker extension>
+	bool writeOct    (const std::string& octFilename, const OctData::OCT& oct);
+	bool writeMarkers(const std::string& octFilename, boost::property_tree::ptree& markerTree, OctMarkerFileformat format);
+}
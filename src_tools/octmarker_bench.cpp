@@ -0,0 +1,646 @@
+#include "helper/syntheticoct.h"
+
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <map>
+#include <chrono>
+#include <cstdlib>
+#include <cmath>
+#include <algorithm>
+#include <thread>
+
+#include <boost/property_tree/ptree.hpp>
+#include <boost/property_tree/json_parser.hpp>
+#include <boost/filesystem.hpp>
+#include <boost/icl/interval_map.hpp>
+
+#include <opencv2/opencv.hpp>
+
+#include <octdata/datastruct/oct.h>
+#include <octdata/datastruct/series.h>
+#include <octdata/datastruct/bscan.h>
+#include <octdata/datastruct/sloimage.h>
+
+#include <data_structure/simplematcompress.h>
+#include <data_structure/slobscandistancemap.h>
+#include <data_structure/intervalmarker.h>
+#include <data_structure/point2d.h>
+#include <manager/octmarkerio.h>
+#include <algos/overlayblend.h>
+#include <markermodules/bscanlayersegmentation/thicknessmap.h>
+#include <markermodules/bscanlayersegmentation/colormaphsv.h>
+#include <markermodules/bscanlayersegmentation/pchip.h>
+#include <markermodules/bscanlayersegmentation/findsupportingpoints.h>
+#include <markermodules/bscanintervalmarker/slointervallmap.h>
+#include <markermodules/bscansegmentation/bscansegalgorithm.h>
+
+namespace bpt = boost::property_tree;
+namespace bfs = boost::filesystem;
+
+using SegmentlineType = OctData::Segmentationlines::SegmentlineType;
+
+
+// microbenchmarks of the hot kernels with fixed synthetic inputs (SyntheticOct, default configuration, seed 1)
+// the results are written as JSON or CSV, with --baseline the medians are compared with an earlier JSON result
+// --verify checks the results of the kernels with the same inputs instead of measuring them
+namespace
+{
+	volatile std::size_t benchmarkSink = 0;                         // results are added here, so that the compiler can't drop the kernels
+
+	void doNotOptimize(std::size_t value)                       { benchmarkSink = benchmarkSink + value; }
+
+
+	struct Result
+	{
+		std::string name;
+		std::size_t iterations = 0;
+		double      minMs      = 0;
+		double      medianMs   = 0;
+		double      meanMs     = 0;
+		double      maxMs      = 0;
+	};
+
+	class BenchmarkRunner
+	{
+		double              minTimeMs;
+		std::size_t         minIterations;
+		std::string         filter;
+		std::vector<Result> results;
+
+	public:
+		BenchmarkRunner(double minTimeMs, std::size_t minIterations, const std::string& filter)
+		: minTimeMs    (minTimeMs    )
+		, minIterations(minIterations)
+		, filter       (filter       )
+		{}
+
+		bool isSelected(const std::string& name) const          { return filter.empty() || name.find(filter) != std::string::npos; }
+
+		// one warm up call, then at least minIterations calls and minTimeMs
+		template<typename Fun>
+		void run(const std::string& name, Fun fun)
+		{
+			if(!isSelected(name))
+				return;
+
+			typedef std::chrono::steady_clock Clock;
+			fun();
+
+			std::vector<double> times;
+			double totalMs = 0;
+			while(times.size() < minIterations || (totalMs < minTimeMs && times.size() < 100000))
+			{
+				const Clock::time_point start = Clock::now();
+				fun();
+				const double ms = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+				times.push_back(ms);
+				totalMs += ms;
+			}
+
+			std::sort(times.begin(), times.end());
+			const std::size_t n = times.size();
+
+			Result result;
+			result.name       = name;
+			result.iterations = n;
+			result.minMs      = times.front();
+			result.maxMs      = times.back();
+			result.meanMs     = totalMs/static_cast<double>(n);
+			result.medianMs   = n%2 == 1 ? times[n/2] : (times[n/2 - 1] + times[n/2])/2;
+			results.push_back(result);
+
+			std::cerr << name << ": " << result.medianMs << " ms (median of " << n << ")\n";
+		}
+
+		const std::vector<Result>& getResults() const           { return results; }
+	};
+
+
+	void writeJson(std::ostream& stream, const std::vector<Result>& results, const SyntheticOct::Config& config)
+	{
+		stream << "{\n\t\"config\": {\"bscans\": " << config.numBScans
+		       << ", \"bscanWidth\": " << config.bscanWidth << ", \"bscanHeight\": " << config.bscanHeight
+		       << ", \"sloWidth\": " << config.sloWidth << ", \"sloHeight\": " << config.sloHeight
+		       << ", \"seed\": " << config.seed << ", \"threads\": " << std::thread::hardware_concurrency() << "},\n"
+		          "\t\"benchmarks\": [";
+
+		const char* separator = "\n";
+		for(const Result& result : results)
+		{
+			stream << separator << "\t\t{\"name\": \"" << result.name << "\", \"iterations\": " << result.iterations
+			       << ", \"min_ms\": " << result.minMs << ", \"median_ms\": " << result.medianMs
+			       << ", \"mean_ms\": " << result.meanMs << ", \"max_ms\": " << result.maxMs << '}';
+			separator = ",\n";
+		}
+		stream << "\n\t]\n}\n";
+	}
+
+	void writeCsv(std::ostream& stream, const std::vector<Result>& results)
+	{
+		stream << "name,iterations,min_ms,median_ms,mean_ms,max_ms\n";
+		for(const Result& result : results)
+			stream << result.name << ',' << result.iterations << ',' << result.minMs << ','
+			       << result.medianMs << ',' << result.meanMs << ',' << result.maxMs << '\n';
+	}
+
+	// medians of an earlier json result, false if the file can't be read
+	bool readBaseline(const std::string& baselineFilename, std::map<std::string, double>& baselineMedians)
+	{
+		try
+		{
+			bpt::ptree baselineTree;
+			bpt::read_json(baselineFilename, baselineTree);
+
+			for(const std::pair<const std::string, bpt::ptree>& benchmarkNode : baselineTree.get_child("benchmarks"))
+				baselineMedians[benchmarkNode.second.get<std::string>("name")] = benchmarkNode.second.get<double>("median_ms");
+		}
+		catch(const bpt::ptree_error& e)
+		{
+			std::cerr << "can't read baseline " << baselineFilename << ": " << e.what() << '\n';
+			return false;
+		}
+		return true;
+	}
+
+	// returns the number of benchmarks whose median is more than tolerance (fraction) slower than in the baseline
+	int compareWithBaseline(const std::map<std::string, double>& baselineMedians, const std::vector<Result>& results, double tolerance)
+	{
+		int regressions = 0;
+		for(const Result& result : results)
+		{
+			std::map<std::string, double>::const_iterator it = baselineMedians.find(result.name);
+			if(it == baselineMedians.end() || it->second <= 0)
+				continue;
+
+			const double ratio = result.medianMs/it->second;
+			if(ratio > 1. + tolerance)
+			{
+				std::cerr << "regression " << result.name << ": " << result.medianMs << " ms, baseline " << it->second << " ms (x" << ratio << ")\n";
+				++regressions;
+			}
+		}
+		return regressions;
+	}
+
+
+	// input data of the benchmarks, created once
+	struct Inputs
+	{
+		SyntheticOct::Config           config;
+		std::unique_ptr<OctData::OCT>  oct;
+		const OctData::Series*         series = nullptr;
+		bpt::ptree                     markerTree;
+
+		std::vector<cv::Mat>           masks;                           // free form segmentation (SegmentationMarker), one per BScan
+		std::vector<std::string>       maskStrings[3];                  // serialized masks, index: SimpleMatCompress::SerializationFormat
+		std::vector<std::vector<double>>  ilmLines;
+		std::vector<std::vector<Point2D>> ilmSupportingPoints;
+		std::vector<BScanLayerSegmentation::BScanSegData> segData;
+		std::vector<BScanIntervalMarker::MarkerMap>       intervalMarkers;
+		std::vector<IntervalMarker::Marker>               intervalTypes;
+
+		SloBScanDistanceMap            distanceMap;
+		ColormapHSV                    colormap;
+		cv::Mat                        sloImage;
+		cv::Mat                        sloOverlay;                      // thickness map (BGRA)
+
+		Inputs();
+	};
+
+	const SimpleMatCompress::SerializationFormat serializationFormats[] = { SimpleMatCompress::SerializationFormat::TextArchive
+	                                                                      , SimpleMatCompress::SerializationFormat::Binary
+	                                                                      , SimpleMatCompress::SerializationFormat::BinaryDeflate };
+	const char* const serializationFormatNames[] = { "text_archive", "binary", "binary_deflate" };
+
+	Inputs::Inputs()
+	: oct(SyntheticOct::createOct(config))
+	, series(SyntheticOct::getSeries(*oct))
+	{
+		SyntheticOct::fillMarkers(config, *oct, markerTree);
+
+		// masks from the marker tree (as written by the SegmentationMarker module)
+		const bpt::ptree& maskModuleNode = markerTree.get_child("Patient.Study.Series.SegmentationMarker.ILM");
+		for(const std::pair<const std::string, bpt::ptree>& bscanNode : maskModuleNode)
+		{
+			if(bscanNode.first != "BScan")
+				continue;
+
+			SimpleMatCompress compressed;
+			if(!compressed.fromSerializationString(bscanNode.second.get<std::string>("matCompress")))
+				continue;
+
+			cv::Mat mask(compressed.getRows(), compressed.getCols(), CV_8UC1);
+			compressed.writeToMat(mask.ptr<uint8_t>(), mask.rows, mask.cols);
+			masks.push_back(mask);
+
+			for(std::size_t format = 0; format < 3; ++format)
+				maskStrings[format].push_back(compressed.toSerializationString(serializationFormats[format]));
+		}
+
+		for(std::size_t bscanNr = 0; bscanNr < series->bscanCount(); ++bscanNr)
+		{
+			const OctData::BScan* bscan = series->getBScan(bscanNr);
+
+			BScanLayerSegmentation::BScanSegData data;
+			data.lines  = bscan->getSegmentLines();
+			data.filled = true;
+			data.saved  = true;
+			data.lineModified.fill(false);
+			data.lineLoaded  .fill(true);
+			segData.push_back(data);
+
+			const OctData::Segmentationlines::Segmentline& ilm = data.lines.getSegmentLine(SegmentlineType::ILM);
+			ilmLines.push_back(std::vector<double>(ilm.begin(), ilm.end()));
+
+			FindSupportingPoints findPoints(ilmLines.back());
+			findPoints.calculateSupportingPoints();
+			ilmSupportingPoints.push_back(findPoints.getSupportingPoints());
+		}
+
+		// interval markers: some classified intervals on every BScan, as after a quality review
+		intervalTypes.push_back(IntervalMarker::Marker("good"    , "good"    ,   0, 255, 0));
+		intervalTypes.push_back(IntervalMarker::Marker("bad"     , "bad"     , 255,   0, 0));
+		intervalTypes.push_back(IntervalMarker::Marker("unsecure", "unsecure", 255, 255, 0));
+		intervalMarkers.resize(series->bscanCount());
+		for(std::size_t bscan = 0; bscan < intervalMarkers.size(); ++bscan)
+		{
+			const int width   = config.bscanWidth;
+			const int section = std::max(width/8, 1);
+			for(int start = 0, type = static_cast<int>(bscan%3); start + section <= width; start += section, type = (type + 1)%3)
+				intervalMarkers[bscan].set(std::make_pair(boost::icl::discrete_interval<int>::closed(start, start + section - 1), intervalTypes[static_cast<std::size_t>(type)]));
+		}
+
+		distanceMap.createData(series);
+
+		colormap.setMaxValue(400);
+		ThicknessMap thicknessMap;
+		const double zScale = series->getBScan(0)->getScaleFactor().getZ()*1000;
+		thicknessMap.createMap(distanceMap, segData, SegmentlineType::ILM, SegmentlineType::BM, zScale, colormap);
+		sloOverlay = thicknessMap.getThicknessMap().clone();
+		sloImage   = series->getSloImage().getImage();
+	}
+
+
+	void runBenchmarks(BenchmarkRunner& runner, const Inputs& inputs)
+	{
+		// SimpleMatCompress
+		for(std::size_t format = 0; format < 3; ++format)
+		{
+			const std::string suffix = serializationFormatNames[format];
+			runner.run("simplematcompress/encode_" + suffix, [&]()
+			{
+				for(const cv::Mat& mask : inputs.masks)
+				{
+					SimpleMatCompress compressed;
+					compressed.readFromMat(mask.ptr<uint8_t>(), mask.rows, mask.cols);
+					doNotOptimize(compressed.toSerializationString(serializationFormats[format]).size());
+				}
+			});
+
+			runner.run("simplematcompress/decode_" + suffix, [&]()
+			{
+				cv::Mat mask;
+				for(const std::string& str : inputs.maskStrings[format])
+				{
+					SimpleMatCompress compressed;
+					compressed.fromSerializationString(str);
+					mask.create(compressed.getRows(), compressed.getCols(), CV_8UC1);
+					compressed.writeToMat(mask.ptr<uint8_t>(), mask.rows, mask.cols);
+					doNotOptimize(mask.ptr<uint8_t>()[0]);
+				}
+			});
+		}
+
+		// SLO maps
+		runner.run("slobscandistancemap/create_data", [&]()
+		{
+			SloBScanDistanceMap distanceMap;
+			distanceMap.createData(inputs.series);
+			doNotOptimize(distanceMap.getDataMatrix()->getSizeX());
+		});
+
+		runner.run("thicknessmap/create_map", [&]()
+		{
+			ThicknessMap thicknessMap;
+			const double zScale = inputs.series->getBScan(0)->getScaleFactor().getZ()*1000;
+			thicknessMap.createMap(inputs.distanceMap, inputs.segData, SegmentlineType::ILM, SegmentlineType::BM, zScale, inputs.colormap);
+			doNotOptimize(static_cast<std::size_t>(thicknessMap.getThicknessMap().cols));
+		});
+
+		runner.run("slointervallmap/create_map", [&]()
+		{
+			SloIntervallMap intervallMap;
+			intervallMap.createMap(inputs.distanceMap, inputs.intervalMarkers, inputs.series);
+			doNotOptimize(static_cast<std::size_t>(intervallMap.getSloMap().cols));
+		});
+
+		// layer segmentation
+		runner.run("pchip/ilm", [&]()
+		{
+			for(const std::vector<Point2D>& points : inputs.ilmSupportingPoints)
+			{
+				PChip pchip(points, static_cast<std::size_t>(inputs.config.bscanWidth));
+				doNotOptimize(pchip.getValues().size());
+			}
+		});
+
+		runner.run("findsupportingpoints/ilm", [&]()
+		{
+			for(const std::vector<double>& line : inputs.ilmLines)
+			{
+				FindSupportingPoints findPoints(line);
+				findPoints.calculateSupportingPoints();
+				doNotOptimize(findPoints.getSupportingPoints().size());
+			}
+		});
+
+		// free form segmentation (PartitionFromGrayValueWorker)
+		BScanSegmentationMarker::ThresholdDirectionData thresholdData;
+		runner.run("bscansegalgorithm/threshold_direction", [&]()
+		{
+			cv::Mat segMat;
+			for(std::size_t bscan = 0; bscan < inputs.series->bscanCount(); ++bscan)
+			{
+				const cv::Mat& image = inputs.series->getBScan(bscan)->getImage();
+				segMat.create(image.rows, image.cols, CV_8UC1);
+				BScanSegAlgorithm::initFromThresholdDirection(image, segMat, thresholdData, BScanSegmentationMarker::paintArea0Value, BScanSegmentationMarker::paintArea1Value);
+				doNotOptimize(segMat.ptr<uint8_t>()[0]);
+			}
+		});
+
+		// marker files
+		const bfs::path tempDir = bfs::temp_directory_path() / bfs::unique_path("octmarker_bench_%%%%%%%%");
+		bfs::create_directories(tempDir);
+
+		struct MarkerFile { const char* name; OctMarkerFileformat format; bool compressed; };
+		const MarkerFile markerFiles[] = { { "json"   , OctMarkerFileformat::Json  , false }
+		                                 , { "json_gz", OctMarkerFileformat::Json  , true  }
+		                                 , { "xml"    , OctMarkerFileformat::XML   , false }
+		                                 , { "info"   , OctMarkerFileformat::INFO  , false }
+		                                 , { "bin"    , OctMarkerFileformat::Binary, false } };
+		for(const MarkerFile& markerFile : markerFiles)
+		{
+			std::string filename = OctMarkerIO::addMarkerExtension((tempDir / "bench.oct").string(), markerFile.format);
+			if(markerFile.compressed)
+				filename += ".gz";
+
+			bpt::ptree saveTree = inputs.markerTree;
+			OctMarkerIO saveIO(&saveTree);
+			runner.run(std::string("markerio/save_") + markerFile.name, [&]()
+			{
+				doNotOptimize(saveIO.saveMarkers(filename, markerFile.format));
+			});
+
+			if(!bfs::exists(filename))
+				saveIO.saveMarkers(filename, markerFile.format);
+			runner.run(std::string("markerio/load_") + markerFile.name, [&]()
+			{
+				bpt::ptree loadTree;
+				OctMarkerIO loadIO(&loadTree);
+				doNotOptimize(loadIO.loadMarkers(filename, markerFile.format));
+			});
+		}
+		bfs::remove_all(tempDir);
+
+		// SLO overlay (drawSLOOverlayImage), the full image and the region of a typical local change
+		runner.run("sloverlay/blend_full", [&]()
+		{
+			cv::Mat dest;
+			OverlayBlend::blend(inputs.sloImage, inputs.sloOverlay, dest, 0.5);
+			doNotOptimize(dest.ptr<uint8_t>()[0]);
+		});
+
+		cv::Mat regionDest;
+		OverlayBlend::blend(inputs.sloImage, inputs.sloOverlay, regionDest, 0.5);
+		const cv::Rect region(inputs.sloImage.cols/2 - 32, inputs.sloImage.rows/2 - 32, 64, 64);
+		runner.run("sloverlay/blend_region", [&]()
+		{
+			OverlayBlend::blend(inputs.sloImage, inputs.sloOverlay, regionDest, 0.5, &region);
+			doNotOptimize(regionDest.ptr<uint8_t>()[0]);
+		});
+	}
+
+
+	class Verifier
+	{
+		int failures = 0;
+	public:
+		void check(bool condition, const std::string& name)
+		{
+			if(!condition)
+			{
+				std::cerr << "FAILED: " << name << '\n';
+				++failures;
+			}
+		}
+
+		int getFailures() const                                 { return failures; }
+	};
+
+	int verifyKernels(const Inputs& inputs)
+	{
+		Verifier verifier;
+
+		// SimpleMatCompress: every format restores the mask
+		for(std::size_t format = 0; format < 3; ++format)
+		{
+			bool equal = inputs.masks.size() == inputs.maskStrings[format].size() && !inputs.masks.empty();
+			for(std::size_t i = 0; equal && i < inputs.masks.size(); ++i)
+			{
+				const cv::Mat& mask = inputs.masks[i];
+				SimpleMatCompress encoded;
+				encoded.readFromMat(mask.ptr<uint8_t>(), mask.rows, mask.cols);
+
+				SimpleMatCompress decoded;
+				equal = decoded.fromSerializationString(encoded.toSerializationString(serializationFormats[format]));
+
+				cv::Mat decodedMask(mask.rows, mask.cols, CV_8UC1);
+				equal = equal && decoded.writeToMat(decodedMask.ptr<uint8_t>(), decodedMask.rows, decodedMask.cols);
+				equal = equal && cv::countNonZero(mask != decodedMask) == 0;
+			}
+			verifier.check(equal, std::string("simplematcompress/round_trip_") + serializationFormatNames[format]);
+		}
+
+		// pchip interpolates the supporting points
+		bool pchipExact = true;
+		for(const std::vector<Point2D>& points : inputs.ilmSupportingPoints)
+		{
+			PChip pchip(points, static_cast<std::size_t>(inputs.config.bscanWidth));
+			const std::vector<double>& values = pchip.getValues();
+			for(const Point2D& point : points)
+			{
+				const std::size_t x = static_cast<std::size_t>(point.getX());
+				if(static_cast<double>(x) == point.getX() && x < values.size())
+					pchipExact = pchipExact && std::abs(values[x] - point.getY()) < 1e-6;
+			}
+		}
+		verifier.check(pchipExact, "pchip/supporting_points");
+
+		// overlay blend: floating point reference (one gray value rounding difference), region blend equals the full blend
+		cv::Mat blendFull;
+		const double alpha = 0.5;
+		bool blendExact = OverlayBlend::blend(inputs.sloImage, inputs.sloOverlay, blendFull, alpha) && inputs.sloImage.channels() == 1;
+		for(int row = 0; blendExact && row < blendFull.rows; ++row)
+		{
+			const uint8_t* src     = inputs.sloImage  .ptr<uint8_t>(row);
+			const uint8_t* overlay = inputs.sloOverlay.ptr<uint8_t>(row);
+			const uint8_t* dest    = blendFull        .ptr<uint8_t>(row);
+			for(int col = 0; col < blendFull.cols; ++col, overlay += 4, dest += 3)
+			{
+				const double a = overlay[3]/255.*alpha;
+				for(int k = 0; k < 3; ++k)
+					blendExact = blendExact && std::abs(src[col]*(1 - a) + overlay[k]*a - dest[k]) <= 1.;
+			}
+		}
+		verifier.check(blendExact, "sloverlay/blend_full");
+
+		cv::Mat blendRegion = blendFull.clone();
+		const cv::Rect region(inputs.sloImage.cols/2 - 32, inputs.sloImage.rows/2 - 32, 64, 64);
+		blendRegion(region).setTo(cv::Scalar::all(0));
+		OverlayBlend::blend(inputs.sloImage, inputs.sloOverlay, blendRegion, alpha, &region);
+		verifier.check(cv::countNonZero(blendRegion.reshape(1) != blendFull.reshape(1)) == 0, "sloverlay/blend_region");
+
+		// marker files: the lossless formats restore the marker tree
+		const bfs::path tempDir = bfs::temp_directory_path() / bfs::unique_path("octmarker_verify_%%%%%%%%");
+		bfs::create_directories(tempDir);
+		for(OctMarkerFileformat format : { OctMarkerFileformat::Json, OctMarkerFileformat::Binary })
+		{
+			for(bool compressed : { false, true })
+			{
+				std::string filename = OctMarkerIO::addMarkerExtension((tempDir / "verify.oct").string(), format);
+				if(compressed)
+					filename += ".gz";
+
+				bpt::ptree saveTree = inputs.markerTree;
+				OctMarkerIO saveIO(&saveTree);
+				bpt::ptree loadTree;
+				OctMarkerIO loadIO(&loadTree);
+				const bool equal = saveIO.saveMarkers(filename, format) && loadIO.loadMarkers(filename, format) && loadTree == inputs.markerTree;
+				verifier.check(equal, std::string("markerio/round_trip_") + OctMarkerIO::getFileExtension(format) + (compressed ? "_gz" : ""));
+			}
+		}
+		bfs::remove_all(tempDir);
+
+		return verifier.getFailures();
+	}
+
+
+	void printUsage(const char* programName)
+	{
+		std::cerr << "usage: " << programName << " [options]\n"
+		             "runs the microbenchmarks of the octmarker kernels with fixed synthetic data\n"
+		             "  --filter <text>        only benchmarks whose name contains text\n"
+		             "  --min-time <ms>        minimal measuring time per benchmark (default 500)\n"
+		             "  --min-iterations <n>   minimal number of iterations per benchmark (default 5)\n"
+		             "  --format <json|csv>    output format (default json)\n"
+		             "  --output <file>        write the results to file instead of stdout\n"
+		             "  --baseline <file>      compare the medians with an earlier json result\n"
+		             "  --tolerance <fraction> allowed slowdown against the baseline (default 0.2)\n"
+		             "  --verify               check the results of the kernels, no measurement\n"
+		             "exit code 2 if a benchmark is slower than the baseline allows, 1 on errors or failed checks\n";
+	}
+}
+
+
+int main(int argc, char* argv[])
+{
+	double      minTimeMs     = 500;
+	int         minIterations = 5;
+	double      tolerance     = 0.2;
+	std::string filter;
+	std::string format = "json";
+	std::string outputFilename;
+	std::string baselineFilename;
+	bool        verify = false;
+
+	for(int i = 1; i < argc; ++i)
+	{
+		const std::string arg = argv[i];
+		if(arg == "-h" || arg == "--help")
+		{
+			printUsage(argv[0]);
+			return 0;
+		}
+		if(arg == "--verify")
+		{
+			verify = true;
+			continue;
+		}
+
+		if(i + 1 >= argc)
+		{
+			std::cerr << "missing value for " << arg << '\n';
+			return 1;
+		}
+		const char* value = argv[++i];
+
+		if(arg == "--filter")
+			filter = value;
+		else if(arg == "--min-time")
+			minTimeMs = std::atof(value);
+		else if(arg == "--min-iterations")
+			minIterations = std::max(std::atoi(value), 1);
+		else if(arg == "--format")
+			format = value;
+		else if(arg == "--output")
+			outputFilename = value;
+		else if(arg == "--baseline")
+			baselineFilename = value;
+		else if(arg == "--tolerance")
+			tolerance = std::atof(value);
+		else
+		{
+			std::cerr << "unknown option " << arg << '\n';
+			printUsage(argv[0]);
+			return 1;
+		}
+	}
+
+	if(format != "json" && format != "csv")
+	{
+		std::cerr << "unknown format " << format << '\n';
+		return 1;
+	}
+
+	// read before the benchmarks run, a wrong baseline fails fast
+	std::map<std::string, double> baselineMedians;
+	if(!baselineFilename.empty() && !readBaseline(baselineFilename, baselineMedians))
+		return 1;
+
+	std::cerr << "creating synthetic data\n";
+	const Inputs inputs;
+
+	if(verify)
+	{
+		const int failures = verifyKernels(inputs);
+		std::cerr << (failures == 0 ? "all checks passed\n" : "checks failed\n");
+		return failures == 0 ? 0 : 1;
+	}
+
+	BenchmarkRunner runner(minTimeMs, static_cast<std::size_t>(minIterations), filter);
+	runBenchmarks(runner, inputs);
+
+	std::ofstream outputFile;
+	if(!outputFilename.empty())
+	{
+		outputFile.open(outputFilename);
+		if(!outputFile)
+		{
+			std::cerr << "can't write " << outputFilename << '\n';
+			return 1;
+		}
+	}
+	std::ostream& output = outputFilename.empty() ? std::cout : outputFile;
+
+	if(format == "json")
+		writeJson(output, runner.getResults(), inputs.config);
+	else
+		writeCsv(output, runner.getResults());
+
+	if(!baselineFilename.empty() && compareWithBaseline(baselineMedians, runner.getResults(), tolerance) > 0)
+		return 2;
+
+	return 0;
+}
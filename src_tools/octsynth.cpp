@@ -0,0 +1,170 @@
+#include "helper/syntheticoct.h"
+
+#include <iostream>
+#include <string>
+#include <cstdlib>
+#include <chrono>
+
+#include <boost/property_tree/ptree.hpp>
+
+#include <octdata/datastruct/oct.h>
+
+#include <manager/octmarkerio.h>
+
+namespace bpt = boost::property_tree;
+
+
+namespace
+{
+	void printUsage(const char* programName)
+	{
+		std::cerr << "usage: " << programName << " [options] <oct file>\n"
+		             "writes a synthetic OCT series (format from the file extension) and its markers\n"
+		             "  --pattern <line|circle|radial>  scan pattern (default line)\n"
+		             "  --bscans <n>                    number of BScans (default 49)\n"
+		             "  --width <n>                     BScan width (default 512)\n"
+		             "  --height <n>                    BScan height (default 496)\n"
+		             "  --slo <width>x<height>          SLO size (default 768x768)\n"
+		             "  --boundary-noise <px>           standard deviation of the layer boundaries (default 1.5)\n"
+		             "  --image-noise <gray>            standard deviation of the speckle (default 12)\n"
+		             "  --seed <n>                      seed of the noise (default 1)\n"
+		             "  --marker-format <format>        json, xml, info, bin or none (default json)\n";
+	}
+
+	bool parseMarkerFormat(const std::string& name, OctMarkerFileformat& format, bool& writeMarkers)
+	{
+		writeMarkers = true;
+		if(name == "json") { format = OctMarkerFileformat::Json  ; return true; }
+		if(name == "xml" ) { format = OctMarkerFileformat::XML   ; return true; }
+		if(name == "info") { format = OctMarkerFileformat::INFO  ; return true; }
+		if(name == "bin" ) { format = OctMarkerFileformat::Binary; return true; }
+		if(name == "none") { writeMarkers = false                 ; return true; }
+		return false;
+	}
+
+	bool parseInt(const char* str, int minValue, int& value)
+	{
+		char* end = nullptr;
+		long v = std::strtol(str, &end, 10);
+		if(*end != '\0' || v < minValue || v > 1 << 20)
+			return false;
+		value = static_cast<int>(v);
+		return true;
+	}
+
+	double elapsedMs(std::chrono::steady_clock::time_point start)
+	{
+		return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+	}
+}
+
+
+int main(int argc, char* argv[])
+{
+	SyntheticOct::Config config;
+	OctMarkerFileformat markerFormat = OctMarkerFileformat::Json;
+	bool writeMarkers = true;
+	std::string octFilename;
+
+	for(int i = 1; i < argc; ++i)
+	{
+		const std::string arg = argv[i];
+		if(arg == "-h" || arg == "--help")
+		{
+			printUsage(argv[0]);
+			return 0;
+		}
+
+		if(arg.compare(0, 2, "--") != 0)
+		{
+			octFilename = arg;
+			continue;
+		}
+
+		if(i + 1 >= argc)
+		{
+			std::cerr << "missing value for " << arg << '\n';
+			return 1;
+		}
+		const char* value = argv[++i];
+
+		bool valid = true;
+		int  intValue = 0;
+		if(arg == "--pattern")
+			valid = SyntheticOct::parseScanPattern(value, config.pattern);
+		else if(arg == "--bscans")
+		{
+			valid = parseInt(value, 1, intValue);
+			config.numBScans = static_cast<std::size_t>(intValue);
+		}
+		else if(arg == "--width")
+			valid = parseInt(value, 2, config.bscanWidth);
+		else if(arg == "--height")
+			valid = parseInt(value, 2, config.bscanHeight);
+		else if(arg == "--slo")
+		{
+			const std::string size = value;
+			const std::size_t sep  = size.find('x');
+			valid = sep != std::string::npos
+			     && parseInt(size.substr(0, sep).c_str(), 1, config.sloWidth)
+			     && parseInt(size.substr(sep + 1).c_str(), 1, config.sloHeight);
+		}
+		else if(arg == "--boundary-noise")
+			config.boundaryNoise = std::atof(value);
+		else if(arg == "--image-noise")
+			config.imageNoise = std::atof(value);
+		else if(arg == "--seed")
+		{
+			valid = parseInt(value, 0, intValue);
+			config.seed = static_cast<unsigned>(intValue);
+		}
+		else if(arg == "--marker-format")
+			valid = parseMarkerFormat(value, markerFormat, writeMarkers);
+		else
+		{
+			std::cerr << "unknown option " << arg << '\n';
+			printUsage(argv[0]);
+			return 1;
+		}
+
+		if(!valid)
+		{
+			std::cerr << "invalid value for " << arg << ": " << value << '\n';
+			return 1;
+		}
+	}
+
+	if(octFilename.empty())
+	{
+		printUsage(argv[0]);
+		return 1;
+	}
+
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+	std::unique_ptr<OctData::OCT> oct = SyntheticOct::createOct(config);
+	std::cout << "generated " << config.numBScans << ' ' << SyntheticOct::getScanPatternName(config.pattern)
+	          << " BScans (" << config.bscanWidth << 'x' << config.bscanHeight << ") in " << elapsedMs(start) << " ms\n";
+
+	start = std::chrono::steady_clock::now();
+	if(!SyntheticOct::writeOct(octFilename, *oct))
+	{
+		std::cerr << "can't write " << octFilename << '\n';
+		return 1;
+	}
+	std::cout << "wrote " << octFilename << " in " << elapsedMs(start) << " ms\n";
+
+	if(writeMarkers)
+	{
+		start = std::chrono::steady_clock::now();
+		bpt::ptree markerTree;
+		SyntheticOct::fillMarkers(config, *oct, markerTree);
+		if(!SyntheticOct::writeMarkers(octFilename, markerTree, markerFormat))
+		{
+			std::cerr << "can't write the markers of " << octFilename << '\n';
+			return 1;
+		}
+		std::cout << "wrote " << OctMarkerIO::addMarkerExtension(octFilename, markerFormat) << " in " << elapsedMs(start) << " ms\n";
+	}
+
+	return 0;
+}